@@ -0,0 +1,112 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the bit-sliced grid of the
+// cellular automata library. Models with at most 4 states only need 2 bits
+// per cell, so the grid is stored as two bit-planes (the low and the high bit
+// of every state) of 64-bit words. The neighbor tests of the rules become
+// word-wide logic and the majority sums bit-sliced adders, so one operation
+// updates 64 cells.
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <vector>
+#include <cstdint>
+#include "CA_library.h"
+
+class BitSlicedGrid
+{
+private:
+    int rows;                             // number of rows in the grid
+    int cols;                             // number of columns in the grid
+    int words;                            // number of words in a row (cols cells and 2 ghost cells)
+    int stride;                           // distance between two rows (a spare word on each side)
+    std::vector<uint64_t> planes[2];      // low and high bits; row i is row i + 1 (ghost rows around)
+    std::vector<uint64_t> next_planes[2]; // planes of the next generation
+
+    // Cell j of a row is bit j + 1 of the row (bit 0 and bit cols + 1 are ghost cells)
+    const uint64_t *row_words(const std::vector<uint64_t> &plane, int row) const
+    {
+        return &plane[static_cast<size_t>(row) * stride + 1];
+    }
+    uint64_t *row_words(std::vector<uint64_t> &plane, int row) { return &plane[static_cast<size_t>(row) * stride + 1]; }
+    int get_bit(const std::vector<uint64_t> &plane, int row, int position) const
+    {
+        return static_cast<int>((row_words(plane, row)[position >> 6] >> (position & 63)) & 1);
+    }
+    void set_bit(std::vector<uint64_t> &plane, int row, int position, int value);
+
+public:
+    BitSlicedGrid(); // Default constructor
+
+    void resize(int rows, int cols);
+
+    // Functions that convert a row of cells to and from the bit-planes
+    // Inputs:
+    //      i : Row of the grid
+    //      row : The cols cells of the row
+    // Returns (load_row):
+    //      False if a cell is in a state above 3 (not representable)
+    template <typename CellT>
+    bool load_row(int i, const CellT *row)
+    {
+        uint64_t *low = row_words(planes[0], i + 1);
+        uint64_t *high = row_words(planes[1], i + 1);
+        bool valid = true;
+        uint64_t low_word = 0, high_word = 0;
+        for (int position = 1; position <= cols; ++position)
+        {
+            int state = static_cast<int>(row[position - 1]);
+            valid = valid && state >= 0 && state <= 3;
+            low_word |= static_cast<uint64_t>(state & 1) << (position & 63);
+            high_word |= static_cast<uint64_t>((state >> 1) & 1) << (position & 63);
+            if ((position & 63) == 63 || position == cols)
+            {
+                low[position >> 6] = low_word;
+                high[position >> 6] = high_word;
+                low_word = high_word = 0;
+            }
+        }
+        return valid;
+    }
+
+    template <typename CellT>
+    void store_row(int i, CellT *row) const
+    {
+        const uint64_t *low = row_words(planes[0], i + 1);
+        const uint64_t *high = row_words(planes[1], i + 1);
+        for (int position = 1; position <= cols; ++position)
+        {
+            int shift = position & 63;
+            row[position - 1] = static_cast<CellT>(((low[position >> 6] >> shift) & 1) |
+                                                   (((high[position >> 6] >> shift) & 1) << 1));
+        }
+    }
+
+    // Function that fills the ghost cells and rows from the boundaries
+    // Inputs:
+    //      boundaries : The boundary type
+    //      fixed_state : State of the ghost cells for fixed boundaries
+    //      line : True for 1D (only the ghost cells of the rows are filled)
+    void fill_ghosts(BoundaryType boundaries, int fixed_state, bool line);
+
+    // Function that computes the next generation of the rows [begin, end)
+    // Inputs:
+    //      begin, end : Rows to compute
+    //      dimensions, neighborhood, rule : The configuration of the model
+    //      k, kprime : The states used by the rule (0 to 3)
+    //      vectorize : If true, the widest instruction set supported by the CPU is used
+    void step_rows(int begin, int end, DimensionType dimensions, NeighborhoodType neighborhood, RuleType rule,
+                   int k, int kprime, bool vectorize);
+
+    // Function that counts the states of the next generation in the rows [begin, end)
+    // Inputs:
+    //      counts : Incremented for the states 0 to 3 (if it has that many entries)
+    void count_rows(int begin, int end, std::vector<uint64_t> &counts) const;
+
+    // Function that counts the cells of the rows [begin, end) whose state differs
+    // between the current and the next generation
+    uint64_t count_changed_rows(int begin, int end) const;
+
+    void swap();
+};
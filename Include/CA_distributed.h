@@ -0,0 +1,89 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the distributed mode of the
+// cellular automata library. The grid is split into slabs of rows, one per
+// worker process on this node. Every worker keeps its slab in its own memory
+// (pinned to one CPU, so the slab is allocated on that CPU's memory node) and
+// the processes only share, through a POSIX shared memory mapping, the rows
+// at the edges of the slabs: each generation a worker publishes its first and
+// last rows and reads those of its neighbors, as an MPI halo exchange would
+// across the nodes of a cluster.
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <vector>
+#include <cstdint>
+#include <sys/types.h>
+#include "CA_library.h"
+
+template <typename CellT = int>
+class BasicDistributedAutomata
+{
+private:
+    struct SharedControl; // command block and barrier (in the shared mapping)
+
+    int num_workers;                // number of worker processes
+    int rows;                       // number of rows in the grid
+    int cols;                       // number of columns in the grid
+    int radius;                     // number of halo rows exchanged on each side
+    int bins;                       // number of states counted for the statistics
+    bool collect_statistics;        // count the states of every generation
+    uint64_t generation;            // number of generations computed so far
+    std::vector<int> first_rows;    // first row of every worker (and rows at the end)
+    std::vector<pid_t> workers;     // process id of every worker
+    void *shared;                   // shared mapping
+    size_t shared_bytes;            // size of the shared mapping
+    size_t halo_offset;             // offset of the halo rows in the mapping
+    size_t counts_offset;           // offset of the state counts in the mapping
+    size_t transfer_offset;         // offset of the rows copied by gather in the mapping
+    SharedControl *control;         // command block at the start of the mapping
+    StatisticsSeries statistics;    // statistics of the computed generations
+
+    CellT *halo_rows(int parity, int worker, int side) const;
+    uint64_t *worker_counts(int parity, int worker) const;
+    CellT *transfer_rows() const;
+    void wait_all() const;
+    void run_worker(int worker, const BasicCellularAutomata<CellT> &model);
+
+public:
+    BasicDistributedAutomata();  // Default constructor
+    ~BasicDistributedAutomata(); // Destructor (stops the workers)
+    BasicDistributedAutomata(const BasicDistributedAutomata &) = delete;
+    BasicDistributedAutomata &operator=(const BasicDistributedAutomata &) = delete;
+
+    // Function that splits a model across worker processes
+    // The workers copy the configuration, the grid and the generation of the
+    // model; they advance it with step(), the configured rule.
+    // Inputs:
+    //      model : Configured 2D model with a grid
+    //      num_workers : Number of worker processes
+    // Returns:
+    //      True if the workers were started
+    bool start(const BasicCellularAutomata<CellT> &model, int num_workers);
+
+    // Function that advances every slab by several generations
+    // Inputs:
+    //      generations : Number of generations
+    void step(uint64_t generations);
+
+    // Function that copies the grid of the workers into a model
+    // Inputs:
+    //      model : Model with the same grid size
+    // Returns:
+    //      True if the grid was copied
+    bool gather(BasicCellularAutomata<CellT> &model);
+
+    // Function that stops the worker processes
+    void stop();
+
+    bool get_running() const;
+    int get_num_workers() const;
+    uint64_t get_generation() const;
+    const StatisticsSeries &get_statistics() const;
+};
+
+// Distributed models with the common cell widths (the library is compiled for these)
+typedef BasicDistributedAutomata<int> DistributedAutomata;
+typedef BasicDistributedAutomata<uint16_t> DistributedAutomata16;
+typedef BasicDistributedAutomata<uint8_t> DistributedAutomata8;
@@ -0,0 +1,39 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the helper functions the file
+// formats of the library (snapshots, statistics) use to store and load
+// little-endian integers, so the files are the same on every host.
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <cstdint>
+
+// Helper functions that store and load little-endian integers
+inline void put_u32(uint8_t *out, uint32_t value)
+{
+    for (int b = 0; b < 4; ++b)
+        out[b] = static_cast<uint8_t>(value >> (8 * b));
+}
+
+inline void put_u64(uint8_t *out, uint64_t value)
+{
+    for (int b = 0; b < 8; ++b)
+        out[b] = static_cast<uint8_t>(value >> (8 * b));
+}
+
+inline uint32_t get_u32(const uint8_t *in)
+{
+    uint32_t value = 0;
+    for (int b = 0; b < 4; ++b)
+        value |= static_cast<uint32_t>(in[b]) << (8 * b);
+    return value;
+}
+
+inline uint64_t get_u64(const uint8_t *in)
+{
+    uint64_t value = 0;
+    for (int b = 0; b < 8; ++b)
+        value |= static_cast<uint64_t>(in[b]) << (8 * b);
+    return value;
+}
@@ -0,0 +1,115 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the ensemble runner of the
+// cellular automata library. A sweep (starting recessive frequencies, grid
+// sizes, rules and seeds) is expanded into replicate simulations, which are
+// run concurrently on a pool of threads that steal replicates from each other.
+// Every thread keeps one model and reuses its buffers from one replicate to
+// the next, and the statistics of every generation are kept in memory and
+// aggregated over the seeds of each configuration.
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "CA_library.h"
+
+// How the replicates advance their model
+enum EnsembleModel
+{
+    GENOTYPE_MODEL, // update(), the allele model
+    RULE_MODEL,     // step(), the configured rule
+};
+
+// Sweep of replicate simulations
+// Every combination of a starting recessive frequency, a grid size, a rule and
+// a seed is one replicate.
+struct SweepSpec
+{
+    std::vector<double> recessive_frequencies;   // starting frequency of the recessive allele
+    std::vector<std::pair<int, int>> grid_sizes; // rows and columns of the grid
+    std::vector<RuleType> rules;                 // rule of the model
+    std::vector<uint64_t> seeds;                 // seed of every replicate of a configuration
+    EnsembleModel model;                         // how the replicates are advanced
+    DimensionType dimensions;
+    NeighborhoodType neighborhood;
+    BoundaryType boundaries;
+    int states;                                  // number of states of the model
+    int k;                                       // state k of the rules
+    int kprime;                                  // state kprime of the rules
+    int generations;                             // number of generations of every replicate
+
+    SweepSpec(); // Default constructor (the allele model of test_genotype)
+};
+
+// Configuration of one replicate
+struct EnsembleRun
+{
+    double recessive_frequency; // starting frequency of the recessive allele
+    int rows;                   // number of rows in the grid
+    int cols;                   // number of columns in the grid
+    RuleType rule;              // rule of the model
+    uint64_t seed;              // seed of the model's random number generator
+};
+
+// Statistics of a configuration aggregated over its seeds
+struct EnsembleSummary
+{
+    EnsembleRun run;                       // configuration (seed of its first replicate)
+    int replicates;                        // number of seeds
+    std::vector<uint64_t> generations;     // generation of every sample
+    std::vector<double> mean_p;            // mean frequency of the dominant allele
+    std::vector<double> variance_p;        // sample variance of the frequency of the dominant allele
+    std::vector<double> mean_heterozygosity;
+    std::vector<double> variance_heterozygosity;
+};
+
+template <typename CellT = int>
+class BasicEnsembleRunner
+{
+private:
+    struct RunQueue; // replicates left to a thread (stolen from its end by the others)
+
+    int num_threads;                         // number of threads running replicates
+    SweepSpec spec;                          // sweep of the last run
+    std::vector<EnsembleRun> runs;           // every replicate of the sweep
+    std::vector<StatisticsSeries> results;   // statistics of every replicate
+    std::vector<EnsembleSummary> summaries;  // statistics of every configuration
+
+    bool take_run(std::vector<RunQueue> &queues, int thread, int &run) const;
+    void run_replicate(BasicCellularAutomata<CellT> &model, int run);
+    void summarise();
+
+public:
+    BasicEnsembleRunner(); // Default constructor
+
+    // Setter method to set the number of threads running replicates
+    // Inputs:
+    //      num_threads : Number of threads (0 uses every hardware thread)
+    void set_num_threads(int num_threads);
+
+    // Function that runs every replicate of a sweep
+    // The initial population of a replicate and its generations only depend
+    // on its configuration and seed, so results do not depend on the number
+    // of threads or on which thread ran which replicate.
+    // Inputs:
+    //      spec : The sweep
+    // Returns:
+    //      True if the sweep was valid and run
+    bool run(const SweepSpec &spec);
+
+    int get_num_threads() const;
+    const SweepSpec &get_spec() const;
+    size_t get_num_runs() const;
+    const EnsembleRun &get_run(size_t run) const;
+    const StatisticsSeries &get_statistics(size_t run) const;
+    size_t get_num_summaries() const;
+    const EnsembleSummary &get_summary(size_t configuration) const;
+};
+
+// Ensemble runners with the common cell widths (the library is compiled for these)
+typedef BasicEnsembleRunner<int> EnsembleRunner;
+typedef BasicEnsembleRunner<uint16_t> EnsembleRunner16;
+typedef BasicEnsembleRunner<uint8_t> EnsembleRunner8;
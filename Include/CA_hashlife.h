@@ -0,0 +1,94 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the memoised (Hashlife) engine
+// of the cellular automata library. The deterministic rules only depend on a
+// cell and its neighbors, so the grid is stored as a quadtree whose nodes are
+// canonicalised (equal blocks are stored once) and the future of every node
+// is memoised. Repetitive grids are then advanced by 2^n generations at the
+// cost of a few lookups.
+// The engine runs on periodic grids whose sides are powers of two: such a
+// grid is one tile of an infinite periodic plane, which is what the quadtree
+// algorithm advances.
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "CA_library.h"
+
+class HashlifeEngine
+{
+private:
+    // Quadtree node: a cell (level 0, state in child[0]) or four children of
+    // level - 1 (northwest, northeast, southwest, southeast)
+    struct Node
+    {
+        uint32_t child[4];
+        int level;
+    };
+
+    struct NodeKey
+    {
+        uint32_t child[4];
+        bool operator==(const NodeKey &other) const;
+    };
+
+    struct NodeKeyHash
+    {
+        size_t operator()(const NodeKey &key) const;
+    };
+
+    std::vector<Node> nodes;                                       // every node, by index
+    std::unordered_map<NodeKey, uint32_t, NodeKeyHash> canonical;  // node with the given children
+    std::unordered_map<int, uint32_t> leaves;                      // node of every cell state
+    std::unordered_map<uint64_t, uint32_t> results;                // (node, log2 of generations) -> future center
+
+    // Rule the memoised results belong to
+    DimensionType dimensions;
+    NeighborhoodType neighborhood;
+    RuleType rule;
+    int k;
+    int kprime;
+
+    uint32_t root;  // the grid (one period of the plane)
+    int root_level; // log2 of the side of the grid
+
+    uint32_t leaf(int state);
+    uint32_t join(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se);
+    uint32_t child(uint32_t node, int quadrant) const { return nodes[node].child[quadrant]; }
+    uint32_t center(uint32_t node);
+    uint32_t horizontal_center(uint32_t west, uint32_t east);
+    uint32_t vertical_center(uint32_t north, uint32_t south);
+    uint32_t base_step(uint32_t node);
+    uint32_t advance_node(uint32_t node, int log2_generations);
+    int apply_rule(const int block[4][4], int i, int j) const;
+
+    uint32_t build(const std::vector<int> &cells, int side, int row, int col, int level);
+    uint32_t build_line(const std::vector<int> &line, int col, int level);
+    void write(uint32_t node, std::vector<int> &cells, int side, int row, int col) const;
+    void write_line(uint32_t node, std::vector<int> &line, int col) const;
+
+public:
+    HashlifeEngine(); // Default constructor
+
+    // Function that sets the rule; memoised results are dropped if it changes
+    void configure(DimensionType dimensions, NeighborhoodType neighborhood, RuleType rule, int k, int kprime);
+
+    // Functions that load and store the grid
+    // 2D: side x side cells in row-major order; 1D: a line of side cells
+    // Inputs:
+    //      cells : The cells
+    //      side : Length of a side, a power of two (at least 4)
+    void load(const std::vector<int> &cells, int side);
+    void store(std::vector<int> &cells) const;
+
+    // Function that advances the grid
+    // Inputs:
+    //      generations : Number of generations
+    void advance(uint64_t generations);
+
+    void clear();
+    size_t get_num_nodes() const;
+};
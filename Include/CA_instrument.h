@@ -0,0 +1,90 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the instrumentation of the
+// cellular automata library. When the library is compiled with
+// -DCA_INSTRUMENTATION (make INSTRUMENT=-DCA_INSTRUMENTATION in Source), the
+// public compute functions and update() record, for every generation, the
+// wall time, the cells updated and changed, the bytes written, the
+// allocations made and, where the kernel allows it, hardware counters read
+// through perf_event_open. Without the flag the probes are not compiled at all.
+// step(generations) and update(generations) add one record per generation as
+// well. With temporal blocking a pass of the grid computes several
+// generations at once: their changed cells are counted exactly, but they
+// share the time, counters and allocations of the pass evenly. The memoised
+// engine jumps over the generations without ever computing the ones in
+// between, so a call of step(generations) with that engine gives a single
+// record for all of its generations.
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Hardware counters read around the probed functions
+enum HardwareCounter
+{
+    COUNTER_CYCLES,
+    COUNTER_LLC_MISSES,
+    COUNTER_BRANCH_MISSES,
+    NUM_HARDWARE_COUNTERS,
+};
+
+// One generation computed by a probed call of a compute function (several
+// generations for a jump of the memoised engine)
+struct GenerationRecord
+{
+    const char *function;       // public function that was called
+    uint64_t generation;        // generation reached
+    uint64_t generations;       // generations covered by the record (1 but for the memoised engine)
+    double seconds;             // wall time of the generations
+    uint64_t cells_updated;     // cells computed (every cell of every generation)
+    uint64_t cells_changed;     // cells whose state differs from the generation before
+    uint64_t bytes_written;     // bytes of cells written to the next-generation buffers
+    uint64_t allocations;       // calls to operator new made meanwhile (every thread)
+    int64_t counters[NUM_HARDWARE_COUNTERS]; // counts of the calling thread (-1 if unavailable)
+};
+
+// Hardware counters of the calling thread (perf_event_open on Linux)
+class HardwareCounters
+{
+private:
+    int fds[NUM_HARDWARE_COUNTERS]; // file descriptors of the counters (-1 if unavailable)
+
+public:
+    HardwareCounters();  // Default constructor (opens the counters)
+    ~HardwareCounters(); // Destructor (closes the counters)
+
+    HardwareCounters(const HardwareCounters &) = delete;
+    HardwareCounters &operator=(const HardwareCounters &) = delete;
+
+    // Function that reads the counters
+    // Inputs:
+    //      values : Set to the counts so far (-1 for the counters that are unavailable)
+    void read(int64_t values[NUM_HARDWARE_COUNTERS]) const;
+};
+
+// Trace of the probed calls of a model
+class InstrumentationTrace
+{
+private:
+    std::vector<GenerationRecord> records; // one record per probed generation
+
+public:
+    void clear();
+    void add(const GenerationRecord &record);
+
+    size_t size() const;
+    const GenerationRecord &get_record(size_t index) const;
+    const std::vector<GenerationRecord> &get_records() const;
+
+    // Functions to write the trace as CSV (one line per record, with a header
+    // line) or as a JSON array of records. Unavailable counters are written as -1.
+    bool write_csv(const std::string &path) const;
+    bool write_json(const std::string &path) const;
+};
+
+// Function that returns the number of calls to operator new made by the
+// program so far (always 0 without CA_INSTRUMENTATION)
+uint64_t get_allocation_count();
@@ -0,0 +1,52 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the row kernels used by the
+// compute functions of the cellular automata library. Each kernel computes
+// one row (or the 1D line) of the next generation from the padded grid
+// buffer, and is compiled once per instruction set so the fastest version
+// supported by the CPU can be selected at runtime.
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <cstddef>
+#include <cstdint>
+#include "CA_library.h"
+
+// Kernel computing one row of the next 2D generation
+// Inputs:
+//      row : First interior cell of the current row in the padded buffer
+//      stride : Length of one padded row (distance to the north/south rows)
+//      next_row : First cell of the row in the back buffer
+//      cols : Number of cells in the row
+//      k, kprime : States k and k' used by the rule
+template <typename CellT>
+using RowKernel = void (*)(const CellT *row, ptrdiff_t stride, CellT *next_row, int cols, CellT k, CellT kprime);
+
+// Kernel computing the next generation of the 1D line
+// Inputs:
+//      line : First interior cell of the current line in the padded buffer
+//      next_line : First cell of the line in the back buffer
+//      cols : Number of cells in the line
+//      k, kprime : States k and k' used by the rule
+template <typename CellT>
+using LineKernel = void (*)(const CellT *line, CellT *next_line, int cols, CellT k, CellT kprime);
+
+// Table of kernels for one cell type and instruction set
+// 2D kernels are indexed by NeighborhoodType.
+template <typename CellT>
+struct RowKernels
+{
+    const char *isa;                  // name of the instruction set the kernels are compiled for
+    RowKernel<CellT> conditional[2];  // Conditional Transition (twodim_rule2)
+    RowKernel<CellT> majority[2];     // Majority Rule (twodim_rule3)
+    LineKernel<CellT> conditional_1d; // Conditional Transition (onedim_rule2)
+    LineKernel<CellT> majority_1d;    // Majority Rule (onedim_rule3)
+};
+
+// Function that returns the kernels for the cell type
+// Inputs:
+//      vectorize : If true, the widest instruction set supported by the CPU
+//                  is selected (once, on first use); otherwise the portable kernels
+template <typename CellT>
+const RowKernels<CellT> &select_row_kernels(bool vectorize);
@@ -12,8 +12,17 @@
 #include <utility>
 #include <random>
 #include <functional>
+#include <cstdint>
+#include <memory>
+#include <cstddef>
+#include "CA_random.h"
+#include "CA_stats.h"
+#include "CA_instrument.h"
 using namespace std;
 
+class ThreadPool;     // Persistent thread pool (CA_threadpool.h)
+class HashlifeEngine; // Memoised engine for the deterministic rules (CA_hashlife.h)
+
 // Enum for dimension type
 enum DimensionType
 {
@@ -44,6 +53,14 @@ enum RuleType
     MAJORITY_RULE,
 };
 
+// Enum for the engines that advance the configured rule by several generations
+enum EngineType
+{
+    DIRECT_ENGINE,    // the compute functions, one generation at a time
+    MEMOISED_ENGINE,  // memoised quadtree (Hashlife) where the configuration allows it
+    BITSLICED_ENGINE, // bit-planes of 64-bit words for models with at most 4 states
+};
+
 enum class Allele_Genotype
 {
     // Representing state of alleles
@@ -52,7 +69,66 @@ enum class Allele_Genotype
     Recessive = 3
 };
 
-class CellularAutomata
+// Number of equally likely outcomes of a cross in the genotype transition table
+// (chosen by the top 2 bits of a random word)
+const int GENOTYPE_BUCKETS = 4;
+
+// Grid of allele genotypes packed 2 bits per cell (4 cells per byte)
+// Cells hold the states 0 to 3, which covers the Allele_Genotype values,
+// so a population takes a quarter of the memory of a uint8_t grid.
+class PackedGenotypeGrid
+{
+private:
+    int rows;                  // number of rows in the grid
+    int cols;                  // number of columns in the grid
+    std::vector<uint8_t> data; // packed cells in row-major order
+
+public:
+    PackedGenotypeGrid();                   // Default constructor
+    PackedGenotypeGrid(int rows, int cols); // Constructor for an empty (state 0) grid
+
+    void resize(int rows, int cols);
+    void set(int row, int col, int state);
+    int get(int row, int col) const
+    {
+        size_t index = static_cast<size_t>(row) * cols + col;
+        return (data[index >> 2] >> ((index & 3) * 2)) & 3;
+    }
+
+    int get_rows() const;
+    int get_cols() const;
+    size_t size_bytes() const;
+    const std::vector<uint8_t> &get_data() const;
+    std::vector<uint8_t> &get_data();
+};
+
+// Block of consecutive rows handed to a tile rule (see add_tile_rule)
+// The input rows are read from the padded grid, so in_row(i)[j - 1],
+// in_row(i)[j + 1], in_row(i - 1)[j], ... reach neighbors up to the halo
+// width away with the model's boundaries already applied. A tile rule must
+// write every cell of its output rows.
+template <typename CellT>
+struct GridTile
+{
+    const CellT *in;        // cell (row_begin, 0) of the current generation
+    CellT *out;             // cell (row_begin, 0) of the next generation
+    ptrdiff_t stride;       // distance between two consecutive rows
+    int row_begin;          // first row of the tile
+    int row_end;            // one past the last row of the tile
+    int cols;               // number of cells in a row
+    int halo;               // number of ghost cells readable beyond each edge
+    uint64_t generation;    // generation being computed (for rng draws)
+    const CounterRNG *rng;  // generator of the model
+
+    const CellT *in_row(int i) const { return in + (i - row_begin) * stride; }
+    CellT *out_row(int i) const { return out + (i - row_begin) * stride; }
+};
+
+// General purpose cellular automata model
+// CellT is the type every cell state is stored as. Narrow types (uint8_t,
+// uint16_t) reduce memory use and bandwidth for models with few states.
+template <typename CellT = int>
+class BasicCellularAutomata
 {
 private:
     // Member variables to store CA attributes
@@ -66,13 +142,111 @@ private:
     int states;                                        // number of states every cell in CA model can be in
     int k;                                             // state k to be used in rules
     int kprime;                                        // state k' to be used in rules
-    std::vector<std::vector<int>> grid;                // grid of the CA
-    using RuleFunction = std::function<int(const std::vector<std::vector<int>> &, int, int)>; // Vector for rules
-    std::vector<RuleFunction> rules;                   // Vector to store rule functions
+    int halo;                                          // width of the ghost-cell halo around the grid
+    int stride;                                        // length of one padded row (cols + 2 * halo)
+    std::vector<CellT> cells;                          // contiguous, row-padded grid storage (with halo)
+    std::vector<CellT> next_cells;                     // back buffer the next generation is written to
+    bool halo_valid;                                   // true while the halo matches the current cells
+    bool vectorize;                                    // use the SIMD kernels selected for this CPU
+    int num_threads;                                   // number of threads used by the compute functions
+    std::shared_ptr<ThreadPool> pool;                  // worker threads (null when running on one thread)
+    CounterRNG rng;                                    // counter-based generator keyed on the seed
+    uint64_t generation;                               // number of generations computed so far
+    uint64_t user_draws;                               // draws made by direct determine_genotype calls
+    int table_size;                                    // number of states covered by the tables below
+    std::vector<CellT> genotype_table;                 // offspring by (state1, state2, random bucket)
+    std::vector<CellT> average_table;                  // rounded average of two offspring states
+    using StepFunction = void (BasicCellularAutomata::*)(int, int); // Kernel advancing one generation
+    StepFunction step_function;                        // kernel selected for the current configuration
+    bool collect_statistics;                           // count the states of every computed generation
+    StatisticsSeries statistics;                       // statistics of the recorded generations
+    bool active_regions;                               // skip the tiles that cannot change
+    bool tiles_valid;                                  // tile_changed describes the last generation
+    bool tile_counts_valid;                            // tile_counts hold the states of every tile
+    int tile_height;                                   // number of rows in a tile
+    int tile_width;                                    // number of columns in a tile
+    int tiles_down;                                    // number of tiles in a column of the grid
+    int tiles_across;                                  // number of tiles in a row of the grid
+    std::vector<uint8_t> tile_changed;                 // tiles that changed in the last generation
+    std::vector<uint8_t> tile_active;                  // tiles computed in the current generation
+    std::vector<uint32_t> tile_counts;                 // number of cells of every tile in every state
+    StepFunction tracked_step;                         // kernel of the last tracked generation
+    int tracked_k;                                     // state k of the last tracked generation
+    int tracked_kprime;                                // state k' of the last tracked generation
+    EngineType engine;                                 // engine used by step(generations)
+    std::shared_ptr<HashlifeEngine> memoised;          // nodes and results of the memoised engine
+    int time_block;                                    // generations advanced per pass of the grid
+    struct ProbeState;                                 // timing, counters and grid of the probed call
+    struct ProbeScope;                                 // probe of a public compute function (CA_PROBE)
+    bool instrumented;                                 // record the probed generations in the trace
+    std::shared_ptr<ProbeState> probe;                 // state of the probes (null until instrumented)
+    InstrumentationTrace trace;                        // probed generations recorded so far
+    mutable std::vector<std::vector<int>> grid_view;   // compatibility view returned by get_grid()
+public:
+    using RuleFunction = std::function<int(const std::vector<std::vector<int>> &, int, int)>; // Rule on one cell
+    using TileRule = std::function<void(const GridTile<CellT> &)>; // Rule on a block of rows
+
+private:
+    struct RegisteredRule
+    {
+        TileRule tile; // rule run once per block of rows
+        RuleFunction cell; // rule run once per cell (when tile is empty)
+    };
+    std::vector<RegisteredRule> rules;                 // Rules run in order by step_rules()
+
+    // Helper functions for the flat grid storage
+    void allocate_grid();
+    int cell_index(int i, int j) const { return (i + halo) * stride + (j + halo); }
+    template <BoundaryType B>
+    void fill_halo(int fixed_state);
+    void fill_halo(BoundaryType boundary_type, int fixed_state);
+    void ensure_halo();
+    void swap_buffers();
+    void for_each_band(int begin, int end, long long cells_per_index, const std::function<void(int, int)> &task);
+    void build_genotype_table();
+    int begin_population();
+    std::pair<uint64_t, uint64_t> population_key(uint64_t cell) const;
+    int table_state(int state) const { return state < 0 ? 0 : (state >= table_size ? table_size - 1 : state); }
+
+    // Stepping kernels specialised for each configuration
+    template <DimensionType D, NeighborhoodType N, BoundaryType B, RuleType R>
+    void step_generation(int k, int kprime);
+    template <DimensionType D, NeighborhoodType N, BoundaryType B, RuleType R>
+    void step_generation_radius(int k, int kprime);
+    template <DimensionType D, NeighborhoodType N, BoundaryType B>
+    static StepFunction select_rule_kernel(RuleType rule, bool wide);
+    template <DimensionType D, NeighborhoodType N>
+    static StepFunction select_boundary_kernel(BoundaryType boundaries, RuleType rule, bool wide);
+    static StepFunction select_kernel(DimensionType dimensions, NeighborhoodType neighborhood,
+                                      BoundaryType boundaries, RuleType rule, int radius);
+    void configure_step();
+    void step_memoised(uint64_t generations);
+    bool step_bitsliced(uint64_t generations);
+    template <typename RowStep>
+    void step_blocked(uint64_t generations, BoundaryType edges, const RowStep &row_step);
+    void update_row(const CellT *row, ptrdiff_t row_stride, CellT *next_row, int i, int j, int width,
+                    uint64_t current_generation) const;
+
+    // Helper functions for the active regions (tiles that may change)
+    bool prepare_tiles(StepFunction kernel, int k, int kprime, bool wrap, bool one_dim);
+    void finish_tiles(StepFunction kernel, int k, int kprime, bool tracked, StateHistogram &histogram);
+    void mark_tile_changed(int row, int col);
+    void run_tile_pass(const TileRule &rule, StateHistogram *histogram, bool parallel);
+    void count_states(const CellT *row, int count, std::vector<uint64_t> &band_counts) const;
+    template <typename Count>
+    void count_states(const CellT *row, int count, Count *counts, int num_states) const;
+    void record_statistics(const StateHistogram &histogram);
+
+    // Helper functions for the instrumentation
+    void begin_probe(const char *function);
+    void end_probe();
+    bool probing_generations() const;
+    void start_probe();
+    void record_probe(const std::vector<uint64_t> *cells_changed);
 
 public:
-    CellularAutomata();  // Default constructor
-    ~CellularAutomata(); // Default destructor
+    BasicCellularAutomata();  // Default constructor
+    ~BasicCellularAutomata(); // Default destructor
 
     // Setter methods for CA attributes
     void set_dimensions(DimensionType dimensions);
@@ -86,7 +260,21 @@ public:
     void set_k(int k_state);
     void set_kprime(int kprime_state);
     void add_rule(const RuleFunction &new_rule);
+    void add_tile_rule(const TileRule &new_rule);
+    void clear_rules();
     void set_cell_state(int row, int col, int state);
+    void set_row(int row, const CellT *values);
+    void set_halo_width(int halo_width);
+    void set_packed_grid(const PackedGenotypeGrid &packed);
+    void set_vectorization(bool enabled);
+    void set_num_threads(int num_threads);
+    void set_seed(uint64_t seed);
+    void set_cross(int cell_state1, int cell_state2, const std::vector<int> &offspring);
+    void set_statistics(bool enabled);
+    void set_active_regions(bool enabled);
+    void set_engine(EngineType engine);
+    void set_temporal_blocking(int generations);
+    void set_instrumentation(bool enabled);
 
     // Getter methods for CA attributes
     DimensionType get_dimensions() const;
@@ -100,6 +288,26 @@ public:
     const std::vector<std::vector<int>> &get_grid() const;
     int get_k() const;
     int get_kprime() const;
+    int get_halo_width() const;
+    int get_cell_state(int row, int col) const;
+    const CellT *get_row(int row) const { return &cells[cell_index(row, 0)]; } // cols cells of a row
+    void get_packed_grid(PackedGenotypeGrid &packed) const;
+    bool get_vectorization() const;
+    const char *get_kernel_isa() const;
+    int get_num_threads() const;
+    uint64_t get_seed() const;
+    uint64_t get_generation() const;
+    std::vector<int> get_cross(int cell_state1, int cell_state2) const;
+    int get_num_rules() const;
+    bool get_statistics_enabled() const;
+    bool get_active_regions() const;
+    double get_active_fraction() const;
+    EngineType get_engine() const;
+    EngineType get_active_engine() const;
+    int get_temporal_blocking() const;
+    const StatisticsSeries &get_statistics() const;
+    bool get_instrumentation() const;
+    const InstrumentationTrace &get_trace() const;
     std::vector<int> get_neighbors(int i, int j);
 
     // Functions to setup CA model
@@ -108,6 +316,23 @@ public:
     void setup_neighborhood();
     void setup_rule();
 
+    // Functions that allocate the grid and fill it with a population of the allele
+    // model (1 = HomozygousDominant, 2 = Heterzygous, 3 = Recessive) in place of
+    // setup_dimensions(). Cells are drawn in parallel from the seed (STREAM_INIT),
+    // so a population does not depend on the number of threads.
+    // Hardy-Weinberg: every cell is aa with probability q^2, Aa with 2pq and AA with p^2
+    // Exact counts: the given number of cells of each genotype, at random positions
+    // Clustered: patches around num_seeds random seeds, each with a Hardy-Weinberg genotype
+    // Inputs:
+    //      recessive_frequency : Frequency q of the recessive allele (0 to 1)
+    //      dominant, heterozygous, recessive : Number of cells of each genotype
+    //      num_seeds : Number of patches
+    // Returns:
+    //      True if the grid was filled
+    bool setup_population(double recessive_frequency);
+    bool setup_population_counts(uint64_t dominant, uint64_t heterozygous, uint64_t recessive);
+    bool setup_clustered_population(double recessive_frequency, int num_seeds);
+
     // Compute Functions
     void onedim_rule1(int k, int kprime);
     void onedim_rule2(int k, int kprime);
@@ -116,11 +341,38 @@ public:
     void twodim_rule2(int k, int kprime);
     void twodim_rule3(int k, int kprime);
 
-    // Update function to advance the CA model to the next generation
+    // Step functions to advance the CA model by one or several generations of the configured rule
+    void step();
+    void step(uint64_t generations);
+
+    // Functions for the per-generation statistics
+    void record_statistics();
+    void clear_statistics();
+
+    // Functions to save a run to a checkpoint file and resume it
+    // A resumed run continues exactly as the run that was saved would have.
+    bool save_checkpoint(const std::string &path) const;
+    bool load_checkpoint(const std::string &path);
+
+    // Function to remove the records of the instrumentation
+    void clear_trace();
+
+    // Functions to advance the CA model with custom rules
+    void apply_tile_rule(const TileRule &rule);
+    void step_rules();
+
+    // Update functions to advance the CA model to the next generation, or by several generations
     void update();
+    void update(uint64_t generations);
 
     // 4th Rule Function for Our Specific Allele Model
     // This function is a specific rules function for our allele model of which
     // we were told to just include in the CA general purpose library.
     int determine_genotype(int cell_state1, int cell_state2);
-};
\ No newline at end of file
+    int determine_genotype(int cell_state1, int cell_state2, uint32_t random_bits) const;
+};
+
+// Models with the common cell widths (the library is compiled for these)
+typedef BasicCellularAutomata<int> CellularAutomata;
+typedef BasicCellularAutomata<uint16_t> CellularAutomata16;
+typedef BasicCellularAutomata<uint8_t> CellularAutomata8;
\ No newline at end of file
@@ -0,0 +1,112 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the 1D engine of the cellular
+// automata library. The line is one contiguous run of cells (64-bit indices,
+// so it can hold billions of cells) with ghost cells at both ends, and its
+// generations are stored in a ring of lines: each step writes the next
+// generation over the oldest line, so the last generations stay available
+// for space-time diagrams and memory is O(width x depth).
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "CA_library.h"
+
+class ThreadPool;
+
+template <typename CellT = int>
+class BasicLineAutomata
+{
+private:
+    BoundaryType boundaries;
+    RuleType rule;
+    int64_t width;                    // number of cells in the line
+    int radius;                       // radius of neighborhood (ghost cells at each end)
+    int states;                       // number of states every cell can be in
+    int k;                            // state k to be used in rules
+    int kprime;                       // state k' to be used in rules
+    int depth;                        // number of past generations kept
+    int slots;                        // number of lines in the ring (depth + 1, at least 2)
+    int history_lines;                // past generations in the ring (at most depth)
+    size_t pitch;                     // distance between two lines of the ring
+    std::vector<CellT> ring;          // lines of the ring, with radius ghost cells at each end
+    uint64_t generation;              // number of generations computed so far
+    bool vectorize;                   // use the SIMD kernels selected for this CPU
+    int num_threads;                  // number of threads used by step
+    std::shared_ptr<ThreadPool> pool; // worker threads (null when running on one thread)
+    CounterRNG rng;                   // counter-based generator keyed on the seed
+    bool collect_statistics;          // count the states of every computed generation
+    StatisticsSeries statistics;      // statistics of the recorded generations
+
+    CellT *slot_line(uint64_t slot_generation) { return &ring[(slot_generation % slots) * pitch + radius]; }
+    const CellT *slot_line(uint64_t slot_generation) const { return &ring[(slot_generation % slots) * pitch + radius]; }
+    void allocate();
+    void fill_ghosts(CellT *line) const;
+    void for_each_segment(const std::function<void(int64_t, int64_t, std::vector<uint64_t> &)> &task,
+                          std::vector<uint64_t> &counts);
+
+public:
+    BasicLineAutomata(); // Default constructor
+
+    // Setter methods for the configuration
+    void set_boundaries(BoundaryType boundaries);
+    void set_rule(RuleType rule);
+    void set_neighborhood_radius(int radius);
+    void set_states(int states);
+    void set_k(int k_state);
+    void set_kprime(int kprime_state);
+    void set_vectorization(bool enabled);
+    void set_num_threads(int num_threads);
+    void set_seed(uint64_t seed);
+    void set_statistics(bool enabled);
+
+    // Setter method to set the number of cells in the line (the line is cleared)
+    void set_width(int64_t width);
+
+    // Setter method to set the number of past generations kept for space-time diagrams
+    // Inputs:
+    //      depth : Number of past generations (0 keeps only the current line)
+    void set_history_depth(int depth);
+
+    // Functions to set the cells of the current line
+    void setup_line();                             // random states, as setup_dimensions in 1D
+    void set_line(const std::vector<int> &line);   // the first width states
+    void set_cell_state(int64_t cell, int state);
+
+    // Function that advances the line by several generations of the configured rule
+    // Inputs:
+    //      generations : Number of generations
+    void step(uint64_t generations = 1);
+
+    // Function that adds a statistics sample for the current line
+    void record_statistics();
+
+    // Getter methods
+    BoundaryType get_boundaries() const;
+    RuleType get_rule() const;
+    int64_t get_width() const;
+    int get_neighborhood_radius() const;
+    int get_states() const;
+    int get_k() const;
+    int get_kprime() const;
+    int get_history_depth() const;
+    int get_num_threads() const;
+    uint64_t get_generation() const;
+    int get_cell_state(int64_t cell) const;
+    const StatisticsSeries &get_statistics() const;
+
+    // Getter method to get a line of the history
+    // Inputs:
+    //      age : 0 for the current generation, 1 for the one before, ...
+    // Returns:
+    //      The width cells of the line, or nullptr if that generation is not kept
+    const CellT *get_line(int age = 0) const;
+};
+
+// 1D engines with the common cell widths (the library is compiled for these)
+typedef BasicLineAutomata<int> LineAutomata;
+typedef BasicLineAutomata<uint16_t> LineAutomata16;
+typedef BasicLineAutomata<uint8_t> LineAutomata8;
@@ -0,0 +1,86 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the asynchronous output stage
+// of the cellular automata library. write_frame() only copies the grid into
+// a free buffer and queues it; a background thread packs, encodes (as a
+// difference from the previous frame with SNAPSHOT_DELTA) and writes the
+// queued frames to a snapshot file, so generation N + 1 is computed while
+// generation N is written. The buffers are allocated once and recycled: when
+// every buffer is queued, write_frame() waits for the writer to free one, so
+// a slow disk holds the computation back instead of filling the memory.
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "CA_library.h"
+#include "CA_snapshot.h"
+
+template <typename CellT = int>
+class BasicAsyncSnapshotWriter
+{
+private:
+    SnapshotWriter writer;                      // snapshot file (used by the writer thread)
+    std::vector<std::vector<CellT>> buffers;    // copies of the grid, recycled
+    std::vector<uint64_t> generations;          // generation held by every buffer
+    std::deque<int> free_buffers;               // buffers write_frame() can fill
+    std::deque<int> queued_buffers;             // buffers waiting for the writer thread, in order
+    std::mutex mutex;                           // protects the queues and the counters below
+    std::condition_variable frame_queued;       // signals the writer thread that a frame is queued
+    std::condition_variable buffer_freed;       // signals write_frame() that a buffer is free
+    std::thread writer_thread;                  // packs, encodes and writes the queued frames
+    int rows;                                   // number of rows in the grid
+    int cols;                                   // number of columns in the grid
+    uint64_t frames_written;                    // frames written to the file
+    uint64_t stalls;                            // calls of write_frame() that waited for a buffer
+    bool stopping;                              // set by close() once the last frame is queued
+    bool failed;                                // a frame could not be written
+    bool is_open;
+
+    void writer_loop();
+
+public:
+    BasicAsyncSnapshotWriter();  // Default constructor
+    ~BasicAsyncSnapshotWriter(); // Destructor, writes the queued frames and closes the file
+
+    BasicAsyncSnapshotWriter(const BasicAsyncSnapshotWriter &) = delete;
+    BasicAsyncSnapshotWriter &operator=(const BasicAsyncSnapshotWriter &) = delete;
+
+    // Function to create a snapshot file for a model and start the writer thread
+    // Inputs:
+    //      path : Path of the file
+    //      model : Model whose configuration is stored in the header
+    //      encoding : How the frames are encoded
+    //      keyframe_interval : Frames between two keyframes (SNAPSHOT_DELTA)
+    //      queue_frames : Number of buffers (frames that can wait for the writer)
+    // Returns:
+    //      True if the file was created
+    bool open(const std::string &path, const BasicCellularAutomata<CellT> &model,
+              SnapshotEncoding encoding = SNAPSHOT_DELTA, int keyframe_interval = 64, int queue_frames = 4);
+
+    // Function to queue the current generation of a model as a frame
+    // Waits for a free buffer when every buffer is queued.
+    // Returns:
+    //      False if the file is not open, the grid size differs or a frame could not be written
+    bool write_frame(const BasicCellularAutomata<CellT> &model);
+
+    // Function to write the queued frames, stop the writer thread and close the file
+    // Returns:
+    //      True if every frame and the index were written
+    bool close();
+
+    uint64_t get_num_frames();     // frames written to the file so far
+    uint64_t get_pending_frames(); // frames queued but not yet written
+    uint64_t get_stalls();         // calls of write_frame() that waited for a buffer
+};
+
+// Asynchronous writers for the common cell widths (the library is compiled for these)
+typedef BasicAsyncSnapshotWriter<int> AsyncSnapshotWriter;
+typedef BasicAsyncSnapshotWriter<uint16_t> AsyncSnapshotWriter16;
+typedef BasicAsyncSnapshotWriter<uint8_t> AsyncSnapshotWriter8;
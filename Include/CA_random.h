@@ -0,0 +1,91 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the counter-based random number
+// generator of the cellular automata library. Every draw is a pure function
+// of (seed, generation, cell, stream), so any cell's random numbers can be
+// computed independently of the others, on any thread and in any order, and
+// a run replays exactly from its seed.
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <cstdint>
+
+// Streams keep the draws of different uses of the generator independent
+enum RandomStream
+{
+    STREAM_SETUP = 0,  // initial random states (setup_dimensions)
+    STREAM_UPDATE = 1, // genotype inheritance (update)
+    STREAM_INIT = 2,   // population initialisers
+    STREAM_USER = 3,   // determine_genotype called directly by the user
+};
+
+// Philox4x32-10 block function (Salmon et al., "Parallel random numbers: as
+// easy as 1, 2, 3", SC 2011). Encrypts the 128-bit counter with the 64-bit key.
+// Inputs:
+//      ctr : Counter, replaced by 4 random 32-bit words
+//      key0, key1 : Key (the seed)
+inline void philox4x32_10(uint32_t ctr[4], uint32_t key0, uint32_t key1)
+{
+    for (int round = 0; round < 10; ++round)
+    {
+        uint64_t product0 = static_cast<uint64_t>(0xD2511F53u) * ctr[0];
+        uint64_t product1 = static_cast<uint64_t>(0xCD9E8D57u) * ctr[2];
+        uint32_t c0 = static_cast<uint32_t>(product1 >> 32) ^ ctr[1] ^ key0;
+        uint32_t c1 = static_cast<uint32_t>(product1);
+        uint32_t c2 = static_cast<uint32_t>(product0 >> 32) ^ ctr[3] ^ key1;
+        uint32_t c3 = static_cast<uint32_t>(product0);
+        ctr[0] = c0;
+        ctr[1] = c1;
+        ctr[2] = c2;
+        ctr[3] = c3;
+
+        // Bump the key with the Weyl sequence constants
+        key0 += 0x9E3779B9u;
+        key1 += 0xBB67AE85u;
+    }
+}
+
+// Counter-based generator keyed on a 64-bit seed
+// Each (generation, cell, stream) counter gives 4 independent 32-bit words.
+// Generations are taken modulo 2^32.
+class CounterRNG
+{
+private:
+    uint64_t seed; // key of the generator
+
+public:
+    explicit CounterRNG(uint64_t seed = 0) : seed(seed) {}
+
+    void set_seed(uint64_t seed) { this->seed = seed; }
+    uint64_t get_seed() const { return seed; }
+
+    // Function that returns the 4 random words of a counter
+    // Inputs:
+    //      generation : Generation the draw belongs to
+    //      cell : Index of the cell (row * cols + col)
+    //      stream : Use of the draw (RandomStream)
+    //      out : The 4 random words
+    void draw4(uint64_t generation, uint64_t cell, uint32_t stream, uint32_t out[4]) const
+    {
+        out[0] = static_cast<uint32_t>(cell);
+        out[1] = static_cast<uint32_t>(cell >> 32);
+        out[2] = static_cast<uint32_t>(generation);
+        out[3] = stream;
+        philox4x32_10(out, static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32));
+    }
+
+    // Function that returns the first random word of a counter
+    uint32_t draw(uint64_t generation, uint64_t cell, uint32_t stream) const
+    {
+        uint32_t out[4];
+        draw4(generation, cell, stream, out);
+        return out[0];
+    }
+
+    // Function that maps a random word to a uniform double in [0, 1)
+    static double to_unit(uint32_t word)
+    {
+        return word * (1.0 / 4294967296.0);
+    }
+};
@@ -0,0 +1,200 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the binary snapshot format of
+// the cellular automata library. A snapshot file holds a header describing
+// the model followed by one frame per saved generation:
+// - Cells are bit-packed with the fewest bits (1, 2, 4, 8, 16 or 32) that
+//   hold every state of the model.
+// - Frames may be run-length encoded, or stored as the run-length encoded
+//   difference (XOR) from the previous frame, with a full keyframe every few
+//   frames so any generation is reached without decoding the whole run.
+// - An index of the frames at the end of the file lets the reader, which
+//   memory-maps the file, seek straight to any generation.
+// All fields are little-endian. Layout:
+//      header (64 bytes) | frame 0 | frame 1 | ... | index
+//      frame = generation (8) | payload size (8) | encoding (4) | reserved (4) | payload
+//      index entry = generation (8) | frame offset (8) | payload size (8) | encoding (4) | reserved (4)
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include "CA_library.h"
+
+// How the writer encodes frames
+enum SnapshotEncoding
+{
+    SNAPSHOT_PACKED, // bit-packed cells only
+    SNAPSHOT_RLE,    // bit-packed cells, run-length encoded when smaller
+    SNAPSHOT_DELTA,  // difference from the previous frame, run-length encoded
+};
+
+// How a single frame is stored
+enum FrameEncoding
+{
+    FRAME_PACKED = 0,    // bit-packed cells
+    FRAME_RLE = 1,       // run-length encoded bit-packed cells
+    FRAME_DELTA_RLE = 2, // run-length encoded XOR with the previous frame
+};
+
+// Largest keyframe interval the 16-bit field of the header holds
+const int MAX_KEYFRAME_INTERVAL = 0xFFFF;
+
+// Description of the model stored at the start of a snapshot file
+struct SnapshotHeader
+{
+    int rows;                      // number of rows in the grid
+    int cols;                      // number of columns in the grid
+    int states;                    // number of states of the model
+    int neighborhood_radius;       // radius of neighborhood
+    DimensionType dimensions;
+    NeighborhoodType neighborhood;
+    BoundaryType boundaries;
+    RuleType rule;
+    int bits_per_cell;             // bits used for every packed cell
+    SnapshotEncoding encoding;     // encoding chosen by the writer
+    int keyframe_interval;         // frames between two keyframes (delta encoding)
+    uint64_t seed;                 // seed of the model's random number generator
+    uint64_t num_frames;           // number of frames in the file
+    uint64_t index_offset;         // position of the frame index (0 if missing)
+};
+
+// Writer that streams generations of a model to a snapshot file
+// Frames are written as they are added; the index is written by close().
+class SnapshotWriter
+{
+private:
+    std::ofstream file;                  // output file
+    SnapshotHeader header;               // header of the file being written
+    std::vector<uint8_t> packed;         // bit-packed cells of the current frame
+    std::vector<uint8_t> previous;       // bit-packed cells of the previous frame
+    std::vector<uint8_t> encoded;        // run-length encoded payload
+    std::vector<uint8_t> index;          // index entries of the frames written so far
+    uint64_t offset;                     // position of the next frame
+    uint32_t max_state;                  // largest state a packed cell holds
+    bool overflow;                       // a cell of the current frame did not fit
+    bool is_open;
+
+    bool open_file(const std::string &path);
+    void begin_frame();
+    void pack_row(int row, const int *cells);
+    void pack_row(int row, const uint16_t *cells);
+    void pack_row(int row, const uint8_t *cells);
+    template <typename T>
+    void pack_cells(int row, const T *cells);
+    bool write_packed_frame(uint64_t generation);
+
+public:
+    SnapshotWriter();  // Default constructor
+    ~SnapshotWriter(); // Destructor, closes the file
+
+    // Function to create a snapshot file for a model
+    // Inputs:
+    //      path : Path of the file
+    //      model : Model whose configuration is stored in the header
+    //      encoding : How the frames are encoded
+    //      keyframe_interval : Frames between two keyframes (SNAPSHOT_DELTA), clamped
+    //                          to 1 to 65535 since the header stores it in 16 bits
+    // Returns:
+    //      True if the file was created
+    template <typename CellT>
+    bool open(const std::string &path, const BasicCellularAutomata<CellT> &model,
+              SnapshotEncoding encoding = SNAPSHOT_DELTA, int keyframe_interval = 64)
+    {
+        header.rows = model.get_grid_rows();
+        header.cols = model.get_grid_cols();
+        header.states = model.get_states();
+        header.neighborhood_radius = model.get_neighborhood_radius();
+        header.dimensions = model.get_dimensions();
+        header.neighborhood = model.get_neighborhood();
+        header.boundaries = model.get_boundaries();
+        header.rule = model.get_rule();
+        header.encoding = encoding;
+        header.keyframe_interval = std::min(std::max(keyframe_interval, 1), MAX_KEYFRAME_INTERVAL);
+        header.seed = model.get_seed();
+        return open_file(path);
+    }
+
+    // Function to append the current generation of a model as a frame
+    // Returns:
+    //      True if the frame was written
+    template <typename CellT>
+    bool write_frame(const BasicCellularAutomata<CellT> &model)
+    {
+        if (!is_open || model.get_grid_rows() != header.rows || model.get_grid_cols() != header.cols)
+        {
+            return false;
+        }
+        begin_frame();
+        for (int i = 0; i < header.rows; ++i)
+        {
+            pack_row(i, model.get_row(i));
+        }
+        return write_packed_frame(model.get_generation());
+    }
+
+    // Function to append a generation held as rows x cols contiguous cells as a frame
+    // Inputs:
+    //      generation : Generation of the frame
+    //      cells : The cells of the grid, row by row
+    // Returns:
+    //      True if the frame was written
+    template <typename CellT>
+    bool write_frame(uint64_t generation, const CellT *cells)
+    {
+        if (!is_open)
+        {
+            return false;
+        }
+        begin_frame();
+        for (int i = 0; i < header.rows; ++i)
+        {
+            pack_row(i, cells + static_cast<size_t>(i) * header.cols);
+        }
+        return write_packed_frame(generation);
+    }
+
+    // Function to write the index and close the file
+    bool close();
+
+    uint64_t get_num_frames() const;
+    uint64_t get_bytes_written() const;
+};
+
+// Reader that memory-maps a snapshot file and decodes any of its frames
+class SnapshotReader
+{
+private:
+    const uint8_t *data;                 // mapped file
+    size_t size;                         // size of the mapped file
+    SnapshotHeader header;               // header of the file
+    std::vector<uint64_t> generations;   // generation of every frame
+    std::vector<uint64_t> offsets;       // position of every frame payload
+    std::vector<uint64_t> payload_sizes; // size of every frame payload
+    std::vector<uint32_t> encodings;     // FrameEncoding of every frame
+    std::vector<uint8_t> packed;         // bit-packed cells of the last decoded frame
+    long long decoded_frame;             // index of the frame held in packed (-1 if none)
+
+    bool read_index();
+    bool scan_frames();
+    bool decode_frame(size_t frame);
+
+public:
+    SnapshotReader();  // Default constructor
+    ~SnapshotReader(); // Destructor, unmaps the file
+
+    bool open(const std::string &path);
+    void close();
+
+    const SnapshotHeader &get_header() const;
+    size_t get_num_frames() const;
+    uint64_t get_frame_generation(size_t frame) const;
+    long long find_generation(uint64_t generation) const;
+
+    bool read_frame(size_t frame, std::vector<int> &cells);
+    bool read_frame(size_t frame, std::vector<std::vector<int>> &grid);
+};
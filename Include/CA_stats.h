@@ -0,0 +1,75 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the per-generation statistics
+// of the cellular automata library: the number of cells in every state and,
+// for the allele model, the allele frequencies p and q and the observed
+// heterozygosity. The compute functions count the cells they write while
+// the rows are still in cache, so no extra pass over the grid is needed.
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+// Histogram of cell states filled by the bands of a compute function
+// Every band counts its own cells and merges them once, so the counts do not
+// depend on the number of threads.
+class StateHistogram
+{
+private:
+    std::mutex lock;               // serialises merges from different bands
+    std::vector<uint64_t> counts;  // number of cells in every state
+
+public:
+    explicit StateHistogram(int num_states); // Constructor for a histogram of states 0 to num_states - 1
+
+    int get_num_states() const;
+    void merge(const std::vector<uint64_t> &band_counts);
+    const std::vector<uint64_t> &get_counts() const;
+};
+
+// Time series of the statistics of every recorded generation, stored by column
+// Allele frequencies use the genotypes HomozygousDominant = 1, Heterzygous = 2
+// and Recessive = 3: p = (2 * AA + Aa) / (2 * N), q = 1 - p, and the observed
+// heterozygosity is Aa / N, where N counts the cells with a genotype.
+class StatisticsSeries
+{
+private:
+    int num_states;                             // number of states counted (0 to num_states - 1)
+    std::vector<uint64_t> generations;          // generation of every sample
+    std::vector<std::vector<uint64_t>> counts;  // counts[state][sample]
+    std::vector<double> p_values;               // frequency of the dominant allele
+    std::vector<double> q_values;               // frequency of the recessive allele
+    std::vector<double> heterozygosity;         // fraction of heterozygous cells
+
+public:
+    StatisticsSeries(); // Default constructor
+
+    void clear();
+    void add(uint64_t generation, const std::vector<uint64_t> &state_counts);
+
+    size_t size() const;
+    int get_num_states() const;
+    uint64_t get_generation(size_t sample) const;
+    uint64_t get_count(size_t sample, int state) const;
+    double get_p(size_t sample) const;
+    double get_q(size_t sample) const;
+    double get_heterozygosity(size_t sample) const;
+
+    // Columns of the series (one value per sample)
+    const std::vector<uint64_t> &get_generations() const;
+    const std::vector<uint64_t> &get_counts(int state) const;
+    const std::vector<double> &get_p_values() const;
+    const std::vector<double> &get_q_values() const;
+    const std::vector<double> &get_heterozygosity_values() const;
+
+    // Functions to save and load the series as a columnar binary file:
+    //      magic "CASTATS1" (8) | version (4) | num_states (4) | num_samples (8) | reserved (8)
+    //      generations (8 * n) | counts of state 0 (8 * n) | ... | p (8 * n) | q (8 * n) | heterozygosity (8 * n)
+    // Integers are little-endian and frequencies are IEEE doubles.
+    bool write(const std::string &path) const;
+    bool read(const std::string &path);
+};
@@ -0,0 +1,50 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the API for the persistent
+// thread pool used by the cellular automata library to update the grid
+// in parallel row bands.
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class ThreadPool
+{
+private:
+    using BandFunction = std::function<void(int, int)>; // Work on the band [begin, end)
+
+    std::vector<std::thread> workers;   // worker threads (the calling thread also runs a band)
+    std::mutex mutex;                   // protects the job state below
+    std::mutex run_mutex;               // serialises callers of parallel_for
+    std::condition_variable start_cv;   // signals workers that a job is ready
+    std::condition_variable done_cv;    // signals the caller that all bands are done
+    const BandFunction *task;           // band function of the current job
+    int begin;                          // first index of the current job
+    int end;                            // one past the last index of the current job
+    int bands;                          // number of bands in the current job
+    int job;                            // counter identifying the current job
+    int pending;                        // bands of the current job not yet finished
+    bool stopping;                      // set when the pool is destroyed
+
+    void worker_loop(int band);
+    void run_band(int band);
+
+public:
+    explicit ThreadPool(int num_threads); // Constructor starting num_threads - 1 workers
+    ~ThreadPool();                        // Destructor joining the workers
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int get_num_threads() const;
+
+    // Function that splits [begin, end) into contiguous bands and runs
+    // task(band_begin, band_end) for each of them in parallel. The bands only
+    // depend on the range and max_bands, so results do not depend on timing.
+    void parallel_for(int begin, int end, const BandFunction &task, int max_bands);
+};
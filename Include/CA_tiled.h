@@ -0,0 +1,107 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the out-of-core mode of the
+// cellular automata library. The grid lives in a memory-mapped file, so it
+// can be larger than the memory of the node. Every generation streams the
+// file through a model of one tile of rows (with radius ghost rows above and
+// below it): the next tile is prefetched while a tile is computed, computed
+// tiles are written back in place and flushed behind the computation, and
+// tiles are released from memory once they are further behind than the
+// working set allows. The results are those of the in-memory compute
+// functions for every neighborhood, boundary type and rule.
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "CA_library.h"
+
+template <typename CellT = int>
+class BasicTiledAutomata
+{
+private:
+    int fd;                                  // file descriptor of the grid file (-1 when closed)
+    void *mapping;                           // mapping of the grid file
+    size_t mapping_bytes;                    // size of the mapping
+    size_t grid_offset;                      // offset of the first row in the file
+    int rows;                                // number of rows in the grid
+    int cols;                                // number of columns in the grid
+    int radius;                              // number of ghost rows on each side of a tile
+    int tile_rows;                           // number of rows in a tile
+    int resident_tiles;                      // computed tiles kept in memory behind the current tile
+    int bins;                                // number of states counted for the statistics
+    BoundaryType boundaries;                 // boundaries of the grid at its first and last rows
+    int k;                                   // state k (ghost rows of fixed boundaries)
+    bool collect_statistics;                 // count the states of every generation
+    uint64_t generation;                     // number of generations computed so far
+    BasicCellularAutomata<CellT> tile_model; // model of a full tile and its ghost rows
+    BasicCellularAutomata<CellT> last_model; // model of the last tile when it is shorter
+    std::vector<CellT> carry_rows;           // rows above the current tile, before it was written
+    std::vector<CellT> wrap_rows;            // first rows of the grid at the start of the generation
+    StatisticsSeries statistics;             // statistics of the computed generations
+
+    CellT *grid_row(int row) const;
+    void advise_rows(int first, int count, int advice) const;
+    void write_behind(int tile);
+    bool map_file(const std::string &path, bool create_file);
+    bool configure(const BasicCellularAutomata<CellT> &model, int tile_rows, int resident_tiles);
+    void write_header() const;
+
+public:
+    BasicTiledAutomata();  // Default constructor
+    ~BasicTiledAutomata(); // Destructor (flushes and closes the file)
+    BasicTiledAutomata(const BasicTiledAutomata &) = delete;
+    BasicTiledAutomata &operator=(const BasicTiledAutomata &) = delete;
+
+    // Function that creates a grid file, filled with the random states
+    // setup_dimensions() gives a model with the same seed and grid size
+    // Inputs:
+    //      model : Configured 2D model (its grid is not used)
+    //      path : Path of the grid file
+    //      rows : Number of rows in the grid
+    //      cols : Number of columns in the grid
+    //      tile_rows : Number of rows in a tile (at least the neighborhood radius)
+    //      resident_tiles : Computed tiles kept in memory behind the current tile
+    // Returns:
+    //      True if the file was created
+    bool create(const BasicCellularAutomata<CellT> &model, const std::string &path, int rows, int cols,
+                int tile_rows, int resident_tiles = 2);
+
+    // Function that opens a grid file created by create(), to resume its run
+    // Inputs:
+    //      model : Configured 2D model (its grid is not used)
+    //      path : Path of the grid file
+    //      tile_rows : Number of rows in a tile (at least the neighborhood radius)
+    //      resident_tiles : Computed tiles kept in memory behind the current tile
+    // Returns:
+    //      True if the file was opened
+    bool open(const BasicCellularAutomata<CellT> &model, const std::string &path, int tile_rows,
+              int resident_tiles = 2);
+
+    // Function that flushes and closes the grid file
+    void close();
+
+    // Function that advances the grid by several generations of the rule of the model
+    // Inputs:
+    //      generations : Number of generations
+    void step(uint64_t generations = 1);
+
+    // Functions to copy one row of the grid file (cols cells)
+    void read_row(int row, CellT *values) const;
+    void write_row(int row, const CellT *values);
+
+    bool get_open() const;
+    int get_grid_rows() const;
+    int get_grid_cols() const;
+    int get_tile_rows() const;
+    int get_resident_tiles() const;
+    uint64_t get_generation() const;
+    const StatisticsSeries &get_statistics() const;
+};
+
+// Out-of-core models with the common cell widths (the library is compiled for these)
+typedef BasicTiledAutomata<int> TiledAutomata;
+typedef BasicTiledAutomata<uint16_t> TiledAutomata16;
+typedef BasicTiledAutomata<uint8_t> TiledAutomata8;
@@ -0,0 +1,37 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file is the header file that contains the window sums used by the
+// compute functions for neighborhoods with a radius larger than 1. Every
+// function slides a window along the grid with prefix sums, so the cost per
+// cell does not depend on the radius.
+
+#pragma once // Ensures that this file is only included once
+             // during compilation
+#include <cstddef>
+
+// All functions read the padded grid buffer, which must have a halo of at
+// least radius cells, and write one sum per cell to sums (row-major).
+// Inputs:
+//      grid : First interior cell (row 0, column 0) of the padded buffer
+//      stride : Length of one padded row
+//      begin, end : Rows [begin, end) (columns for the 1D line) to compute
+//      cols : Number of cells in a row
+//      radius : Radius of the neighborhood (at least 1)
+//      match : If negative, the window sums cell states; otherwise it counts
+//              the cells in state match
+//      sums : Output, (end - begin) * cols sums (end - begin for the line)
+
+// Sums over the (2 * radius + 1) x (2 * radius + 1) square (Moore neighborhood)
+template <typename CellT>
+void moore_window_sums(const CellT *grid, ptrdiff_t stride, int begin, int end, int cols,
+                       int radius, int match, int *sums);
+
+// Sums over the diamond |di| + |dj| <= radius (Von Neumann neighborhood)
+template <typename CellT>
+void von_neumann_window_sums(const CellT *grid, ptrdiff_t stride, int begin, int end, int cols,
+                             int radius, int match, int *sums);
+
+// Sums over the 2 * radius + 1 cells around each cell of the 1D line
+template <typename CellT>
+void line_window_sums(const CellT *line, int begin, int end, int radius, int match, int *sums);
@@ -0,0 +1,376 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the bit-sliced grid used by the cellular automata
+// library for models with at most 4 states. Every word holds the low or the
+// high bit of 64 cells; the rules are evaluated with word-wide logic, and the
+// loops over the words of a row are simple enough for the compiler to
+// vectorise them.
+
+#include <algorithm>
+#include <cstddef>
+#include "CA_bitslice.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CA_X86_DISPATCH 1
+#define CA_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define CA_ALWAYS_INLINE inline
+#endif
+
+// Helper function that returns the cells of a word in the state whose bits
+// are state_low and state_high (all ones or all zeros)
+static CA_ALWAYS_INLINE uint64_t equal_state(uint64_t low, uint64_t high, uint64_t state_low, uint64_t state_high)
+{
+    return ~((low ^ state_low) | (high ^ state_high));
+}
+
+// Helper function that returns a word with every bit equal to bit b of state
+static inline uint64_t state_bit(int state, int b)
+{
+    return ((state >> b) & 1) ? ~static_cast<uint64_t>(0) : 0;
+}
+
+// Helper function that adds three bit-planes (full adder)
+static CA_ALWAYS_INLINE void full_add(uint64_t a, uint64_t b, uint64_t c, uint64_t &sum, uint64_t &carry)
+{
+    uint64_t partial = a ^ b;
+    sum = partial ^ c;
+    carry = (a & b) | (partial & c);
+}
+
+// Helper function that counts the set bits of NUM bit-planes (2, 4 or 8) per cell
+// Inputs:
+//      x : The bit-planes
+//      count : Bit-sliced count (4 bits)
+template <int NUM>
+static CA_ALWAYS_INLINE void count_planes(const uint64_t *x, uint64_t count[4])
+{
+    if (NUM == 2)
+    {
+        count[0] = x[0] ^ x[1];
+        count[1] = x[0] & x[1];
+        count[2] = count[3] = 0;
+    }
+    else if (NUM == 4)
+    {
+        uint64_t s, c;
+        full_add(x[0], x[1], x[2], s, c);
+        count[0] = s ^ x[3];
+        uint64_t c2 = s & x[3];
+        count[1] = c ^ c2;
+        count[2] = c & c2;
+        count[3] = 0;
+    }
+    else
+    {
+        uint64_t s1, c1, s2, c2, s3, c3, s5, c5;
+        full_add(x[0], x[1], x[2], s1, c1);
+        full_add(x[3], x[4], x[5], s2, c2);
+        full_add(s1, s2, x[6], s3, c3);
+        count[0] = s3 ^ x[7];
+        uint64_t c4 = s3 & x[7];
+        full_add(c1, c2, c3, s5, c5);
+        count[1] = s5 ^ c4;
+        uint64_t c6 = s5 & c4;
+        count[2] = c5 ^ c6;
+        count[3] = c5 & c6;
+    }
+}
+
+// Helper function that returns the cells whose neighbor sum low + 2 * high
+// (the number of low and of high bits set) is at least threshold
+static CA_ALWAYS_INLINE uint64_t sum_at_least(const uint64_t low[4], const uint64_t high[4], int threshold)
+{
+    // Bit-sliced sum (at most 8 neighbors in state 3: 24, 5 bits)
+    uint64_t sum[5], carry;
+    sum[0] = low[0];
+    sum[1] = low[1] ^ high[0];
+    carry = low[1] & high[0];
+    full_add(low[2], high[1], carry, sum[2], carry);
+    full_add(low[3], high[2], carry, sum[3], carry);
+    sum[4] = high[3] ^ carry;
+
+    uint64_t greater = 0, equal = ~static_cast<uint64_t>(0);
+    for (int bit = 4; bit >= 0; --bit)
+    {
+        if ((threshold >> bit) & 1)
+        {
+            equal &= sum[bit];
+        }
+        else
+        {
+            greater |= equal & sum[bit];
+            equal &= ~sum[bit];
+        }
+    }
+    return greater | equal;
+}
+
+// Default constructor
+BitSlicedGrid::BitSlicedGrid() : rows(0), cols(0), words(0) {}
+
+// Function that sets the size of the grid (every cell in state 0)
+// Inputs:
+//      rows : Number of rows
+//      cols : Number of columns
+void BitSlicedGrid::resize(int rows, int cols)
+{
+    this->rows = rows;
+    this->cols = cols;
+    words = (cols + 2 + 63) / 64;
+    stride = words + 2;
+    size_t size = static_cast<size_t>(rows + 2) * stride;
+    for (int p = 0; p < 2; ++p)
+    {
+        planes[p].assign(size, 0);
+        next_planes[p].assign(size, 0);
+    }
+}
+
+// Helper function that sets one bit of a plane
+void BitSlicedGrid::set_bit(std::vector<uint64_t> &plane, int row, int position, int value)
+{
+    uint64_t &word = row_words(plane, row)[position >> 6];
+    uint64_t bit = static_cast<uint64_t>(1) << (position & 63);
+    word = value ? (word | bit) : (word & ~bit);
+}
+
+// Function that fills the ghost cells and rows from the boundaries
+// Periodic boundaries copy the opposite edge, fixed boundaries put the cells
+// in fixed_state and no boundaries repeat the nearest edge cell, as the
+// halo of the model does.
+// Inputs:
+//      boundaries : The boundary type
+//      fixed_state : State of the ghost cells for fixed boundaries
+//      line : True for 1D (only the ghost cells of the rows are filled)
+void BitSlicedGrid::fill_ghosts(BoundaryType boundaries, int fixed_state, bool line)
+{
+    for (int p = 0; p < 2; ++p)
+    {
+        std::vector<uint64_t> &plane = planes[p];
+        int fixed_bit = (fixed_state >> p) & 1;
+        for (int r = 1; r <= rows; ++r)
+        {
+            int west = (boundaries == PERIODIC) ? get_bit(plane, r, cols) : get_bit(plane, r, 1);
+            int east = (boundaries == PERIODIC) ? get_bit(plane, r, 1) : get_bit(plane, r, cols);
+            set_bit(plane, r, 0, boundaries == FIXED ? fixed_bit : west);
+            set_bit(plane, r, cols + 1, boundaries == FIXED ? fixed_bit : east);
+        }
+        if (line)
+        {
+            continue;
+        }
+
+        // Ghost rows (copied after the ghost cells, so the corners are right)
+        uint64_t *above = row_words(plane, 0) - 1;
+        uint64_t *below = row_words(plane, rows + 1) - 1;
+        if (boundaries == FIXED)
+        {
+            std::fill(above, above + stride, fixed_bit ? ~static_cast<uint64_t>(0) : 0);
+            std::fill(below, below + stride, fixed_bit ? ~static_cast<uint64_t>(0) : 0);
+        }
+        else
+        {
+            const uint64_t *first = row_words(plane, boundaries == PERIODIC ? rows : 1) - 1;
+            const uint64_t *last = row_words(plane, boundaries == PERIODIC ? 1 : rows) - 1;
+            std::copy(first, first + stride, above);
+            std::copy(last, last + stride, below);
+        }
+    }
+}
+
+// Bit-sliced rule on one row: every word reads the words before and after it
+// (the spare words around a row), so the loop has no tests and is vectorised
+// Inputs:
+//      low, high : Bit-planes of the row (north and south rows at -stride and +stride)
+//      next_low, next_high : Bit-planes of the next generation
+//      words : Number of words in the row
+template <bool LINE, NeighborhoodType N, RuleType R>
+CA_ALWAYS_INLINE void bitsliced_row_body(const uint64_t *__restrict low, const uint64_t *__restrict high,
+                                         ptrdiff_t stride, uint64_t *__restrict next_low,
+                                         uint64_t *__restrict next_high, int words, int k, int kprime)
+{
+    const int num_neighbors = LINE ? 2 : (N == MOORE ? 8 : 4);
+    const int threshold = LINE ? 1 : (N == MOORE ? 5 : 2);
+    const uint64_t k_low = state_bit(k, 0), k_high = state_bit(k, 1);
+    const uint64_t kprime_low = state_bit(kprime, 0), kprime_high = state_bit(kprime, 1);
+    const uint64_t *__restrict north_low = low - (LINE ? 0 : stride);
+    const uint64_t *__restrict north_high = high - (LINE ? 0 : stride);
+    const uint64_t *__restrict south_low = low + (LINE ? 0 : stride);
+    const uint64_t *__restrict south_high = high + (LINE ? 0 : stride);
+
+    for (int w = 0; w < words; ++w)
+    {
+        // Bit j of the west plane holds cell j - 1, of the east plane cell j + 1
+        uint64_t nl[8], nh[8];
+        nl[0] = (low[w] << 1) | (low[w - 1] >> 63);
+        nh[0] = (high[w] << 1) | (high[w - 1] >> 63);
+        nl[1] = (low[w] >> 1) | (low[w + 1] << 63);
+        nh[1] = (high[w] >> 1) | (high[w + 1] << 63);
+        if (!LINE)
+        {
+            nl[2] = north_low[w], nh[2] = north_high[w];
+            nl[3] = south_low[w], nh[3] = south_high[w];
+        }
+        if (!LINE && N == MOORE)
+        {
+            nl[4] = (north_low[w] << 1) | (north_low[w - 1] >> 63);
+            nh[4] = (north_high[w] << 1) | (north_high[w - 1] >> 63);
+            nl[5] = (north_low[w] >> 1) | (north_low[w + 1] << 63);
+            nh[5] = (north_high[w] >> 1) | (north_high[w + 1] << 63);
+            nl[6] = (south_low[w] << 1) | (south_low[w - 1] >> 63);
+            nh[6] = (south_high[w] << 1) | (south_high[w - 1] >> 63);
+            nl[7] = (south_low[w] >> 1) | (south_low[w + 1] << 63);
+            nh[7] = (south_high[w] >> 1) | (south_high[w + 1] << 63);
+        }
+
+        uint64_t changes = equal_state(low[w], high[w], k_low, k_high);
+        if (R == CONDITIONAL_TRANSITION)
+        {
+            auto is_kprime = [&](int n) { return equal_state(nl[n], nh[n], kprime_low, kprime_high); };
+            uint64_t any = is_kprime(0) | is_kprime(1);
+            if (!LINE)
+                any |= is_kprime(2) | is_kprime(3);
+            if (!LINE && N == MOORE)
+                any |= is_kprime(4) | is_kprime(5) | is_kprime(6) | is_kprime(7);
+            changes &= any;
+        }
+        else if (R == MAJORITY_RULE)
+        {
+            uint64_t low_count[4], high_count[4];
+            count_planes<num_neighbors>(nl, low_count);
+            count_planes<num_neighbors>(nh, high_count);
+            changes &= sum_at_least(low_count, high_count, threshold);
+        }
+
+        next_low[w] = (low[w] & ~changes) | (kprime_low & changes);
+        next_high[w] = (high[w] & ~changes) | (kprime_high & changes);
+    }
+}
+
+// Function computing one row of the bit-planes
+typedef void (*BitSlicedRow)(const uint64_t *, const uint64_t *, ptrdiff_t, uint64_t *, uint64_t *, int, int, int);
+
+// Defines the row functions of one instruction set (as the row kernels in
+// CA_kernels.cpp). ATTR is the function attribute selecting the target.
+#define CA_DEFINE_BITSLICED(SUFFIX, ATTR)                                                             \
+    template <bool LINE, NeighborhoodType N, RuleType R>                                              \
+    ATTR void bitsliced_row_##SUFFIX(const uint64_t *low, const uint64_t *high, ptrdiff_t stride,     \
+                                     uint64_t *next_low, uint64_t *next_high, int words, int k,       \
+                                     int kprime)                                                      \
+    {                                                                                                 \
+        bitsliced_row_body<LINE, N, R>(low, high, stride, next_low, next_high, words, k, kprime);     \
+    }                                                                                                 \
+    static BitSlicedRow select_bitsliced_##SUFFIX(int shape, RuleType rule)                           \
+    {                                                                                                 \
+        static const BitSlicedRow rows[3][3] = {                                                      \
+            {bitsliced_row_##SUFFIX<true, VON_NEUMANN, STRAIGHT_CONDITIONAL>,                         \
+             bitsliced_row_##SUFFIX<true, VON_NEUMANN, CONDITIONAL_TRANSITION>,                       \
+             bitsliced_row_##SUFFIX<true, VON_NEUMANN, MAJORITY_RULE>},                               \
+            {bitsliced_row_##SUFFIX<false, VON_NEUMANN, STRAIGHT_CONDITIONAL>,                        \
+             bitsliced_row_##SUFFIX<false, VON_NEUMANN, CONDITIONAL_TRANSITION>,                      \
+             bitsliced_row_##SUFFIX<false, VON_NEUMANN, MAJORITY_RULE>},                              \
+            {bitsliced_row_##SUFFIX<false, MOORE, STRAIGHT_CONDITIONAL>,                              \
+             bitsliced_row_##SUFFIX<false, MOORE, CONDITIONAL_TRANSITION>,                            \
+             bitsliced_row_##SUFFIX<false, MOORE, MAJORITY_RULE>}};                                   \
+        return rows[shape][rule];                                                                     \
+    }
+
+CA_DEFINE_BITSLICED(baseline, )
+
+#ifdef CA_X86_DISPATCH
+CA_DEFINE_BITSLICED(avx2, __attribute__((target("avx2"))))
+CA_DEFINE_BITSLICED(avx512, __attribute__((target("avx512f,avx512bw,prefer-vector-width=512"))))
+#endif
+
+// Function that computes the next generation of the rows [begin, end)
+// Every cell in state k whose neighbors pass the test of the rule moves to
+// state k': Conditional Transition tests whether any neighbor is in state k',
+// Majority Rule whether the sum of the neighbor states reaches the threshold
+// of the direct kernels (1 for 1D, 2 for Von Neumann, 5 for Moore).
+// Inputs:
+//      begin, end : Rows to compute
+//      dimensions, neighborhood, rule : The configuration of the model
+//      k, kprime : The states used by the rule (0 to 3)
+//      vectorize : If true, the widest instruction set supported by the CPU is used
+void BitSlicedGrid::step_rows(int begin, int end, DimensionType dimensions, NeighborhoodType neighborhood,
+                              RuleType rule, int k, int kprime, bool vectorize)
+{
+    int shape = (dimensions == ONE_DIMENSIONAL) ? 0 : (neighborhood == MOORE ? 2 : 1);
+    BitSlicedRow row_function = select_bitsliced_baseline(shape, rule);
+#ifdef CA_X86_DISPATCH
+    static const int isa = __builtin_cpu_supports("avx512bw") ? 2 : (__builtin_cpu_supports("avx2") ? 1 : 0);
+    if (vectorize && isa == 2)
+        row_function = select_bitsliced_avx512(shape, rule);
+    else if (vectorize && isa == 1)
+        row_function = select_bitsliced_avx2(shape, rule);
+#endif
+
+    for (int i = begin; i < end; ++i)
+    {
+        row_function(row_words(planes[0], i + 1), row_words(planes[1], i + 1), stride,
+                     row_words(next_planes[0], i + 1), row_words(next_planes[1], i + 1), words, k, kprime);
+    }
+}
+
+// Function that counts the states of the next generation in the rows [begin, end)
+// Inputs:
+//      begin, end : Rows to count
+//      counts : Incremented for the states 0 to 3 (if it has that many entries)
+void BitSlicedGrid::count_rows(int begin, int end, std::vector<uint64_t> &counts) const
+{
+    int num_states = std::min(static_cast<int>(counts.size()), 4);
+    for (int i = begin; i < end; ++i)
+    {
+        const uint64_t *low = row_words(next_planes[0], i + 1);
+        const uint64_t *high = row_words(next_planes[1], i + 1);
+        for (int w = 0; w < words; ++w)
+        {
+            // Only the bits 1 to cols hold cells
+            uint64_t mask = ~static_cast<uint64_t>(0);
+            if (w == 0)
+                mask &= ~static_cast<uint64_t>(1);
+            int last = cols - w * 64; // bit of the last cell (bits above it are not cells)
+            if (last < 63)
+                mask &= (static_cast<uint64_t>(1) << (last + 1)) - 1;
+            for (int s = 0; s < num_states; ++s)
+            {
+                counts[s] += __builtin_popcountll(equal_state(low[w], high[w], state_bit(s, 0), state_bit(s, 1)) & mask);
+            }
+        }
+    }
+}
+
+// Function that counts the cells of the rows [begin, end) whose state differs
+// between the current and the next generation
+uint64_t BitSlicedGrid::count_changed_rows(int begin, int end) const
+{
+    uint64_t changed = 0;
+    for (int i = begin; i < end; ++i)
+    {
+        const uint64_t *low = row_words(planes[0], i + 1);
+        const uint64_t *high = row_words(planes[1], i + 1);
+        const uint64_t *next_low = row_words(next_planes[0], i + 1);
+        const uint64_t *next_high = row_words(next_planes[1], i + 1);
+        for (int w = 0; w < words; ++w)
+        {
+            // Only the bits 1 to cols hold cells
+            uint64_t mask = ~static_cast<uint64_t>(0);
+            if (w == 0)
+                mask &= ~static_cast<uint64_t>(1);
+            int last = cols - w * 64;
+            if (last < 63)
+                mask &= (static_cast<uint64_t>(1) << (last + 1)) - 1;
+            changed += __builtin_popcountll(((low[w] ^ next_low[w]) | (high[w] ^ next_high[w])) & mask);
+        }
+    }
+    return changed;
+}
+
+// Function that makes the next generation the current one
+void BitSlicedGrid::swap()
+{
+    planes[0].swap(next_planes[0]);
+    planes[1].swap(next_planes[1]);
+}
@@ -0,0 +1,459 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the implementation of the distributed mode of the
+// cellular automata library. The parent process forks one worker per slab of
+// rows. The workers and the parent share one anonymous mapping with a process
+// shared barrier, the command block, the halo rows of every slab (double
+// buffered by the parity of the generation), the state counts of every slab
+// and a transfer area used to gather the grid.
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "CA_distributed.h"
+
+namespace
+{
+enum Command
+{
+    COMMAND_STEP,
+    COMMAND_GATHER,
+    COMMAND_STOP
+};
+
+enum Side
+{
+    TOP_ROWS,
+    BOTTOM_ROWS
+};
+
+// Helper function that rounds an offset of the shared mapping to a cache line
+size_t align_offset(size_t offset)
+{
+    return (offset + 63) & ~static_cast<size_t>(63);
+}
+}
+
+template <typename CellT>
+struct BasicDistributedAutomata<CellT>::SharedControl
+{
+    pthread_barrier_t barrier; // the parent and every worker
+    int command;               // command run by the workers after the next barrier
+    int target;                // worker that copies its slab for gather
+    uint64_t generations;      // number of generations of a step command
+};
+
+// Default constructor
+template <typename CellT>
+BasicDistributedAutomata<CellT>::BasicDistributedAutomata()
+    : num_workers(0), rows(0), cols(0), radius(1), bins(0), collect_statistics(false), generation(0),
+      shared(nullptr), shared_bytes(0), halo_offset(0), counts_offset(0), transfer_offset(0), control(nullptr)
+{
+}
+
+// Destructor (stops the workers)
+template <typename CellT>
+BasicDistributedAutomata<CellT>::~BasicDistributedAutomata()
+{
+    stop();
+}
+
+// Helper function that returns the halo rows published by a worker
+// Inputs:
+//      parity : Parity of the generation
+//      worker : The worker
+//      side : TOP_ROWS (first rows of the slab) or BOTTOM_ROWS (last rows)
+// Returns:
+//      The radius rows of cols cells
+template <typename CellT>
+CellT *BasicDistributedAutomata<CellT>::halo_rows(int parity, int worker, int side) const
+{
+    size_t slot = (static_cast<size_t>(parity) * num_workers + worker) * 2 + side;
+    return reinterpret_cast<CellT *>(static_cast<char *>(shared) + halo_offset) +
+           slot * static_cast<size_t>(radius) * cols;
+}
+
+// Helper function that returns the state counts of a worker
+// Inputs:
+//      parity : Parity of the generation
+//      worker : The worker
+// Returns:
+//      The bins counts of the slab
+template <typename CellT>
+uint64_t *BasicDistributedAutomata<CellT>::worker_counts(int parity, int worker) const
+{
+    size_t slot = static_cast<size_t>(parity) * num_workers + worker;
+    return reinterpret_cast<uint64_t *>(static_cast<char *>(shared) + counts_offset) + slot * bins;
+}
+
+// Helper function that returns the area a worker copies its slab to for gather
+template <typename CellT>
+CellT *BasicDistributedAutomata<CellT>::transfer_rows() const
+{
+    return reinterpret_cast<CellT *>(static_cast<char *>(shared) + transfer_offset);
+}
+
+// Helper function that waits until the parent and every worker reach the barrier
+template <typename CellT>
+void BasicDistributedAutomata<CellT>::wait_all() const
+{
+    pthread_barrier_wait(&control->barrier);
+}
+
+// Function that splits a model across worker processes
+// The rows are split into slabs of at least radius rows, so the halo of a
+// slab only comes from the slabs above and below it.
+// Inputs:
+//      model : Configured 2D model with a grid
+//      num_workers : Number of worker processes
+// Returns:
+//      True if the workers were started
+template <typename CellT>
+bool BasicDistributedAutomata<CellT>::start(const BasicCellularAutomata<CellT> &model, int num_workers)
+{
+    stop();
+
+    if (model.get_dimensions() != TWO_DIMENSIONAL)
+    {
+        std::cerr << "Error: The distributed mode only splits 2D grids." << std::endl;
+        return false;
+    }
+    if (model.get_grid_rows() <= 0 || model.get_grid_cols() <= 0)
+    {
+        std::cerr << "Error: The model has no grid to distribute." << std::endl;
+        return false;
+    }
+
+    rows = model.get_grid_rows();
+    cols = model.get_grid_cols();
+    radius = model.get_neighborhood_radius();
+    bins = std::max(model.get_states(), 3) + 1;
+    collect_statistics = model.get_statistics_enabled();
+    generation = model.get_generation();
+    statistics.clear();
+
+    // Every slab needs at least radius rows
+    this->num_workers = std::max(1, std::min(num_workers, rows / radius));
+    first_rows.assign(this->num_workers + 1, 0);
+    int max_slab = 0;
+    for (int worker = 0; worker <= this->num_workers; ++worker)
+    {
+        first_rows[worker] = static_cast<int>(static_cast<int64_t>(rows) * worker / this->num_workers);
+        if (worker > 0)
+        {
+            max_slab = std::max(max_slab, first_rows[worker] - first_rows[worker - 1]);
+        }
+    }
+
+    // Control block | halo rows [parity][worker][side] | counts [parity][worker] | transfer rows
+    size_t halo_bytes = 2 * static_cast<size_t>(this->num_workers) * 2 * radius * cols * sizeof(CellT);
+    size_t counts_bytes = 2 * static_cast<size_t>(this->num_workers) * bins * sizeof(uint64_t);
+    halo_offset = align_offset(sizeof(SharedControl));
+    counts_offset = align_offset(halo_offset + halo_bytes);
+    transfer_offset = align_offset(counts_offset + counts_bytes);
+    shared_bytes = transfer_offset + static_cast<size_t>(max_slab) * cols * sizeof(CellT);
+
+    shared = mmap(nullptr, shared_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED)
+    {
+        std::cerr << "Error: Could not map the memory shared with the workers." << std::endl;
+        shared = nullptr;
+        this->num_workers = 0;
+        return false;
+    }
+
+    control = new (shared) SharedControl();
+    pthread_barrierattr_t attributes;
+    pthread_barrierattr_init(&attributes);
+    pthread_barrierattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(&control->barrier, &attributes, this->num_workers + 1);
+    pthread_barrierattr_destroy(&attributes);
+
+    std::cout.flush();
+    std::cerr.flush();
+    for (int worker = 0; worker < this->num_workers; ++worker)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            run_worker(worker, model);
+        }
+        if (pid < 0)
+        {
+            std::cerr << "Error: Could not start worker process " << worker << "." << std::endl;
+            for (pid_t started : workers)
+            {
+                kill(started, SIGKILL);
+                waitpid(started, nullptr, 0);
+            }
+            workers.clear();
+            pthread_barrier_destroy(&control->barrier);
+            munmap(shared, shared_bytes);
+            shared = nullptr;
+            control = nullptr;
+            this->num_workers = 0;
+            return false;
+        }
+        workers.push_back(pid);
+    }
+    return true;
+}
+
+// Helper function that runs a worker process (it never returns)
+// The worker pins itself to one of the CPUs the process may run on (and
+// reports when it cannot), so its slab is allocated and stays on the memory
+// node of that CPU, and keeps the slab with radius ghost rows above and below
+// it in a model of its own. Every generation it publishes the rows at the
+// edges of its slab, reads the rows of its neighbors into the ghost rows (or
+// fills them from the boundaries at the edges of the grid) and steps its model.
+// Inputs:
+//      worker : The worker
+//      model : The model copied by the worker
+template <typename CellT>
+void BasicDistributedAutomata<CellT>::run_worker(int worker, const BasicCellularAutomata<CellT> &model)
+{
+    // Workers take the CPUs the process may run on (a cpuset or a container
+    // may allow only some of them) in turn
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool pinned = false;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0 && CPU_COUNT(&allowed) > 0)
+    {
+        int skip = worker % CPU_COUNT(&allowed);
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &allowed) && skip-- == 0)
+            {
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                CPU_SET(cpu, &cpus);
+                pinned = sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+                break;
+            }
+        }
+    }
+    if (!pinned)
+    {
+        std::cerr << "Error: Worker " << worker << " could not be pinned to a CPU, so its slab may not stay on "
+                  << "one memory node." << std::endl;
+    }
+
+    const int first = first_rows[worker];
+    const int slab = first_rows[worker + 1] - first;
+    const BoundaryType boundaries = model.get_boundaries();
+    const bool wrap = boundaries == PERIODIC;
+    const bool top_edge = worker == 0 && !wrap;
+    const bool bottom_edge = worker == num_workers - 1 && !wrap;
+    const int above = (worker + num_workers - 1) % num_workers;
+    const int below = (worker + 1) % num_workers;
+
+    // The threads of the parent are not forked, so the copy runs on this process only
+    BasicCellularAutomata<CellT> local = model;
+    local.set_num_threads(1);
+    local.set_statistics(false);
+    if (local.get_engine() == MEMOISED_ENGINE)
+    {
+        local.set_engine(DIRECT_ENGINE);
+    }
+    local.set_grid(std::vector<std::vector<int>>(slab + 2 * radius, std::vector<int>(cols, 0)));
+    for (int i = 0; i < slab; ++i)
+    {
+        local.set_row(radius + i, model.get_row(first + i));
+    }
+
+    const std::vector<CellT> fixed_row(cols, static_cast<CellT>(model.get_k()));
+
+    for (;;)
+    {
+        wait_all();
+        int command = control->command;
+        if (command == COMMAND_STEP)
+        {
+            uint64_t generations = control->generations;
+            for (uint64_t g = 0; g < generations; ++g)
+            {
+                int parity = static_cast<int>(g & 1);
+                for (int i = 0; i < radius; ++i)
+                {
+                    std::copy_n(local.get_row(radius + i), cols, halo_rows(parity, worker, TOP_ROWS) + i * cols);
+                    std::copy_n(local.get_row(slab + i), cols, halo_rows(parity, worker, BOTTOM_ROWS) + i * cols);
+                }
+                wait_all();
+
+                // Ghost rows: the neighbors' edges, the fixed state or the edge row repeated
+                for (int i = 0; i < radius; ++i)
+                {
+                    const CellT *top = top_edge ? (boundaries == FIXED ? fixed_row.data() : local.get_row(radius))
+                                                : halo_rows(parity, above, BOTTOM_ROWS) + i * cols;
+                    const CellT *bottom = bottom_edge ? (boundaries == FIXED ? fixed_row.data() : local.get_row(radius + slab - 1))
+                                                      : halo_rows(parity, below, TOP_ROWS) + i * cols;
+                    local.set_row(i, top);
+                    local.set_row(radius + slab + i, bottom);
+                }
+                local.step();
+
+                if (collect_statistics)
+                {
+                    uint64_t *counts = worker_counts(parity, worker);
+                    std::fill_n(counts, bins, 0);
+                    const int last = bins - 1;
+                    for (int i = 0; i < slab; ++i)
+                    {
+                        const CellT *row = local.get_row(radius + i);
+                        for (int j = 0; j < cols; ++j)
+                        {
+                            int state = row[j];
+                            ++counts[state < 0 ? 0 : (state > last ? last : state)];
+                        }
+                    }
+                }
+            }
+            wait_all();
+        }
+        else if (command == COMMAND_GATHER)
+        {
+            if (control->target == worker)
+            {
+                for (int i = 0; i < slab; ++i)
+                {
+                    std::copy_n(local.get_row(radius + i), cols, transfer_rows() + static_cast<size_t>(i) * cols);
+                }
+            }
+            wait_all();
+        }
+        else
+        {
+            _exit(0);
+        }
+    }
+}
+
+// Function that advances every slab by several generations
+// The counts of a generation are summed once every worker is past it, while
+// the workers compute the next one.
+// Inputs:
+//      generations : Number of generations
+template <typename CellT>
+void BasicDistributedAutomata<CellT>::step(uint64_t generations)
+{
+    if (!get_running() || generations == 0)
+    {
+        return;
+    }
+    control->command = COMMAND_STEP;
+    control->generations = generations;
+    wait_all();
+
+    std::vector<uint64_t> counts(bins);
+    for (uint64_t g = 0; g <= generations; ++g)
+    {
+        wait_all();
+        if (g > 0 && collect_statistics)
+        {
+            int parity = static_cast<int>((g - 1) & 1);
+            std::fill(counts.begin(), counts.end(), 0);
+            for (int worker = 0; worker < num_workers; ++worker)
+            {
+                const uint64_t *worker_states = worker_counts(parity, worker);
+                for (int state = 0; state < bins; ++state)
+                {
+                    counts[state] += worker_states[state];
+                }
+            }
+            statistics.add(generation + g, counts);
+        }
+    }
+    generation += generations;
+}
+
+// Function that copies the grid of the workers into a model
+// Inputs:
+//      model : Model with the same grid size
+// Returns:
+//      True if the grid was copied
+template <typename CellT>
+bool BasicDistributedAutomata<CellT>::gather(BasicCellularAutomata<CellT> &model)
+{
+    if (!get_running())
+    {
+        std::cerr << "Error: The distributed model has no workers." << std::endl;
+        return false;
+    }
+    if (model.get_grid_rows() != rows || model.get_grid_cols() != cols)
+    {
+        std::cerr << "Error: The model does not have the grid size of the distributed model." << std::endl;
+        return false;
+    }
+
+    for (int worker = 0; worker < num_workers; ++worker)
+    {
+        control->command = COMMAND_GATHER;
+        control->target = worker;
+        wait_all();
+        wait_all();
+        for (int i = first_rows[worker]; i < first_rows[worker + 1]; ++i)
+        {
+            model.set_row(i, transfer_rows() + static_cast<size_t>(i - first_rows[worker]) * cols);
+        }
+    }
+    return true;
+}
+
+// Function that stops the worker processes
+template <typename CellT>
+void BasicDistributedAutomata<CellT>::stop()
+{
+    if (!get_running())
+    {
+        return;
+    }
+    control->command = COMMAND_STOP;
+    wait_all();
+    for (pid_t worker : workers)
+    {
+        waitpid(worker, nullptr, 0);
+    }
+    workers.clear();
+    pthread_barrier_destroy(&control->barrier);
+    munmap(shared, shared_bytes);
+    shared = nullptr;
+    control = nullptr;
+    num_workers = 0;
+}
+
+template <typename CellT>
+bool BasicDistributedAutomata<CellT>::get_running() const
+{
+    return control != nullptr;
+}
+
+template <typename CellT>
+int BasicDistributedAutomata<CellT>::get_num_workers() const
+{
+    return num_workers;
+}
+
+template <typename CellT>
+uint64_t BasicDistributedAutomata<CellT>::get_generation() const
+{
+    return generation;
+}
+
+template <typename CellT>
+const StatisticsSeries &BasicDistributedAutomata<CellT>::get_statistics() const
+{
+    return statistics;
+}
+
+// Explicit instantiations for the cell widths of the library
+template class BasicDistributedAutomata<int>;
+template class BasicDistributedAutomata<uint16_t>;
+template class BasicDistributedAutomata<uint8_t>;
@@ -0,0 +1,308 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the implementation of the ensemble runner of the
+// cellular automata library. The replicates are split into one contiguous
+// range per thread; a thread that runs out of replicates steals the second
+// half of the range of another thread, so large and small grids in the same
+// sweep keep every thread busy.
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include "CA_ensemble.h"
+#include "CA_random.h"
+
+// Default constructor (the allele model of test_genotype)
+SweepSpec::SweepSpec()
+    : recessive_frequencies(1, 0.5), grid_sizes(1, std::make_pair(10, 10)), rules(1, CONDITIONAL_TRANSITION),
+      seeds(1, 0), model(GENOTYPE_MODEL), dimensions(TWO_DIMENSIONAL), neighborhood(VON_NEUMANN),
+      boundaries(NO_BOUNDARIES), states(3), k(1), kprime(3), generations(100)
+{
+}
+
+template <typename CellT>
+struct BasicEnsembleRunner<CellT>::RunQueue
+{
+    std::mutex mutex; // protects the range
+    int next;         // next replicate of the thread
+    int end;          // one past the last replicate of the thread
+};
+
+// Default constructor
+template <typename CellT>
+BasicEnsembleRunner<CellT>::BasicEnsembleRunner() : num_threads(1)
+{
+    set_num_threads(0);
+}
+
+// Setter method to set the number of threads running replicates
+// Every thread runs whole replicates, each on a single-threaded model.
+// Inputs:
+//      num_threads : Number of threads (0 uses every hardware thread)
+template <typename CellT>
+void BasicEnsembleRunner<CellT>::set_num_threads(int num_threads)
+{
+    if (num_threads <= 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    this->num_threads = num_threads;
+}
+
+// Helper function that gives a thread its next replicate
+// The thread takes the first replicate of its own range. If the range is
+// empty, it steals the second half of the first non-empty range of the other
+// threads. Only one lock is held at a time.
+// Inputs:
+//      queues : The ranges of the threads
+//      thread : The thread
+//      run : Set to the replicate to run
+// Returns:
+//      False once every replicate has been taken
+template <typename CellT>
+bool BasicEnsembleRunner<CellT>::take_run(std::vector<RunQueue> &queues, int thread, int &run) const
+{
+    RunQueue &own = queues[thread];
+    {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.next < own.end)
+        {
+            run = own.next++;
+            return true;
+        }
+    }
+
+    for (int offset = 1; offset < static_cast<int>(queues.size()); ++offset)
+    {
+        RunQueue &victim = queues[(thread + offset) % queues.size()];
+        int begin, end;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            int remaining = victim.end - victim.next;
+            if (remaining <= 0)
+            {
+                continue;
+            }
+            begin = victim.end - (remaining + 1) / 2;
+            end = victim.end;
+            victim.end = begin;
+        }
+
+        std::lock_guard<std::mutex> lock(own.mutex);
+        run = begin;
+        own.next = begin + 1;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
+
+// Helper function that runs one replicate on a model reused between replicates
+// The starting population is in Hardy-Weinberg proportions for the starting
+// frequency of the recessive allele, drawn from the replicate's seed.
+// Inputs:
+//      model : The model of the thread
+//      run : The replicate
+template <typename CellT>
+void BasicEnsembleRunner<CellT>::run_replicate(BasicCellularAutomata<CellT> &model, int run)
+{
+    const EnsembleRun &replicate = runs[run];
+
+    model.set_rule(replicate.rule);
+    model.set_seed(replicate.seed);
+    model.set_grid_size(replicate.rows, replicate.cols);
+    model.setup_population(replicate.recessive_frequency);
+
+    model.clear_statistics();
+    model.record_statistics();
+    if (spec.model == GENOTYPE_MODEL)
+    {
+        model.update(spec.generations);
+    }
+    else
+    {
+        model.step(spec.generations);
+    }
+    results[run] = model.get_statistics();
+}
+
+// Function that runs every replicate of a sweep
+// Inputs:
+//      spec : The sweep
+// Returns:
+//      True if the sweep was valid and run
+template <typename CellT>
+bool BasicEnsembleRunner<CellT>::run(const SweepSpec &spec)
+{
+    if (spec.recessive_frequencies.empty() || spec.grid_sizes.empty() || spec.rules.empty() || spec.seeds.empty())
+    {
+        std::cerr << "Error: Every list of the sweep needs at least one value." << std::endl;
+        return false;
+    }
+    for (double frequency : spec.recessive_frequencies)
+    {
+        if (frequency < 0.0 || frequency > 1.0)
+        {
+            std::cerr << "Error: Frequencies of the sweep must be between 0 and 1." << std::endl;
+            return false;
+        }
+    }
+    for (const std::pair<int, int> &size : spec.grid_sizes)
+    {
+        if (size.first <= 0 || size.second <= 0)
+        {
+            std::cerr << "Error: Grid sizes of the sweep must be positive." << std::endl;
+            return false;
+        }
+    }
+    if (spec.generations < 0)
+    {
+        std::cerr << "Error: The number of generations cannot be negative." << std::endl;
+        return false;
+    }
+
+    // Replicates in the order frequency, grid size, rule, seed (seeds of a configuration are adjacent)
+    this->spec = spec;
+    runs.clear();
+    for (double frequency : spec.recessive_frequencies)
+        for (const std::pair<int, int> &size : spec.grid_sizes)
+            for (RuleType rule : spec.rules)
+                for (uint64_t seed : spec.seeds)
+                {
+                    EnsembleRun replicate = {frequency, size.first, size.second, rule, seed};
+                    runs.push_back(replicate);
+                }
+    results.assign(runs.size(), StatisticsSeries());
+
+    int threads = static_cast<int>(std::min<size_t>(num_threads, runs.size()));
+    std::vector<RunQueue> queues(threads);
+    for (int thread = 0; thread < threads; ++thread)
+    {
+        queues[thread].next = static_cast<int>(runs.size() * thread / threads);
+        queues[thread].end = static_cast<int>(runs.size() * (thread + 1) / threads);
+    }
+
+    auto work = [&](int thread) {
+        BasicCellularAutomata<CellT> model;
+        model.set_dimensions(spec.dimensions);
+        model.set_neighborhood(spec.neighborhood);
+        model.set_boundaries(spec.boundaries);
+        model.set_states(spec.states);
+        model.set_k(spec.k);
+        model.set_kprime(spec.kprime);
+        model.set_statistics(true);
+
+        int run;
+        while (take_run(queues, thread, run))
+        {
+            run_replicate(model, run);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int thread = 1; thread < threads; ++thread)
+    {
+        workers.emplace_back(work, thread);
+    }
+    work(0);
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    summarise();
+    return true;
+}
+
+// Helper function that aggregates the statistics over the seeds of every configuration
+// The replicates are summed in order, so the summaries do not depend on the threads.
+template <typename CellT>
+void BasicEnsembleRunner<CellT>::summarise()
+{
+    summaries.clear();
+    const size_t replicates = spec.seeds.size();
+    for (size_t first = 0; first < runs.size(); first += replicates)
+    {
+        EnsembleSummary summary;
+        summary.run = runs[first];
+        summary.replicates = static_cast<int>(replicates);
+        summary.generations = results[first].get_generations();
+
+        size_t samples = summary.generations.size();
+        summary.mean_p.assign(samples, 0.0);
+        summary.variance_p.assign(samples, 0.0);
+        summary.mean_heterozygosity.assign(samples, 0.0);
+        summary.variance_heterozygosity.assign(samples, 0.0);
+        for (size_t run = first; run < first + replicates; ++run)
+        {
+            for (size_t sample = 0; sample < samples; ++sample)
+            {
+                summary.mean_p[sample] += results[run].get_p(sample) / replicates;
+                summary.mean_heterozygosity[sample] += results[run].get_heterozygosity(sample) / replicates;
+            }
+        }
+        if (replicates > 1)
+        {
+            for (size_t run = first; run < first + replicates; ++run)
+            {
+                for (size_t sample = 0; sample < samples; ++sample)
+                {
+                    double p = results[run].get_p(sample) - summary.mean_p[sample];
+                    double h = results[run].get_heterozygosity(sample) - summary.mean_heterozygosity[sample];
+                    summary.variance_p[sample] += p * p / (replicates - 1);
+                    summary.variance_heterozygosity[sample] += h * h / (replicates - 1);
+                }
+            }
+        }
+        summaries.push_back(summary);
+    }
+}
+
+template <typename CellT>
+int BasicEnsembleRunner<CellT>::get_num_threads() const
+{
+    return num_threads;
+}
+
+template <typename CellT>
+const SweepSpec &BasicEnsembleRunner<CellT>::get_spec() const
+{
+    return spec;
+}
+
+template <typename CellT>
+size_t BasicEnsembleRunner<CellT>::get_num_runs() const
+{
+    return runs.size();
+}
+
+template <typename CellT>
+const EnsembleRun &BasicEnsembleRunner<CellT>::get_run(size_t run) const
+{
+    return runs[run];
+}
+
+template <typename CellT>
+const StatisticsSeries &BasicEnsembleRunner<CellT>::get_statistics(size_t run) const
+{
+    return results[run];
+}
+
+template <typename CellT>
+size_t BasicEnsembleRunner<CellT>::get_num_summaries() const
+{
+    return summaries.size();
+}
+
+template <typename CellT>
+const EnsembleSummary &BasicEnsembleRunner<CellT>::get_summary(size_t configuration) const
+{
+    return summaries[configuration];
+}
+
+// Explicit instantiations for the cell widths of the library
+template class BasicEnsembleRunner<int>;
+template class BasicEnsembleRunner<uint16_t>;
+template class BasicEnsembleRunner<uint8_t>;
@@ -0,0 +1,376 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the memoised (Hashlife) engine used by the cellular
+// automata library to advance the deterministic rules by many generations.
+// A node of level L is a 2^L x 2^L block of cells. Its result is the centre
+// block of level L - 1 after 2^j generations (j <= L - 2), which only depends
+// on the node itself; it is computed from the results of smaller nodes and
+// stored, so every distinct block is only ever advanced once.
+// A 1D line is stored as a square whose rows are all equal and whose rule
+// only reads the east and west neighbors, so the rows evolve identically.
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include "CA_hashlife.h"
+
+// Quadrants of a node
+static const int NW = 0, NE = 1, SW = 2, SE = 3;
+
+// Number of nodes above which the memoised results are dropped between advances
+static const size_t MAX_NODES = 1 << 22;
+
+bool HashlifeEngine::NodeKey::operator==(const NodeKey &other) const
+{
+    return child[0] == other.child[0] && child[1] == other.child[1] && child[2] == other.child[2] &&
+           child[3] == other.child[3];
+}
+
+size_t HashlifeEngine::NodeKeyHash::operator()(const NodeKey &key) const
+{
+    uint64_t hash = 0x9E3779B97F4A7C15ull;
+    for (int q = 0; q < 4; ++q)
+    {
+        hash = (hash ^ key.child[q]) * 0xBF58476D1CE4E5B9ull;
+        hash ^= hash >> 29;
+    }
+    return static_cast<size_t>(hash);
+}
+
+// Default constructor
+HashlifeEngine::HashlifeEngine()
+    : dimensions(TWO_DIMENSIONAL), neighborhood(VON_NEUMANN), rule(STRAIGHT_CONDITIONAL), k(0), kprime(0),
+      root(0), root_level(-1)
+{
+}
+
+// Function that sets the rule advanced by the engine
+// The memoised results only hold for one rule, so they are dropped when any
+// part of it changes.
+// Inputs:
+//      dimensions : The dimension type
+//      neighborhood : The neighborhood type
+//      rule : The rule type
+//      k, kprime : The states used by the rule
+void HashlifeEngine::configure(DimensionType dimensions, NeighborhoodType neighborhood, RuleType rule, int k,
+                               int kprime)
+{
+    if (root_level >= 0 && dimensions == this->dimensions && neighborhood == this->neighborhood &&
+        rule == this->rule && k == this->k && kprime == this->kprime)
+    {
+        return;
+    }
+    clear();
+    this->dimensions = dimensions;
+    this->neighborhood = neighborhood;
+    this->rule = rule;
+    this->k = k;
+    this->kprime = kprime;
+}
+
+// Function that drops every node and memoised result
+void HashlifeEngine::clear()
+{
+    nodes.clear();
+    canonical.clear();
+    leaves.clear();
+    results.clear();
+    root = 0;
+    root_level = -1;
+}
+
+// Getter method to get the number of distinct nodes stored
+size_t HashlifeEngine::get_num_nodes() const
+{
+    return nodes.size();
+}
+
+// Helper function that returns the node of a single cell
+uint32_t HashlifeEngine::leaf(int state)
+{
+    std::unordered_map<int, uint32_t>::iterator found = leaves.find(state);
+    if (found != leaves.end())
+    {
+        return found->second;
+    }
+    Node node = {{static_cast<uint32_t>(state), 0, 0, 0}, 0};
+    nodes.push_back(node);
+    uint32_t index = static_cast<uint32_t>(nodes.size() - 1);
+    leaves[state] = index;
+    return index;
+}
+
+// Helper function that returns the canonical node with the given children
+uint32_t HashlifeEngine::join(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+{
+    NodeKey key = {{nw, ne, sw, se}};
+    std::unordered_map<NodeKey, uint32_t, NodeKeyHash>::iterator found = canonical.find(key);
+    if (found != canonical.end())
+    {
+        return found->second;
+    }
+    Node node = {{nw, ne, sw, se}, nodes[nw].level + 1};
+    nodes.push_back(node);
+    uint32_t index = static_cast<uint32_t>(nodes.size() - 1);
+    canonical.emplace(key, index);
+    return index;
+}
+
+// Helper functions that return the centred block of level L - 1 of a node of
+// level L, of two nodes side by side and of two nodes on top of each other
+uint32_t HashlifeEngine::center(uint32_t node)
+{
+    return join(child(child(node, NW), SE), child(child(node, NE), SW), child(child(node, SW), NE),
+                child(child(node, SE), NW));
+}
+
+uint32_t HashlifeEngine::horizontal_center(uint32_t west, uint32_t east)
+{
+    return join(child(west, NE), child(east, NW), child(west, SE), child(east, SW));
+}
+
+uint32_t HashlifeEngine::vertical_center(uint32_t north, uint32_t south)
+{
+    return join(child(north, SW), child(north, SE), child(south, NW), child(south, NE));
+}
+
+// Helper function that applies the rule to one cell of a 4 x 4 block
+// Inputs:
+//      block : The states of the block
+//      i, j : Position of the cell (1 or 2, so every neighbor is in the block)
+// Returns:
+//      The state of the cell in the next generation
+int HashlifeEngine::apply_rule(const int block[4][4], int i, int j) const
+{
+    int state = block[i][j];
+    if (state != k)
+    {
+        return state;
+    }
+    if (rule == STRAIGHT_CONDITIONAL)
+    {
+        return kprime;
+    }
+
+    // 1D lines only have the east and west neighbors
+    int neighbors[8] = {block[i][j - 1], block[i][j + 1], block[i - 1][j], block[i + 1][j],
+                        block[i - 1][j - 1], block[i - 1][j + 1], block[i + 1][j - 1], block[i + 1][j + 1]};
+    int count = (dimensions == ONE_DIMENSIONAL) ? 2 : (neighborhood == MOORE ? 8 : 4);
+
+    if (rule == CONDITIONAL_TRANSITION)
+    {
+        for (int n = 0; n < count; ++n)
+        {
+            if (neighbors[n] == kprime)
+            {
+                return kprime;
+            }
+        }
+        return state;
+    }
+
+    // Majority Rule: thresholds of the direct kernels (1 for 1D, 2 for Von Neumann, 5 for Moore)
+    int sum = 0;
+    for (int n = 0; n < count; ++n)
+    {
+        sum += neighbors[n];
+    }
+    int threshold = (dimensions == ONE_DIMENSIONAL) ? 1 : (neighborhood == MOORE ? 5 : 2);
+    return sum >= threshold ? kprime : state;
+}
+
+// Helper function that advances the centre of a level 2 node by one generation
+uint32_t HashlifeEngine::base_step(uint32_t node)
+{
+    int block[4][4];
+    for (int q = 0; q < 4; ++q)
+    {
+        uint32_t quadrant = child(node, q);
+        for (int c = 0; c < 4; ++c)
+        {
+            block[(q / 2) * 2 + c / 2][(q % 2) * 2 + c % 2] = static_cast<int>(child(child(quadrant, c), 0));
+        }
+    }
+    return join(leaf(apply_rule(block, 1, 1)), leaf(apply_rule(block, 1, 2)), leaf(apply_rule(block, 2, 1)),
+                leaf(apply_rule(block, 2, 2)));
+}
+
+// Helper function that returns the centre of a node after 2^log2_generations generations
+// The node (level L) is split into 9 overlapping blocks of level L - 1. At full
+// speed (log2_generations = L - 2) they are advanced by half the generations,
+// combined into 4 blocks and advanced by the other half; at lower speeds the
+// first half is replaced by taking their centres.
+// Inputs:
+//      node : The node, of level L >= 2
+//      log2_generations : log2 of the number of generations (at most L - 2)
+// Returns:
+//      The node of level L - 1
+uint32_t HashlifeEngine::advance_node(uint32_t node, int log2_generations)
+{
+    int level = nodes[node].level;
+    if (level == 2)
+    {
+        return base_step(node);
+    }
+
+    uint64_t key = (static_cast<uint64_t>(node) << 6) | static_cast<uint64_t>(log2_generations);
+    std::unordered_map<uint64_t, uint32_t>::iterator found = results.find(key);
+    if (found != results.end())
+    {
+        return found->second;
+    }
+
+    uint32_t nw = child(node, NW), ne = child(node, NE), sw = child(node, SW), se = child(node, SE);
+    uint32_t blocks[9] = {nw, horizontal_center(nw, ne), ne,
+                          vertical_center(nw, sw), center(node), vertical_center(ne, se),
+                          sw, horizontal_center(sw, se), se};
+
+    bool full_speed = log2_generations == level - 2;
+    int half = full_speed ? log2_generations - 1 : log2_generations;
+    uint32_t r[9];
+    for (int b = 0; b < 9; ++b)
+    {
+        r[b] = full_speed ? advance_node(blocks[b], half) : center(blocks[b]);
+    }
+
+    uint32_t result = join(advance_node(join(r[0], r[1], r[3], r[4]), half),
+                           advance_node(join(r[1], r[2], r[4], r[5]), half),
+                           advance_node(join(r[3], r[4], r[6], r[7]), half),
+                           advance_node(join(r[4], r[5], r[7], r[8]), half));
+    results.emplace(key, result);
+    return result;
+}
+
+// Helper function that builds the node of a square block of the grid
+uint32_t HashlifeEngine::build(const std::vector<int> &cells, int side, int row, int col, int level)
+{
+    if (level == 0)
+    {
+        return leaf(cells[static_cast<size_t>(row) * side + col]);
+    }
+    int half = 1 << (level - 1);
+    return join(build(cells, side, row, col, level - 1), build(cells, side, row, col + half, level - 1),
+                build(cells, side, row + half, col, level - 1),
+                build(cells, side, row + half, col + half, level - 1));
+}
+
+// Helper function that builds the node of a segment of a line (every row equal)
+uint32_t HashlifeEngine::build_line(const std::vector<int> &line, int col, int level)
+{
+    if (level == 0)
+    {
+        return leaf(line[col]);
+    }
+    int half = 1 << (level - 1);
+    uint32_t west = build_line(line, col, level - 1);
+    uint32_t east = build_line(line, col + half, level - 1);
+    return join(west, east, west, east);
+}
+
+// Helper function that writes the cells of a node into the grid
+void HashlifeEngine::write(uint32_t node, std::vector<int> &cells, int side, int row, int col) const
+{
+    const Node &n = nodes[node];
+    if (n.level == 0)
+    {
+        cells[static_cast<size_t>(row) * side + col] = static_cast<int>(n.child[0]);
+        return;
+    }
+    int half = 1 << (n.level - 1);
+    write(n.child[NW], cells, side, row, col);
+    write(n.child[NE], cells, side, row, col + half);
+    write(n.child[SW], cells, side, row + half, col);
+    write(n.child[SE], cells, side, row + half, col + half);
+}
+
+// Helper function that writes the first row of a node into a line
+void HashlifeEngine::write_line(uint32_t node, std::vector<int> &line, int col) const
+{
+    const Node &n = nodes[node];
+    if (n.level == 0)
+    {
+        line[col] = static_cast<int>(n.child[0]);
+        return;
+    }
+    write_line(n.child[NW], line, col);
+    write_line(n.child[NE], line, col + (1 << (n.level - 1)));
+}
+
+// Function that loads the grid
+// Inputs:
+//      cells : side x side cells in row-major order (2D) or a line of side cells (1D)
+//      side : Length of a side, a power of two (at least 4)
+void HashlifeEngine::load(const std::vector<int> &cells, int side)
+{
+    int level = 0;
+    while ((1 << level) < side)
+    {
+        ++level;
+    }
+    if (side < 4 || (1 << level) != side)
+    {
+        std::cerr << "Error: the memoised engine needs a side that is a power of two (at least 4)." << std::endl;
+        return;
+    }
+    root = (dimensions == ONE_DIMENSIONAL) ? build_line(cells, 0, level) : build(cells, side, 0, 0, level);
+    root_level = level;
+}
+
+// Function that stores the grid in the layout given to load
+void HashlifeEngine::store(std::vector<int> &cells) const
+{
+    if (root_level < 0)
+    {
+        return;
+    }
+    int side = 1 << root_level;
+    if (dimensions == ONE_DIMENSIONAL)
+    {
+        cells.resize(side);
+        write_line(root, cells, 0);
+    }
+    else
+    {
+        cells.resize(static_cast<size_t>(side) * side);
+        write(root, cells, side, 0, 0);
+    }
+}
+
+// Function that advances the grid
+// The grid is one period of an infinite periodic plane. Four copies of it
+// form a node of level L + 1 whose centre is the grid shifted by half a side,
+// so advancing that node by 2^j generations (j <= L - 1) and swapping the
+// quadrants of the result back gives the grid 2^j generations later.
+// Inputs:
+//      generations : Number of generations
+void HashlifeEngine::advance(uint64_t generations)
+{
+    if (root_level < 2)
+    {
+        return;
+    }
+    while (generations > 0)
+    {
+        int log2_generations = 0;
+        while (log2_generations + 1 <= root_level - 1 && (generations >> (log2_generations + 1)) != 0)
+        {
+            ++log2_generations;
+        }
+
+        uint32_t plane = join(root, root, root, root);
+        uint32_t shifted = advance_node(plane, log2_generations);
+        root = join(child(shifted, SE), child(shifted, SW), child(shifted, NE), child(shifted, NW));
+        generations -= static_cast<uint64_t>(1) << log2_generations;
+
+        // Bounds the memory: start again from the current grid alone
+        if (nodes.size() > MAX_NODES)
+        {
+            std::vector<int> current;
+            store(current);
+            int side = 1 << root_level;
+            clear();
+            load(current, side);
+        }
+    }
+}
@@ -0,0 +1,194 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the implementation of the instrumentation of the
+// cellular automata library: the hardware counters, the trace and its CSV
+// and JSON files, and (with CA_INSTRUMENTATION) the operator new that counts
+// the allocations of the program.
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <unistd.h>
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+#include "CA_instrument.h"
+
+// Default constructor (opens the counters)
+// Counters the kernel does not allow (no PMU, perf_event_paranoid) stay at -1.
+HardwareCounters::HardwareCounters()
+{
+    for (int counter = 0; counter < NUM_HARDWARE_COUNTERS; ++counter)
+    {
+        fds[counter] = -1;
+    }
+#ifdef __linux__
+    const uint64_t configs[NUM_HARDWARE_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES,
+                                                     PERF_COUNT_HW_BRANCH_MISSES};
+    for (int counter = 0; counter < NUM_HARDWARE_COUNTERS; ++counter)
+    {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = configs[counter];
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        fds[counter] = static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+    }
+#endif
+}
+
+// Destructor (closes the counters)
+HardwareCounters::~HardwareCounters()
+{
+    for (int counter = 0; counter < NUM_HARDWARE_COUNTERS; ++counter)
+    {
+        if (fds[counter] >= 0)
+        {
+            close(fds[counter]);
+        }
+    }
+}
+
+// Function that reads the counters
+// Inputs:
+//      values : Set to the counts so far (-1 for the counters that are unavailable)
+void HardwareCounters::read(int64_t values[NUM_HARDWARE_COUNTERS]) const
+{
+    for (int counter = 0; counter < NUM_HARDWARE_COUNTERS; ++counter)
+    {
+        int64_t count = -1;
+        if (fds[counter] < 0 || ::read(fds[counter], &count, sizeof(count)) != sizeof(count))
+        {
+            count = -1;
+        }
+        values[counter] = count;
+    }
+}
+
+void InstrumentationTrace::clear()
+{
+    records.clear();
+}
+
+void InstrumentationTrace::add(const GenerationRecord &record)
+{
+    records.push_back(record);
+}
+
+size_t InstrumentationTrace::size() const
+{
+    return records.size();
+}
+
+const GenerationRecord &InstrumentationTrace::get_record(size_t index) const
+{
+    return records[index];
+}
+
+const std::vector<GenerationRecord> &InstrumentationTrace::get_records() const
+{
+    return records;
+}
+
+// Function to write the trace as CSV
+// Inputs:
+//      path : Path of the file
+// Returns:
+//      True if the file was written
+bool InstrumentationTrace::write_csv(const std::string &path) const
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Error opening " << path << " for writing." << std::endl;
+        return false;
+    }
+    file << "function,generation,generations,seconds,cells_updated,cells_changed,bytes_written,allocations,"
+            "cycles,llc_misses,branch_misses\n";
+    for (const GenerationRecord &record : records)
+    {
+        file << record.function << "," << record.generation << "," << record.generations << "," << record.seconds
+             << "," << record.cells_updated << "," << record.cells_changed << "," << record.bytes_written << ","
+             << record.allocations << "," << record.counters[COUNTER_CYCLES] << ","
+             << record.counters[COUNTER_LLC_MISSES] << "," << record.counters[COUNTER_BRANCH_MISSES] << "\n";
+    }
+    return file.good();
+}
+
+// Function to write the trace as a JSON array of records
+// Inputs:
+//      path : Path of the file
+// Returns:
+//      True if the file was written
+bool InstrumentationTrace::write_json(const std::string &path) const
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Error opening " << path << " for writing." << std::endl;
+        return false;
+    }
+    file << "[";
+    for (size_t index = 0; index < records.size(); ++index)
+    {
+        const GenerationRecord &record = records[index];
+        file << (index > 0 ? ",\n " : "\n ") << "{\"function\": \"" << record.function
+             << "\", \"generation\": " << record.generation << ", \"generations\": " << record.generations
+             << ", \"seconds\": " << record.seconds << ", \"cells_updated\": " << record.cells_updated
+             << ", \"cells_changed\": " << record.cells_changed << ", \"bytes_written\": " << record.bytes_written
+             << ", \"allocations\": " << record.allocations << ", \"cycles\": " << record.counters[COUNTER_CYCLES]
+             << ", \"llc_misses\": " << record.counters[COUNTER_LLC_MISSES]
+             << ", \"branch_misses\": " << record.counters[COUNTER_BRANCH_MISSES] << "}";
+    }
+    file << "\n]\n";
+    return file.good();
+}
+
+#ifdef CA_INSTRUMENTATION
+// Number of calls to operator new made by the program
+static std::atomic<uint64_t> allocation_count(0);
+
+uint64_t get_allocation_count()
+{
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+// Allocation functions of the program, which count the allocations
+void *operator new(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    void *memory = std::malloc(size > 0 ? size : 1);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+#else
+uint64_t get_allocation_count()
+{
+    return 0;
+}
+#endif
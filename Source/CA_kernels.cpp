@@ -0,0 +1,168 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the row kernels of the cellular automata library.
+// The kernels are written as branch-free loops over contiguous rows, so the
+// compiler turns them into SIMD code. Every kernel is compiled for the
+// portable baseline and, on x86, for AVX2 and AVX-512; the widest version
+// supported by the CPU is selected at runtime. All versions give the same
+// results as they share the same loop body.
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "CA_kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CA_X86_DISPATCH 1
+#define CA_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define CA_ALWAYS_INLINE inline
+#endif
+
+// Type used to sum neighbor states: 16 bits are enough for eight uint8_t
+// cells, which doubles the number of lanes per vector compared with int.
+template <typename CellT>
+using SumType = typename std::conditional<sizeof(CellT) == 1, uint16_t, int>::type;
+
+// Conditional Transition on one row: a cell in state k becomes k' if any
+// neighbor is in state k'
+template <typename CellT, NeighborhoodType N>
+CA_ALWAYS_INLINE void conditional_row_body(const CellT *__restrict row, ptrdiff_t stride,
+                                           CellT *__restrict next_row, int cols, CellT k, CellT kprime)
+{
+    const CellT *__restrict north = row - stride;
+    const CellT *__restrict south = row + stride;
+
+    for (int j = 0; j < cols; ++j)
+    {
+        bool condition_met = (north[j] == kprime) | (south[j] == kprime) |
+                             (row[j + 1] == kprime) | (row[j - 1] == kprime);
+        if (N == MOORE)
+        {
+            condition_met = condition_met | (north[j + 1] == kprime) | (north[j - 1] == kprime) |
+                            (south[j + 1] == kprime) | (south[j - 1] == kprime);
+        }
+        next_row[j] = ((row[j] == k) & condition_met) ? kprime : row[j];
+    }
+}
+
+// Majority Rule on one row: a cell in state k becomes k' if the sum of its
+// neighbors reaches the threshold (2 for Von Neumann, 5 for Moore)
+template <typename CellT, NeighborhoodType N>
+CA_ALWAYS_INLINE void majority_row_body(const CellT *__restrict row, ptrdiff_t stride,
+                                        CellT *__restrict next_row, int cols, CellT k, CellT kprime)
+{
+    typedef SumType<CellT> Sum;
+    const CellT *__restrict north = row - stride;
+    const CellT *__restrict south = row + stride;
+    const Sum threshold = (N == VON_NEUMANN) ? 2 : 5;
+
+    for (int j = 0; j < cols; ++j)
+    {
+        Sum neighbors_sum = static_cast<Sum>(Sum(north[j]) + Sum(south[j]) + Sum(row[j + 1]) + Sum(row[j - 1]));
+        if (N == MOORE)
+        {
+            neighbors_sum = static_cast<Sum>(neighbors_sum + Sum(north[j + 1]) + Sum(north[j - 1]) +
+                                             Sum(south[j + 1]) + Sum(south[j - 1]));
+        }
+        next_row[j] = ((row[j] == k) & (neighbors_sum >= threshold)) ? kprime : row[j];
+    }
+}
+
+// Conditional Transition on the 1D line (left/right neighbors)
+template <typename CellT>
+CA_ALWAYS_INLINE void conditional_line_body(const CellT *__restrict line, CellT *__restrict next_line,
+                                            int cols, CellT k, CellT kprime)
+{
+    for (int j = 0; j < cols; ++j)
+    {
+        bool condition_met = (line[j - 1] == kprime) | (line[j + 1] == kprime);
+        next_line[j] = ((line[j] == k) & condition_met) ? kprime : line[j];
+    }
+}
+
+// Majority Rule on the 1D line: a cell in state k becomes k' if the sum of
+// its two neighbors is at least 1
+template <typename CellT>
+CA_ALWAYS_INLINE void majority_line_body(const CellT *__restrict line, CellT *__restrict next_line,
+                                         int cols, CellT k, CellT kprime)
+{
+    typedef SumType<CellT> Sum;
+    for (int j = 0; j < cols; ++j)
+    {
+        Sum neighbors_sum = static_cast<Sum>(Sum(line[j - 1]) + Sum(line[j + 1]));
+        next_line[j] = ((line[j] == k) & (neighbors_sum >= 1)) ? kprime : line[j];
+    }
+}
+
+// Defines the kernels of one instruction set. ATTR is the function attribute
+// selecting the target, and SUFFIX names the kernel family.
+#define CA_DEFINE_KERNELS(SUFFIX, ATTR)                                                               \
+    template <typename CellT, NeighborhoodType N>                                                     \
+    ATTR void conditional_row_##SUFFIX(const CellT *row, ptrdiff_t stride, CellT *next_row, int cols, \
+                                       CellT k, CellT kprime)                                         \
+    {                                                                                                 \
+        conditional_row_body<CellT, N>(row, stride, next_row, cols, k, kprime);                       \
+    }                                                                                                 \
+    template <typename CellT, NeighborhoodType N>                                                     \
+    ATTR void majority_row_##SUFFIX(const CellT *row, ptrdiff_t stride, CellT *next_row, int cols,    \
+                                    CellT k, CellT kprime)                                            \
+    {                                                                                                 \
+        majority_row_body<CellT, N>(row, stride, next_row, cols, k, kprime);                          \
+    }                                                                                                 \
+    template <typename CellT>                                                                         \
+    ATTR void conditional_line_##SUFFIX(const CellT *line, CellT *next_line, int cols, CellT k,       \
+                                        CellT kprime)                                                 \
+    {                                                                                                 \
+        conditional_line_body<CellT>(line, next_line, cols, k, kprime);                               \
+    }                                                                                                 \
+    template <typename CellT>                                                                         \
+    ATTR void majority_line_##SUFFIX(const CellT *line, CellT *next_line, int cols, CellT k,          \
+                                     CellT kprime)                                                    \
+    {                                                                                                 \
+        majority_line_body<CellT>(line, next_line, cols, k, kprime);                                  \
+    }                                                                                                 \
+    template <typename CellT>                                                                         \
+    RowKernels<CellT> make_kernels_##SUFFIX(const char *isa)                                          \
+    {                                                                                                 \
+        RowKernels<CellT> kernels = {isa,                                                             \
+                                     {conditional_row_##SUFFIX<CellT, VON_NEUMANN>,                   \
+                                      conditional_row_##SUFFIX<CellT, MOORE>},                        \
+                                     {majority_row_##SUFFIX<CellT, VON_NEUMANN>,                      \
+                                      majority_row_##SUFFIX<CellT, MOORE>},                           \
+                                     conditional_line_##SUFFIX<CellT>,                                \
+                                     majority_line_##SUFFIX<CellT>};                                  \
+        return kernels;                                                                               \
+    }
+
+CA_DEFINE_KERNELS(baseline, )
+
+#ifdef CA_X86_DISPATCH
+CA_DEFINE_KERNELS(avx2, __attribute__((target("avx2"))))
+CA_DEFINE_KERNELS(avx512, __attribute__((target("avx512f,avx512bw,prefer-vector-width=512"))))
+#endif
+
+// Function that returns the kernels for the cell type
+// Inputs:
+//      vectorize : If true, the widest instruction set supported by the CPU
+//                  is selected (once, on first use); otherwise the portable kernels
+template <typename CellT>
+const RowKernels<CellT> &select_row_kernels(bool vectorize)
+{
+    static const RowKernels<CellT> baseline = make_kernels_baseline<CellT>("baseline");
+#ifdef CA_X86_DISPATCH
+    static const RowKernels<CellT> best =
+        __builtin_cpu_supports("avx512bw") ? make_kernels_avx512<CellT>("avx512")
+        : __builtin_cpu_supports("avx2")   ? make_kernels_avx2<CellT>("avx2")
+                                           : baseline;
+#else
+    static const RowKernels<CellT> &best = baseline;
+#endif
+    return vectorize ? best : baseline;
+}
+
+// The library is compiled for these cell widths
+template const RowKernels<int> &select_row_kernels<int>(bool);
+template const RowKernels<uint16_t> &select_row_kernels<uint16_t>(bool);
+template const RowKernels<uint8_t> &select_row_kernels<uint8_t>(bool);
@@ -11,85 +11,275 @@
 #include <random>
 #include <functional>
 #include <cstdlib>
-#include <ctime>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <chrono>
+#include <mutex>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "CA_library.h"
+#include "CA_kernels.h"
+#include "CA_threadpool.h"
+#include "CA_window.h"
+#include "CA_hashlife.h"
+#include "CA_bitslice.h"
+
+// Smallest number of cells worth handing to a thread as one band
+static const long long MIN_BAND_CELLS = 4096;
+
+// Seed used until set_seed is called
+static const uint64_t DEFAULT_SEED = 5489;
+
+// Size of the buffers a tile is advanced in by the temporal blocking (both
+// generations of the tile fit in the L2 cache), and of a row of a tile
+static const size_t TIME_BLOCK_BYTES = 512 * 1024;
+static const size_t TIME_BLOCK_ROW_BYTES = 4096;
+
+// Number of generations advanced per pass of the grid by default
+static const int DEFAULT_TIME_BLOCK = 8;
+
+// Size of the tiles used to track the active regions of the grid
+static const int ACTIVE_TILE_ROWS = 16;
+static const int ACTIVE_TILE_COLS = 256;
+static const int ACTIVE_TILE_LINE = 4096;
+
+// Checkpoint files: header | genotype table | padded grid (page aligned) | statistics
+// Integers are stored in the byte order of the host; the grid is the padded
+// storage of the model as is, so it is restored with a single copy from the
+// mapped file.
+static const char CHECKPOINT_MAGIC[8] = {'C', 'A', 'C', 'H', 'K', 'P', 'T', '1'};
+static const uint32_t CHECKPOINT_VERSION = 1;
+static const size_t CHECKPOINT_HEADER_BYTES = 256;
+static const size_t CHECKPOINT_GRID_ALIGNMENT = 4096;
+static const uint32_t CHECKPOINT_VECTORIZE = 1;
+static const uint32_t CHECKPOINT_STATISTICS = 2;
+static const uint32_t CHECKPOINT_ACTIVE_REGIONS = 4;
+
+// Header at the start of a checkpoint file
+struct CheckpointHeader
+{
+    char magic[8];                // CHECKPOINT_MAGIC
+    uint32_t version;             // CHECKPOINT_VERSION
+    uint32_t cell_bytes;          // size of one cell
+    int32_t rows;                 // number of rows in the grid
+    int32_t cols;                 // number of columns in the grid
+    int32_t neighborhood_radius;  // radius of neighborhood
+    int32_t states;               // number of states of the model
+    int32_t k;                    // state k of the rules
+    int32_t kprime;               // state k' of the rules
+    int32_t halo;                 // width of the ghost-cell halo of the stored grid
+    int32_t table_size;           // number of states covered by the genotype table
+    int32_t dimensions;
+    int32_t neighborhood;
+    int32_t boundaries;
+    int32_t rule;
+    int32_t engine;
+    int32_t time_block;           // generations advanced per pass of the grid
+    uint32_t flags;               // CHECKPOINT_VECTORIZE | CHECKPOINT_STATISTICS | CHECKPOINT_ACTIVE_REGIONS
+    uint32_t statistics_states;   // number of states counted by the statistics
+    uint64_t seed;                // seed of the random number generator
+    uint64_t generation;          // number of generations computed
+    uint64_t user_draws;          // draws made by direct determine_genotype calls
+    uint64_t statistics_samples;  // number of statistics samples
+    uint64_t table_offset;        // position of the genotype table
+    uint64_t grid_offset;         // position of the padded grid
+    uint64_t statistics_offset;   // position of the statistics (generations, then the counts of every state)
+    uint64_t file_size;           // size of the file
+};
+static_assert(sizeof(CheckpointHeader) <= CHECKPOINT_HEADER_BYTES, "checkpoint header too large");
+
+// State of the probes of a model
+template <typename CellT>
+struct BasicCellularAutomata<CellT>::ProbeState
+{
+    HardwareCounters counters;                    // hardware counters of the thread that opened them
+    int depth = 0;                                // probed calls in progress (only the outermost is recorded)
+    const char *function = nullptr;               // outermost probed function
+    std::chrono::steady_clock::time_point start;  // start of the generations not yet recorded
+    int64_t start_counters[NUM_HARDWARE_COUNTERS]; // counters at that start
+    uint64_t start_allocations = 0;               // allocations at that start
+    uint64_t start_generation = 0;                // generation at that start
+    std::vector<CellT> previous;                  // grid at that start
+};
+
+// Probe of a public compute function, from its start to its return
+template <typename CellT>
+struct BasicCellularAutomata<CellT>::ProbeScope
+{
+    BasicCellularAutomata *model;
+
+    ProbeScope(BasicCellularAutomata *model, const char *function) : model(model) { model->begin_probe(function); }
+    ~ProbeScope() { model->end_probe(); }
+};
+
+// Without CA_INSTRUMENTATION the probes are not compiled
+// CA_PROBE_GENERATIONS records the generations computed so far by a
+// multi-generation function (cells_changed : changed cells of every one of
+// them, or nullptr to compare the grid with the one at the last record).
+#ifdef CA_INSTRUMENTATION
+#define CA_PROBE(function) ProbeScope probe_scope(this, function)
+#define CA_PROBE_GENERATIONS(cells_changed)                                                                        \
+    do                                                                                                             \
+    {                                                                                                              \
+        if (probing_generations())                                                                                 \
+            record_probe(cells_changed);                                                                           \
+    } while (0)
+#else
+#define CA_PROBE(function)
+#define CA_PROBE_GENERATIONS(cells_changed)
+#endif
 
 // Default constructor
-CellularAutomata::CellularAutomata() {}
+template <typename CellT>
+BasicCellularAutomata<CellT>::BasicCellularAutomata()
+    : dimensions(TWO_DIMENSIONAL), neighborhood(VON_NEUMANN), boundaries(PERIODIC),
+      rule(STRAIGHT_CONDITIONAL), rows(0), cols(0), neighborhood_radius(1), states(2),
+      k(0), kprime(0), halo(1), stride(2), halo_valid(false), vectorize(true),
+      num_threads(1), rng(DEFAULT_SEED), generation(0), user_draws(0), table_size(0), step_function(nullptr),
+      collect_statistics(false), active_regions(true), tiles_valid(false), tile_counts_valid(false),
+      tile_height(1), tile_width(1), tiles_down(0), tiles_across(0), tracked_step(nullptr), tracked_k(0),
+      tracked_kprime(0), engine(DIRECT_ENGINE), time_block(DEFAULT_TIME_BLOCK), instrumented(false)
+{
+    build_genotype_table();
+    configure_step();
+}
 
 // Default constructor
-CellularAutomata::~CellularAutomata() {}
+template <typename CellT>
+BasicCellularAutomata<CellT>::~BasicCellularAutomata() {}
 
 // Setter method to set dimension type of CA
 // Inputs:
 //      dimensions : The dimension type (ONE_DIMENSIONAL or TWO_DIMENSIONAL)
-void CellularAutomata::set_dimensions(DimensionType dimensions)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_dimensions(DimensionType dimensions)
 {
     this->dimensions = dimensions;
+    configure_step();
 }
 
 // Setter method to set neighborhood type of CA
 // Inputs:
 //      neighborhood : The neighborhood type (VON_NEUMANN or MOORE)
-void CellularAutomata::set_neighborhood(NeighborhoodType neighborhood)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_neighborhood(NeighborhoodType neighborhood)
 {
     this->neighborhood = neighborhood;
+    configure_step();
 }
 
 // Setter method to set boundary type of CA
 // Inputs:
 //      boundaries : The boundary type (PERIODIC, FIXED, or NO_BOUNDARIES)
-void CellularAutomata::set_boundaries(BoundaryType boundaries)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_boundaries(BoundaryType boundaries)
 {
     this->boundaries = boundaries;
+    halo_valid = false;
+    configure_step();
 }
 
 // Setter method to set rule type of CA
 // Inputs:
 //      rule : The dimension type (STRAIGHT_CONDITIONAL, CONDITIONAL_TRANSITION, or MAJORITY_RULE)
-void CellularAutomata::set_rule(RuleType rule)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_rule(RuleType rule)
 {
     this->rule = rule;
+    configure_step();
 }
 
 // Setter method to set size of the grid
 // Inputs:
 //      rows : The number of rows in the grid
 //      cols : The number of columns in the grid
-void CellularAutomata::set_grid_size(int rows, int cols)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_grid_size(int rows, int cols)
 {
     this->rows = rows;
     this->cols = cols;
 }
 
 // Setter method to set neighborhood radius type of CA
+// Rules read the neighbors within the radius through the halo, which is widened
+// to the radius if needed.
 // Inputs:
-//      neighborhood_radius : The radius of the neighborhood
-void CellularAutomata::set_neighborhood_radius(int neighborhood_radius)
+//      neighborhood_radius : The radius of the neighborhood (values below 1 are clamped to 1)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_neighborhood_radius(int neighborhood_radius)
 {
-    this->neighborhood_radius = neighborhood_radius;
+    this->neighborhood_radius = std::max(neighborhood_radius, 1);
+    if (this->neighborhood_radius > halo)
+    {
+        set_halo_width(this->neighborhood_radius);
+    }
+    configure_step();
 }
 
 // Setter method to set number of states for each cell in the CA
 // Inputs:
 //      states : The number of states
-void CellularAutomata::set_states(int states)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_states(int states)
 {
     this->states = states;
+    build_genotype_table();
 }
 
 // Setter method to set the initial state of CA
+// The grid size is taken from the given configuration.
 // Inputs:
 //      grid : The initial configuration of the CA grid
-void CellularAutomata::set_grid(const std::vector<std::vector<int>> &grid)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_grid(const std::vector<std::vector<int>> &grid)
+{
+    rows = static_cast<int>(grid.size());
+    cols = rows > 0 ? static_cast<int>(grid[0].size()) : 0;
+    allocate_grid();
+
+    for (int i = 0; i < rows; ++i)
+    {
+        std::copy(grid[i].begin(), grid[i].begin() + std::min<int>(cols, grid[i].size()),
+                  cells.begin() + cell_index(i, 0));
+    }
+}
+
+// Setter method to set the width of the ghost-cell halo around the grid
+// Existing cell states are kept when the halo is resized. The halo is never
+// narrower than the neighborhood radius, since the rules read the neighbors
+// through it.
+// Inputs:
+//      halo_width : Number of ghost cells on each side of the grid (at least
+//                   the neighborhood radius, and at least 1)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_halo_width(int halo_width)
 {
-    this->grid = grid;
+    halo_width = std::max(halo_width, std::max(neighborhood_radius, 1));
+    if (halo_width == halo)
+    {
+        return;
+    }
+    if (cells.empty())
+    {
+        halo = halo_width;
+        stride = cols + 2 * halo;
+        return;
+    }
+
+    std::vector<std::vector<int>> current = get_grid();
+    halo = halo_width;
+    set_grid(current);
 }
 
 // Getter method to get dimension type of CA
 // Returns:
 //  dimensions : The dimension type (ONE_DIMENSIONAL or TWO_DIMENSIONAL)
-DimensionType CellularAutomata::get_dimensions() const
+template <typename CellT>
+DimensionType BasicCellularAutomata<CellT>::get_dimensions() const
 {
     return dimensions;
 }
@@ -97,7 +287,8 @@ DimensionType CellularAutomata::get_dimensions() const
 // Getter method to get neighborhood type of CA
 // Returns:
 //      neighborhood : The neighborhood type (VON_NEUMANN or MOORE)
-NeighborhoodType CellularAutomata::get_neighborhood() const
+template <typename CellT>
+NeighborhoodType BasicCellularAutomata<CellT>::get_neighborhood() const
 {
     return neighborhood;
 }
@@ -105,7 +296,8 @@ NeighborhoodType CellularAutomata::get_neighborhood() const
 // Getter method to get boundary type of CA
 // Returns:
 //      boundaries : The boundary type (PERIODIC, FIXED, or NO_BOUNDARIES)
-BoundaryType CellularAutomata::get_boundaries() const
+template <typename CellT>
+BoundaryType BasicCellularAutomata<CellT>::get_boundaries() const
 {
     return boundaries;
 }
@@ -113,7 +305,8 @@ BoundaryType CellularAutomata::get_boundaries() const
 // Getter method to get rule type of CA
 // Returns:
 //      rule : The dimension type (STRAIGHT_CONDITIONAL, CONDITIONAL_TRANSITION, or MAJORITY_RULE)
-RuleType CellularAutomata::get_rule() const
+template <typename CellT>
+RuleType BasicCellularAutomata<CellT>::get_rule() const
 {
     return rule;
 }
@@ -121,7 +314,8 @@ RuleType CellularAutomata::get_rule() const
 // Getter method to get number of rows in the grid
 // Returns:
 //      rows : The number of rows in the grid
-int CellularAutomata::get_grid_rows() const
+template <typename CellT>
+int BasicCellularAutomata<CellT>::get_grid_rows() const
 {
     return rows;
 }
@@ -129,7 +323,8 @@ int CellularAutomata::get_grid_rows() const
 // Getter method to get number of columns in the grid
 // Returns:
 //      cols : The number of columns in the grid
-int CellularAutomata::get_grid_cols() const
+template <typename CellT>
+int BasicCellularAutomata<CellT>::get_grid_cols() const
 {
     return cols;
 }
@@ -137,7 +332,8 @@ int CellularAutomata::get_grid_cols() const
 // Getter method to get neighborhood radius type of CA
 // Returns:
 //      neighborhood_radius : The radius of the neighborhood
-int CellularAutomata::get_neighborhood_radius() const
+template <typename CellT>
+int BasicCellularAutomata<CellT>::get_neighborhood_radius() const
 {
     return neighborhood_radius;
 }
@@ -145,554 +341,2652 @@ int CellularAutomata::get_neighborhood_radius() const
 // Getter method to get number of states for each cell in the CA
 // Returns:
 //      states : The number of states
-int CellularAutomata::get_states() const
+template <typename CellT>
+int BasicCellularAutomata<CellT>::get_states() const
 {
     return states;
 }
 
 // Getter method to get the initial state of CA
+// The grid is stored as one contiguous, padded buffer, so this returns a
+// compatibility view that is rebuilt from the cells on every call.
 // Returns:
 //      grid : The initial configuration of the CA grid
-const std::vector<std::vector<int>> &CellularAutomata::get_grid() const
+template <typename CellT>
+const std::vector<std::vector<int>> &BasicCellularAutomata<CellT>::get_grid() const
 {
-    return grid;
+    if (cells.empty())
+    {
+        grid_view.clear();
+        return grid_view;
+    }
+
+    grid_view.resize(rows);
+    for (int i = 0; i < rows; ++i)
+    {
+        const CellT *row = &cells[cell_index(i, 0)];
+        grid_view[i].assign(row, row + cols);
+    }
+    return grid_view;
 }
 
-// Setup function to initialize the grid based on the specified dimension
-// Note: Kassady made the final changes to this function but had trouble pushing to the repo
-void CellularAutomata::setup_dimensions()
+// Setter method to choose between the SIMD kernels and the portable kernels
+// Both give identical results; the portable kernels are useful for testing.
+// Inputs:
+//      enabled : If true, the widest instruction set supported by the CPU is used
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_vectorization(bool enabled)
 {
-    // Seed the random number generator with the current time
-    std::srand(static_cast<unsigned>(std::time(nullptr)));
-
-    if (dimensions == ONE_DIMENSIONAL)
-    {
-        // 1D logic setup
-        grid = std::vector<std::vector<int>>(rows, std::vector<int>(cols, 0));
+    vectorize = enabled;
+}
 
-        // Initialize 1D grid with random states
-        for (int j = 0; j < cols; ++j)
-        {
-            int random_state = rand() % states + 1;
-            grid[0][j] = random_state;
-        }
-    }
-    else if (dimensions == TWO_DIMENSIONAL)
-    {
-        // 2D logic setup
-        grid = std::vector<std::vector<int>>(rows, std::vector<int>(cols, 0));
+// Getter method to check whether the SIMD kernels are used
+// Returns:
+//      vectorize : True if the SIMD kernels are used
+template <typename CellT>
+bool BasicCellularAutomata<CellT>::get_vectorization() const
+{
+    return vectorize;
+}
 
-        // Initialize 2D grid with random states
-        for (int i = 0; i < rows; ++i)
-        {
-            for (int j = 0; j < cols; ++j)
-            {
-                int random_state = rand() % states + 1;
-                grid[i][j] = random_state;
-            }
-        }
-    }
+// Getter method to get the instruction set of the kernels used by the compute functions
+// Returns:
+//      Name of the instruction set ("avx512", "avx2" or "baseline")
+template <typename CellT>
+const char *BasicCellularAutomata<CellT>::get_kernel_isa() const
+{
+    return select_row_kernels<CellT>(vectorize).isa;
 }
 
-// Setup function to configure the grid based on the specified boundary type
-void CellularAutomata::setup_boundaries()
+// Setter method to set the number of threads used by the compute functions
+// The grid is split into contiguous row bands (column bands for 1D), and each
+// band is computed by one thread of a persistent pool. Results are identical
+// for any number of threads.
+// Inputs:
+//      num_threads : Number of threads (0 uses every hardware thread, 1 runs serially)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_num_threads(int num_threads)
 {
-    if (boundaries == PERIODIC)
-    {
-        // Periodic boundary logic setup
-        for (int i = 0; i < rows; ++i)
-        {
-            for (int j = 0; j < cols; ++j)
-            {
-                grid[i][j] = grid[(i + rows) % rows][(j + cols) % cols];
-            }
-        }
-    }
-    else if (boundaries == FIXED)
+    if (num_threads <= 0)
     {
-        // Fixed boundary logic setup
-        int fixed_state = 1; // Replace with the desired fixed state
-        for (int j = 0; j < cols; ++j)
-        {
-            grid[0][j] = grid[rows - 1][j] = fixed_state;
-        }
-        for (int i = 0; i < rows; ++i)
-        {
-            grid[i][0] = grid[i][cols - 1] = fixed_state;
-        }
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
     }
-    else if (boundaries == NO_BOUNDARIES)
+    this->num_threads = num_threads;
+    pool.reset();
+    if (num_threads > 1)
     {
-        // No boundaries logic setup
-        // No specific setup needed for no boundaries
+        pool = std::make_shared<ThreadPool>(num_threads);
     }
 }
 
-// Setup function to establish the neighborhood relationships for each cell.
-void CellularAutomata::setup_neighborhood()
+// Getter method to get the number of threads used by the compute functions
+// Returns:
+//      num_threads : Number of threads
+template <typename CellT>
+int BasicCellularAutomata<CellT>::get_num_threads() const
 {
-    for (int i = 0; i < rows; ++i)
+    return num_threads;
+}
+
+// Setter method to set the seed of the model's random number generator
+// Every random draw is a function of (seed, generation, cell), so a run with
+// the same seed and configuration replays exactly, for any number of threads.
+// Inputs:
+//      seed : The seed
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_seed(uint64_t seed)
+{
+    rng.set_seed(seed);
+    user_draws = 0;
+}
+
+// Getter method to get the seed of the model's random number generator
+// Returns:
+//      seed : The seed
+template <typename CellT>
+uint64_t BasicCellularAutomata<CellT>::get_seed() const
+{
+    return rng.get_seed();
+}
+
+// Setter method to set the outcomes of a cross in the genotype transition table
+// Both parent orders are set. The table is rebuilt with the Mendelian crosses
+// when the number of states changes, so custom crosses are set after set_states.
+// Inputs:
+//      cell_state1, cell_state2 : Genotypes of the parents
+//      offspring : GENOTYPE_BUCKETS equally likely offspring genotypes
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_cross(int cell_state1, int cell_state2, const std::vector<int> &offspring)
+{
+    if (cell_state1 < 0 || cell_state1 >= table_size || cell_state2 < 0 || cell_state2 >= table_size ||
+        static_cast<int>(offspring.size()) != GENOTYPE_BUCKETS ||
+        *std::min_element(offspring.begin(), offspring.end()) < 0 ||
+        *std::max_element(offspring.begin(), offspring.end()) >= table_size)
     {
-        for (int j = 0; j < cols; ++j)
-        {
-            int neighbor_north, neighbor_south, neighbor_east, neighbor_west,
-                neighbor_north_east, neighbor_south_east, neighbor_south_west, neighbor_north_west;
+        std::cerr << "Error: Invalid cross for the genotype transition table." << std::endl;
+        return;
+    }
 
-            if (neighborhood == VON_NEUMANN)
-            {
-                // Von Neumann logic setup
-                neighbor_north = grid[(i - 1 + rows) % rows][j];
-                neighbor_south = grid[(i + 1) % rows][j];
-                neighbor_east = grid[i][(j + 1) % cols];
-                neighbor_west = grid[i][(j - 1 + cols) % cols];
-            }
-            else if (neighborhood == MOORE)
-            {
-                // Moore logic setup
-                // Same 4 neighbors as Von Neumann
-                neighbor_north = grid[(i - 1 + rows) % rows][j];
-                neighbor_south = grid[(i + 1) % rows][j];
-                neighbor_east = grid[i][(j + 1) % cols];
-                neighbor_west = grid[i][(j - 1 + cols) % cols];
-                // 4 additional diagonal neighbors
-                neighbor_north_east = grid[(i - 1 + rows) % rows][(j + 1) % cols];
-                neighbor_south_east = grid[(i + 1) % rows][(j + 1) % cols];
-                neighbor_south_west = grid[(i + 1) % rows][(j - 1 + cols) % cols];
-                neighbor_north_west = grid[(i - 1 + rows) % rows][(j - 1 + cols) % cols];
-            }
-        }
+    for (int bucket = 0; bucket < GENOTYPE_BUCKETS; ++bucket)
+    {
+        genotype_table[(cell_state1 * table_size + cell_state2) * GENOTYPE_BUCKETS + bucket] = offspring[bucket];
+        genotype_table[(cell_state2 * table_size + cell_state1) * GENOTYPE_BUCKETS + bucket] = offspring[bucket];
     }
 }
 
-// Setup function to apply the specified rule to update the grid's state
-void CellularAutomata::setup_rule()
+// Getter method to get the outcomes of a cross in the genotype transition table
+// Inputs:
+//      cell_state1, cell_state2 : Genotypes of the parents
+// Returns:
+//      The GENOTYPE_BUCKETS equally likely offspring genotypes
+template <typename CellT>
+std::vector<int> BasicCellularAutomata<CellT>::get_cross(int cell_state1, int cell_state2) const
 {
-    for (int i = 0; i < rows; ++i)
+    int index = (table_state(cell_state1) * table_size + table_state(cell_state2)) * GENOTYPE_BUCKETS;
+    return std::vector<int>(genotype_table.begin() + index, genotype_table.begin() + index + GENOTYPE_BUCKETS);
+}
+
+// Helper function that builds the genotype transition tables for the number of states
+// A cross picks one of GENOTYPE_BUCKETS equally likely outcomes, so the
+// Mendelian crosses of one locus with two alleles are exact:
+//      HomozygousDominant x HomozygousDominant -> HomozygousDominant
+//      Recessive x Recessive -> Recessive
+//      HomozygousDominant x Recessive -> Heterozygous
+//      HomozygousDominant x Heterozygous -> 50% HomozygousDominant, 50% Heterozygous
+//      Heterozygous x Recessive -> 50% Heterozygous, 50% Recessive
+//      Heterozygous x Heterozygous -> 50% Heterozygous, 25% HomozygousDominant, 25% Recessive
+// Any other pair of states gives the state of the first parent.
+template <typename CellT>
+void BasicCellularAutomata<CellT>::build_genotype_table()
+{
+    const int dominant = static_cast<int>(Allele_Genotype::HomozygousDominant);
+    const int heterozygous = static_cast<int>(Allele_Genotype::Heterzygous);
+    const int recessive = static_cast<int>(Allele_Genotype::Recessive);
+
+    table_size = std::max(states, recessive) + 1;
+    genotype_table.assign(static_cast<size_t>(table_size) * table_size * GENOTYPE_BUCKETS, 0);
+    average_table.assign(static_cast<size_t>(table_size) * table_size, 0);
+
+    for (int state1 = 0; state1 < table_size; ++state1)
     {
-        for (int j = 0; j < cols; ++j)
+        for (int state2 = 0; state2 < table_size; ++state2)
         {
-            int neighbor_north, neighbor_south, neighbor_east, neighbor_west;
-
-            if (rule == STRAIGHT_CONDITIONAL)
-            {
-                // Straight conditional transition logic setup
-                int state_condition = k; // Replace with the desired state condition
-                int new_state = kprime;  // Replace with the desired new state
-                if (grid[i][j] == state_condition)
-                    grid[i][j] = new_state;
-            }
-            else if (rule == CONDITIONAL_TRANSITION)
-            {
-                // Conditional transition rule on a neighbor logic setup
-                int state_condition = k;         // Replace with the desired state condition
-                int neighbor_condition = kprime; // Replace with the desired neighbor condition
-                if (grid[i][j] == state_condition && neighbor_south == neighbor_condition)
-                    grid[i][j] = neighbor_south;
-            }
-            else if (rule == MAJORITY_RULE)
+            std::vector<int> offspring(GENOTYPE_BUCKETS, state1);
+            int low = std::min(state1, state2);
+            int high = std::max(state1, state2);
+
+            if (low == high && (low == dominant || low == recessive))
+                offspring.assign(GENOTYPE_BUCKETS, low);
+            else if (low == dominant && high == recessive)
+                offspring.assign(GENOTYPE_BUCKETS, heterozygous);
+            else if (low == dominant && high == heterozygous)
+                offspring = {dominant, dominant, heterozygous, heterozygous};
+            else if (low == heterozygous && high == recessive)
+                offspring = {heterozygous, heterozygous, recessive, recessive};
+            else if (low == heterozygous && high == heterozygous)
+                offspring = {heterozygous, heterozygous, dominant, recessive};
+
+            for (int bucket = 0; bucket < GENOTYPE_BUCKETS; ++bucket)
             {
-                // Majority rule logic setup
-                int sum_neighbors = neighbor_north + neighbor_south + neighbor_east + neighbor_west;
-                int majority_state = (sum_neighbors >= 2) ? 1 : 0;
-                grid[i][j] = majority_state;
+                genotype_table[(state1 * table_size + state2) * GENOTYPE_BUCKETS + bucket] = offspring[bucket];
             }
+
+            // Offspring of the two neighbor pairs are averaged and rounded half up
+            average_table[state1 * table_size + state2] = static_cast<CellT>((state1 + state2 + 1) / 2);
         }
     }
 }
 
-// Setup functions to set and get state "k" to be used on compute step
-void CellularAutomata::set_k(int k_state)
+// Getter method to get the number of generations computed so far
+// Returns:
+//      generation : Number of calls to the compute and update functions
+template <typename CellT>
+uint64_t BasicCellularAutomata<CellT>::get_generation() const
 {
-    k = k_state;
+    return generation;
 }
 
-int CellularAutomata::get_k() const
+// Setter method to collect the statistics of every generation
+// When enabled, the compute functions and update() count the cells in every
+// state as they write them and add a sample to the statistics series.
+// Inputs:
+//      enabled : If true, a sample is added for every generation computed
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_statistics(bool enabled)
 {
-    return k;
+    collect_statistics = enabled;
 }
 
-// Setup functions to set and get state "k'" to be used on compute step
-void CellularAutomata::set_kprime(int kprime_state)
+// Getter method to check whether statistics are collected
+template <typename CellT>
+bool BasicCellularAutomata<CellT>::get_statistics_enabled() const
 {
-    kprime = kprime_state;
+    return collect_statistics;
 }
 
-int CellularAutomata::get_kprime() const
+// Getter method to get the statistics collected so far
+// Returns:
+//      statistics : One sample per recorded generation
+template <typename CellT>
+const StatisticsSeries &BasicCellularAutomata<CellT>::get_statistics() const
 {
-    return kprime;
+    return statistics;
 }
 
-// Function to be able to add rules in vector for models that utilize multiple rules
-void CellularAutomata::add_rule(const RuleFunction &new_rule)
+// Function to remove the statistics collected so far
+template <typename CellT>
+void BasicCellularAutomata<CellT>::clear_statistics()
 {
-    rules.push_back(new_rule);
+    statistics.clear();
 }
 
-// Compute function for 1-Dimension/Rule 1
-// Updates grid based on Straight Conditional
-void CellularAutomata::onedim_rule1(int k, int kprime)
+// Function that adds a sample for the current grid (for example the initial
+// population, before any generation is computed)
+// This is a separate pass over the grid; computed generations are counted
+// by the compute functions themselves.
+template <typename CellT>
+void BasicCellularAutomata<CellT>::record_statistics()
 {
-    if (dimensions == ONE_DIMENSIONAL && rule == STRAIGHT_CONDITIONAL)
-    {
-        for (int j = 0; j < cols; ++j)
+    StateHistogram histogram(table_size);
+    int counted_rows = (dimensions == ONE_DIMENSIONAL) ? std::min(rows, 1) : rows;
+    for_each_band(0, counted_rows, cols, [&](int begin, int end) {
+        std::vector<uint64_t> band_counts(histogram.get_num_states());
+        for (int i = begin; i < end; ++i)
         {
-            // Directly apply rule based on current state
-            if (grid[0][j] == k)
-            {
-                grid[0][j] = kprime; // Change state: k -> k'
-            }
+            count_states(&cells[cell_index(i, 0)], cols, band_counts);
         }
-    }
+        histogram.merge(band_counts);
+    });
+    statistics.add(generation, histogram.get_counts());
 }
 
-// Compute function for 1-Dimension/Rule 2
-// Updates grid based on Conditional Transition
-// Note: Von Neumann and Moore are the same in 1D space (left/right neighbors)
-void CellularAutomata::onedim_rule2(int k, int kprime)
+// Helper function that adds the sample of a computed generation
+// Inputs:
+//      histogram : Cells of the generation counted by the compute function
+template <typename CellT>
+void BasicCellularAutomata<CellT>::record_statistics(const StateHistogram &histogram)
 {
-    std::vector<std::vector<int>> temp_grid = grid;
-
-    for (int j = 0; j < cols; ++j)
+    if (collect_statistics)
     {
-        int current_state = grid[0][j];
-        int left_neighbor, right_neighbor;
+        statistics.add(generation, histogram.get_counts());
+    }
+}
 
-        // PERIODIC BOUNDARIES
-        if (boundaries == PERIODIC)
-        {
-            left_neighbor = grid[0][(j - 1 + cols) % cols];
-            right_neighbor = grid[0][(j + 1) % cols];
-        }
-        else
-        {
-            // FIXED/NO BOUNDARIES
-            left_neighbor = (j == 0) ? ((boundaries == FIXED) ? k : current_state) : grid[0][j - 1];
-            right_neighbor = (j == cols - 1) ? ((boundaries == FIXED) ? k : current_state) : grid[0][j + 1];
-        }
+// Helper function that counts the states of a run of cells
+// States above the histogram are counted with its highest state.
+// Inputs:
+//      row : The cells
+//      count : Number of cells
+//      band_counts : Counts the cells are added to (nothing is counted if empty)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::count_states(const CellT *row, int count, std::vector<uint64_t> &band_counts) const
+{
+    if (band_counts.empty())
+    {
+        return;
+    }
+    count_states(row, count, band_counts.data(), static_cast<int>(band_counts.size()));
+}
 
-        // Apply Conditional Transition
-        if (current_state == k && (left_neighbor == kprime || right_neighbor == kprime))
-        {
-            temp_grid[0][j] = kprime;
-        }
+// Helper function that counts the states of a run of cells into an array
+// Inputs:
+//      row : The cells
+//      count : Number of cells
+//      counts : Counts of the states 0 to num_states - 1 the cells are added to
+//      num_states : Number of states counted
+template <typename CellT>
+template <typename Count>
+void BasicCellularAutomata<CellT>::count_states(const CellT *row, int count, Count *counts, int num_states) const
+{
+    const int last = num_states - 1;
+    for (int j = 0; j < count; ++j)
+    {
+        int state = row[j];
+        ++counts[state < 0 ? 0 : (state > last ? last : state)];
     }
+}
 
-    grid = temp_grid;
+// Setter method to skip the tiles of the grid that cannot change
+// The compute functions split the grid into tiles and remember which tiles
+// changed in the last generation. A tile is only recomputed if it or one of
+// the tiles around it changed, so the late phase of a run, where most of the
+// grid is stable, only costs the regions that are still active. Results are
+// identical either way.
+// Inputs:
+//      enabled : If true, stable tiles are skipped
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_active_regions(bool enabled)
+{
+    active_regions = enabled;
+    tiles_valid = false;
 }
 
-// Compute function for 1-Dimension/Rule 3
-// Updates grid based on Majority Rule
-// Note: Von Neumann and Moore are the same in 1D space (left/right neighbors)
-void CellularAutomata::onedim_rule3(int k, int kprime)
+// Getter method to check whether stable tiles are skipped
+template <typename CellT>
+bool BasicCellularAutomata<CellT>::get_active_regions() const
 {
-    // Temp_grid is the current grid
-    std::vector<std::vector<int>> temp_grid = grid;
+    return active_regions;
+}
 
-    for (int j = 0; j < cols; ++j)
+// Getter method to get the share of the grid computed in the last generation
+// Returns:
+//      Fraction of the tiles that were recomputed (1 when every tile was)
+template <typename CellT>
+double BasicCellularAutomata<CellT>::get_active_fraction() const
+{
+    size_t num_tiles = tile_active.size();
+    if (num_tiles == 0)
     {
-        int current_state = grid[0][j];
-        int left_neighbor, right_neighbor;
+        return 1.0;
+    }
+    return static_cast<double>(std::count(tile_active.begin(), tile_active.end(), 1)) / num_tiles;
+}
 
-        // PERIODIC BOUNDARIES
-        if (boundaries == PERIODIC)
-        {
-            left_neighbor = grid[0][(j - 1 + cols) % cols];
-            right_neighbor = grid[0][(j + 1) % cols];
-        }
-        else
-        {
-            // FIXED/NO BOUNDARIES
-            left_neighbor = (j == 0) ? ((boundaries == FIXED) ? k : current_state) : grid[0][j - 1];
-            right_neighbor = (j == cols - 1) ? ((boundaries == FIXED) ? k : current_state) : grid[0][j + 1];
-        }
+// Setter method to choose the engine used by step(generations)
+// The memoised engine stores the grid as a quadtree of canonical blocks and
+// remembers the future of every block, so grids made of repeated patterns
+// are advanced by 2^n generations in one lookup. It runs the deterministic
+// rules on periodic grids with a radius of 1 whose sides are powers of two
+// (at least 4).
+// The bit-sliced engine stores the grid as two bit-planes and computes 64
+// cells per word operation. It runs the rules with a radius of 1 on models
+// whose cells and states k and k' are between 0 and 3.
+// Other configurations, and update(), use the compute functions.
+// Inputs:
+//      engine : DIRECT_ENGINE, MEMOISED_ENGINE or BITSLICED_ENGINE
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_engine(EngineType engine)
+{
+    this->engine = engine;
+}
 
-        // Sum states of the neighbors
-        int neighbors_sum = left_neighbor + right_neighbor;
+// Setter method to set the number of generations advanced per pass of the grid
+// step(generations) and update(generations) cut the grid into bands that
+// fit in cache and advance every band several generations before moving on,
+// so large grids are read from memory once every few generations instead of
+// once per generation. Results are identical to one generation at a time.
+// Inputs:
+//      generations : Generations per pass (1 computes one generation at a time)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_temporal_blocking(int generations)
+{
+    time_block = generations < 1 ? 1 : generations;
+}
 
-        // Apply Majority Rule: If the cell's state is k and neighbors sum >= 1, update to kprime
-        if (current_state == k)
-        {
-            temp_grid[0][j] = (neighbors_sum >= 1) ? kprime : current_state;
-        }
+// Setter method to record the calls of the compute functions
+// The library must be compiled with CA_INSTRUMENTATION; the records are then
+// added to the trace (see CA_instrument.h). Counting the changed cells copies
+// the grid at the start of every generation, so instrumented runs are slower.
+// Inputs:
+//      enabled : If true, every generation computed by a compute function is recorded
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_instrumentation(bool enabled)
+{
+#ifdef CA_INSTRUMENTATION
+    instrumented = enabled;
+#else
+    if (enabled)
+    {
+        std::cerr << "Error: The library was compiled without CA_INSTRUMENTATION." << std::endl;
     }
+#endif
+}
 
-    // Grid is the newly updated grid
-    grid = temp_grid;
+// Getter method to check whether the compute functions are recorded
+template <typename CellT>
+bool BasicCellularAutomata<CellT>::get_instrumentation() const
+{
+    return instrumented;
 }
 
-// Compute function for 2-Dimension/Rule 1
-// Updates grid based on Straight Conditional
-void CellularAutomata::twodim_rule1(int k, int kprime)
+// Getter method to get the records of the instrumentation
+template <typename CellT>
+const InstrumentationTrace &BasicCellularAutomata<CellT>::get_trace() const
 {
-    if (dimensions == TWO_DIMENSIONAL && rule == STRAIGHT_CONDITIONAL)
-    {
-        for (int i = 0; i < rows; ++i)
-        {
-            for (int j = 0; j < cols; ++j)
-            {
-                // Directly apply rule based on current state
-                if (grid[i][j] == k)
-                {
-                    grid[i][j] = kprime; // Change state: k -> k'
-                }
-            }
-        }
-    }
+    return trace;
 }
 
-// Compute function for 2-Dimension/Rule 2
-// Updates grid based on Conditional Transition
-// Periodic Boundaries: The grid wraps around, and the neighbors of edge cells are calculated as if the grid is a torus
-// Fixed Boundaries: The edge cells use their current state or a predefined state for out-of-bound indices
-// No Boundaries: The out-of-bound indices are not wrapped around, and edge cells have fewer neighbors to consider
-// (treated as if they have the same state as the current cell or a predefined state)
-void CellularAutomata::twodim_rule2(int k, int kprime)
+// Function to remove the records of the instrumentation
+template <typename CellT>
+void BasicCellularAutomata<CellT>::clear_trace()
 {
-    std::vector<std::vector<int>> temp_grid = grid;
+    trace.clear();
+}
 
-    for (int i = 0; i < rows; ++i)
+// Helper function that starts the probe of a compute function
+// Nested probed calls (step(generations) calling step()) are part of the
+// outermost one. Copies of a model get their own probe state.
+// Inputs:
+//      function : Name of the public function
+template <typename CellT>
+void BasicCellularAutomata<CellT>::begin_probe(const char *function)
+{
+    if (!instrumented)
     {
-        for (int j = 0; j < cols; ++j)
-        {
-            int current_state = grid[i][j];
-            std::vector<int> neighbors;
-
-            // Calculate indices for orthogonal neighbors (VON NEUMANN)
-            int north = (boundaries != FIXED || i > 0) ? (i - 1 + rows) % rows : i;
-            int south = (boundaries != FIXED || i < rows - 1) ? (i + 1) % rows : i;
-            int east = (boundaries != FIXED || j < cols - 1) ? (j + 1) % cols : j;
-            int west = (boundaries != FIXED || j > 0) ? (j - 1 + cols) % cols : j;
+        return;
+    }
+    if (!probe || (probe.use_count() > 1 && probe->depth == 0))
+    {
+        probe = std::make_shared<ProbeState>();
+    }
+    if (probe->depth++ > 0)
+    {
+        return;
+    }
+    probe->function = function;
+    start_probe();
+}
 
-            // Add orthogonal neighbors (VON NEUMANN)
-            neighbors.push_back(grid[north][j]);
-            neighbors.push_back(grid[south][j]);
-            neighbors.push_back(grid[i][east]);
-            neighbors.push_back(grid[i][west]);
+// Helper function that records the generations left once the outermost probed call returns
+template <typename CellT>
+void BasicCellularAutomata<CellT>::end_probe()
+{
+    if (!instrumented || !probe || probe->depth == 0 || --probe->depth > 0)
+    {
+        return;
+    }
+    record_probe(nullptr);
+}
 
-            // Include diagonal neighbors (IF MOORE)
-            if (neighborhood == MOORE)
-            {
-                int northeast = (north * cols + east) % (rows * cols);
-                int northwest = (north * cols + west) % (rows * cols);
-                int southeast = (south * cols + east) % (rows * cols);
-                int southwest = (south * cols + west) % (rows * cols);
-
-                neighbors.push_back(grid[northeast / cols][northeast % cols]);
-                neighbors.push_back(grid[northwest / cols][northwest % cols]);
-                neighbors.push_back(grid[southeast / cols][southeast % cols]);
-                neighbors.push_back(grid[southwest / cols][southwest % cols]);
-            }
+// Helper function that checks whether a multi-generation function should
+// record its generations one by one (it is the outermost probed call)
+template <typename CellT>
+bool BasicCellularAutomata<CellT>::probing_generations() const
+{
+    return instrumented && probe && probe->depth == 1;
+}
 
-            // Apply Conditional Transition
-            bool condition_met = false;
-            for (int neighbor_state : neighbors)
-            {
-                if (neighbor_state == kprime)
-                {
-                    condition_met = true;
-                    break;
-                }
-            }
+// Helper function that takes the grid, generation, allocations, counters and
+// time the next record is measured from
+template <typename CellT>
+void BasicCellularAutomata<CellT>::start_probe()
+{
+    probe->previous = cells;
+    probe->start_generation = generation;
+    probe->start_allocations = get_allocation_count();
+    probe->counters.read(probe->start_counters);
+    probe->start = std::chrono::steady_clock::now();
+}
 
-            if (current_state == k && condition_met)
+// Helper function that records the generations computed since the probe started
+// Without cells_changed the generations form a single record whose changed
+// cells are counted against the grid at the start. With cells_changed every
+// generation gets its own record; generations computed together (a pass of
+// temporal blocking) are timed together and share the time, counters and
+// allocations evenly. The probe then restarts if the call goes on.
+// Inputs:
+//      cells_changed : Changed cells of every generation, or nullptr
+template <typename CellT>
+void BasicCellularAutomata<CellT>::record_probe(const std::vector<uint64_t> *cells_changed)
+{
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    int64_t counters[NUM_HARDWARE_COUNTERS];
+    probe->counters.read(counters);
+    const uint64_t allocations = get_allocation_count() - probe->start_allocations;
+    const double seconds = std::chrono::duration<double>(end - probe->start).count();
+    const uint64_t generations = generation - probe->start_generation;
+    const uint64_t num_records = cells_changed ? cells_changed->size() : 1;
+
+    int counted_rows = (dimensions == ONE_DIMENSIONAL) ? std::min(rows, 1) : rows;
+    uint64_t cells_per_generation = static_cast<uint64_t>(counted_rows) * cols;
+    uint64_t changed = 0;
+    if (!cells_changed && generations > 0 && probe->previous.size() == cells.size())
+    {
+        for (int i = 0; i < counted_rows; ++i)
+        {
+            const CellT *row = &cells[cell_index(i, 0)];
+            const CellT *previous_row = &probe->previous[cell_index(i, 0)];
+            for (int j = 0; j < cols; ++j)
             {
-                temp_grid[i][j] = kprime;
+                changed += row[j] != previous_row[j];
             }
         }
     }
 
-    // Current grid -> updated grid
-    grid = temp_grid;
-}
-
-// Compute function for 2-Dimension/Rule 3
-// Updates grid based on Majority Rule
-// For periodic boundaries, the grid wraps around
-// For fixed boundaries, edge cells assume a fixed state (k)
-// For no boundaries, edge cells are treated as having the same state as the cell itself
-void CellularAutomata::twodim_rule3(int k, int kprime)
-{
-    std::vector<std::vector<int>> temp_grid = grid;
-
-    for (int i = 0; i < rows; ++i)
+    for (uint64_t r = 0; r < num_records && generations > 0; ++r)
     {
-        for (int j = 0; j < cols; ++j)
+        GenerationRecord record;
+        record.function = probe->function;
+        record.generations = cells_changed ? 1 : generations;
+        record.generation = probe->start_generation + (cells_changed ? r + 1 : generations);
+        record.seconds = seconds / num_records;
+        record.allocations = allocations / num_records + (r == 0 ? allocations % num_records : 0);
+        for (int counter = 0; counter < NUM_HARDWARE_COUNTERS; ++counter)
         {
-            int current_state = grid[i][j];
-            int neighbors_sum = 0;
-
-            // Calculate indices for orthogonal neighbors (periodic boundaries + VN)
-            int north = (i - 1 + rows) % rows;
-            int south = (i + 1) % rows;
-            int east = (j + 1) % cols;
-            int west = (j - 1 + cols) % cols;
-
-            // Handle boundaries for orthogonal neighbors (fixed boundaries + VN)
-            north = (i == 0 && boundaries != PERIODIC) ? ((boundaries == FIXED) ? k : current_state) : north;
-            south = (i == rows - 1 && boundaries != PERIODIC) ? ((boundaries == FIXED) ? k : current_state) : south;
-            east = (j == cols - 1 && boundaries != PERIODIC) ? ((boundaries == FIXED) ? k : current_state) : east;
-            west = (j == 0 && boundaries != PERIODIC) ? ((boundaries == FIXED) ? k : current_state) : west;
-
-            // Add orthogonal neighbors to the sum
-            neighbors_sum += grid[north][j];
-            neighbors_sum += grid[south][j];
-            neighbors_sum += grid[i][east];
-            neighbors_sum += grid[i][west];
-
-            // Include diagonal neighbors for Moore neighborhood
-            if (neighborhood == MOORE)
+            if (counters[counter] >= 0 && probe->start_counters[counter] >= 0)
             {
-                // Calculate indices for diagonal neighbors (periodic boundaries + M)
-                int northeast = (north * cols + east) % (rows * cols);
-                int northwest = (north * cols + west) % (rows * cols);
-                int southeast = (south * cols + east) % (rows * cols);
-                int southwest = (south * cols + west) % (rows * cols);
-
-                // Handle boundaries for diagonal neighbors (fixed boundaries + M)
-                if (boundaries != PERIODIC)
-                {
-                    northeast = ((north == i) ? i : north) * cols + ((east == j) ? j : east);
-                    northwest = ((north == i) ? i : north) * cols + ((west == j) ? j : west);
-                    southeast = ((south == i) ? i : south) * cols + ((east == j) ? j : east);
-                    southwest = ((south == i) ? i : south) * cols + ((west == j) ? j : west);
-                }
-
-                neighbors_sum += grid[northeast / cols][northeast % cols];
-                neighbors_sum += grid[northwest / cols][northwest % cols];
-                neighbors_sum += grid[southeast / cols][southeast % cols];
-                neighbors_sum += grid[southwest / cols][southwest % cols];
+                uint64_t delta = static_cast<uint64_t>(counters[counter] - probe->start_counters[counter]);
+                record.counters[counter] =
+                    static_cast<int64_t>(delta / num_records + (r == 0 ? delta % num_records : 0));
             }
-
-            // Calculate threshold based on the neighborhood type
-            int threshold = (neighborhood == VON_NEUMANN) ? 2 : 5;
-
-            // Apply Majority Rule only if the cell's current state is k
-            if (current_state == k)
+            else
             {
-                temp_grid[i][j] = (neighbors_sum >= threshold) ? kprime : current_state;
+                record.counters[counter] = -1;
             }
         }
+        record.cells_updated = cells_per_generation * record.generations;
+        record.bytes_written = record.cells_updated * sizeof(CellT);
+        record.cells_changed = cells_changed ? (*cells_changed)[r] : changed;
+        trace.add(record);
     }
 
-    // Current Grid -> Updated Grid
-    grid = temp_grid;
+    if (probe->depth > 0)
+    {
+        start_probe();
+    }
 }
 
-// Update function to advance the CA model to the next generation
-// Note: Kassady created this function but had trouble pushing it to the repo
-void CellularAutomata::update()
+// Getter method to get the number of generations advanced per pass of the grid
+template <typename CellT>
+int BasicCellularAutomata<CellT>::get_temporal_blocking() const
+{
+    return time_block;
+}
+
+// Getter method to get the engine chosen with set_engine
+template <typename CellT>
+EngineType BasicCellularAutomata<CellT>::get_engine() const
+{
+    return engine;
+}
+
+// Getter method to get the engine step(generations) uses for the current configuration
+// Returns:
+//      The engine chosen with set_engine if it supports the configuration, DIRECT_ENGINE otherwise
+template <typename CellT>
+EngineType BasicCellularAutomata<CellT>::get_active_engine() const
+{
+    if (neighborhood_radius != 1 || rows <= 0 || cols <= 0)
+    {
+        return DIRECT_ENGINE;
+    }
+    if (engine == MEMOISED_ENGINE)
+    {
+        auto power_of_two = [](int side) { return side >= 4 && (side & (side - 1)) == 0; };
+        bool supported = boundaries == PERIODIC && power_of_two(cols) &&
+                         (dimensions == ONE_DIMENSIONAL || power_of_two(rows));
+        return supported ? MEMOISED_ENGINE : DIRECT_ENGINE;
+    }
+    if (engine == BITSLICED_ENGINE)
+    {
+        bool supported = states <= 4 && k >= 0 && k <= 3 && kprime >= 0 && kprime <= 3;
+        return supported ? BITSLICED_ENGINE : DIRECT_ENGINE;
+    }
+    return DIRECT_ENGINE;
+}
+
+// Helper function that chooses the tiles computed in this generation
+// Every tile is computed unless the last generation was computed by the same
+// kernel with the same k and k', on a grid that was not modified since.
+// Otherwise a tile is computed if it or one of its 8 neighbor tiles (2 in 1D)
+// changed; skipped tiles hold the same cells in both buffers.
+// Inputs:
+//      kernel : The kernel about to run
+//      k, kprime : The states used by the rule
+//      wrap : True if tiles on opposite edges are neighbors (periodic boundaries)
+//      one_dim : True if the kernel computes the line only (1D kernel), whatever
+//                the dimensions the model is configured with
+// Returns:
+//      True if the tiles are tracked (active regions enabled)
+template <typename CellT>
+bool BasicCellularAutomata<CellT>::prepare_tiles(StepFunction kernel, int k, int kprime, bool wrap, bool one_dim)
 {
-    std::vector<std::vector<int>> temp_grid(rows, std::vector<int>(cols, 0));
+    // Tiles of ACTIVE_TILE_ROWS x ACTIVE_TILE_COLS cells, or ACTIVE_TILE_LINE cells in 1D
+    int height = one_dim ? 1 : ACTIVE_TILE_ROWS;
+    int width = one_dim ? ACTIVE_TILE_LINE : ACTIVE_TILE_COLS;
+    int active_rows = one_dim ? std::min(rows, 1) : rows;
+    int down = (active_rows + height - 1) / height;
+    int across = (cols + width - 1) / width;
+    size_t num_tiles = static_cast<size_t>(down) * across;
+
+    bool reuse = active_regions && tiles_valid && kernel == tracked_step && k == tracked_k &&
+                 kprime == tracked_kprime && height == tile_height && width == tile_width && down == tiles_down &&
+                 across == tiles_across &&
+                 tile_changed.size() == num_tiles &&
+                 (!collect_statistics || (tile_counts_valid && tile_counts.size() == num_tiles * table_size));
+    tile_height = height;
+    tile_width = width;
+    tiles_down = down;
+    tiles_across = across;
+    tile_changed.resize(num_tiles, 1);
+    tile_active.assign(num_tiles, 1);
+    if (active_regions && collect_statistics)
+    {
+        tile_counts.resize(num_tiles * table_size);
+    }
+    if (!reuse)
+    {
+        return active_regions;
+    }
+
+    for (int tile_row = 0; tile_row < down; ++tile_row)
+    {
+        for (int tile_col = 0; tile_col < across; ++tile_col)
+        {
+            bool active = false;
+            for (int dr = -1; dr <= 1 && !active; ++dr)
+            {
+                for (int dc = -1; dc <= 1 && !active; ++dc)
+                {
+                    int r = tile_row + dr, c = tile_col + dc;
+                    if (wrap)
+                    {
+                        r = (r + down) % down;
+                        c = (c + across) % across;
+                    }
+                    else if (r < 0 || r >= down || c < 0 || c >= across)
+                    {
+                        continue;
+                    }
+                    active = tile_changed[static_cast<size_t>(r) * across + c] != 0;
+                }
+            }
+            tile_active[static_cast<size_t>(tile_row) * across + tile_col] = active;
+        }
+    }
+    return true;
+}
+
+// Helper function that records the generation computed by a tiled kernel
+// Inputs:
+//      kernel : The kernel that ran
+//      k, kprime : The states used by the rule
+//      tracked : True if the kernel tracked the changed tiles
+//      histogram : Histogram completed with the counts of every tile (statistics)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::finish_tiles(StepFunction kernel, int k, int kprime, bool tracked,
+                                                StateHistogram &histogram)
+{
+    tiles_valid = tracked;
+    tracked_step = kernel;
+    tracked_k = k;
+    tracked_kprime = kprime;
+    tile_counts_valid = tracked && histogram.get_num_states() > 0;
+
+    if (tile_counts_valid)
+    {
+        const int bins = histogram.get_num_states();
+        std::vector<uint64_t> totals(bins, 0);
+        for (size_t tile = 0; tile < tile_active.size(); ++tile)
+        {
+            for (int state = 0; state < bins; ++state)
+            {
+                totals[state] += tile_counts[tile * bins + state];
+            }
+        }
+        histogram.merge(totals);
+    }
+}
+
+// Helper function that runs task over [begin, end) in parallel bands
+// Small ranges run on the calling thread so threads are only used when
+// every band has enough cells to pay for the synchronisation.
+// Inputs:
+//      begin, end : Range of rows (or columns of the 1D line) to update
+//      cells_per_index : Number of cells in one row (1 for columns)
+//      task : Function called as task(band_begin, band_end)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::for_each_band(int begin, int end, long long cells_per_index,
+                                                 const std::function<void(int, int)> &task)
+{
+    long long max_bands = (end - begin) * cells_per_index / MIN_BAND_CELLS;
+    if (!pool || max_bands <= 1)
+    {
+        task(begin, end);
+        return;
+    }
+    pool->parallel_for(begin, end, task, static_cast<int>(std::min<long long>(max_bands, num_threads)));
+}
+
+// Getter method to get the width of the ghost-cell halo around the grid
+// Returns:
+//      halo : Number of ghost cells on each side of the grid
+template <typename CellT>
+int BasicCellularAutomata<CellT>::get_halo_width() const
+{
+    return halo;
+}
+
+// Getter method to get the state of a single cell
+// Inputs:
+//      row, col : Position of the cell in the grid
+// Returns:
+//      The state of the cell
+template <typename CellT>
+int BasicCellularAutomata<CellT>::get_cell_state(int row, int col) const
+{
+    return cells[cell_index(row, col)];
+}
+
+// Helper function that allocates the padded grid buffers for the current grid size
+// Every row is followed by its ghost cells, so neighbors are found with fixed
+// offsets (-1, +1, -stride, +stride) instead of wrapped indices. The front buffer
+// holds the current generation and the back buffer receives the next one, so
+// stepping never allocates or copies the grid.
+template <typename CellT>
+void BasicCellularAutomata<CellT>::allocate_grid()
+{
+    stride = cols + 2 * halo;
+    cells.assign(static_cast<size_t>(rows + 2 * halo) * stride, 0);
+    next_cells.assign(cells.size(), 0);
+    halo_valid = false;
+    tiles_valid = false;
+}
+
+// Helper function that marks the tile of a cell changed outside of the kernels
+// The tile and its neighbors are then recomputed in the next generation.
+// Inputs:
+//      row, col : Position of the cell in the grid
+template <typename CellT>
+void BasicCellularAutomata<CellT>::mark_tile_changed(int row, int col)
+{
+    size_t tile = static_cast<size_t>(row / tile_height) * tiles_across + col / tile_width;
+    if (tiles_valid && tile < tile_changed.size() && row / tile_height < tiles_down)
+    {
+        tile_changed[tile] = 1;
+    }
+}
+
+// Helper function that makes the back buffer (next generation) the current grid
+template <typename CellT>
+void BasicCellularAutomata<CellT>::swap_buffers()
+{
+    cells.swap(next_cells);
+    halo_valid = false;
+}
+
+// Helper function that fills the ghost cells around the grid once per generation
+// Periodic Boundaries: ghost cells are copies of the cells on the opposite edge
+// Fixed Boundaries: ghost cells hold a predefined state
+// No Boundaries: ghost cells repeat the nearest edge cell, so edge cells see themselves
+// The boundary type is a template parameter so the loops do not branch on it.
+// Inputs:
+//      fixed_state : The state of the ghost cells for fixed boundaries
+template <typename CellT>
+template <BoundaryType B>
+void BasicCellularAutomata<CellT>::fill_halo(int fixed_state)
+{
+    if (rows <= 0 || cols <= 0)
+    {
+        return;
+    }
+
+    // Left and right ghost cells of each row
+    for (int i = 0; i < rows; ++i)
+    {
+        CellT *row = &cells[cell_index(i, 0)];
+        for (int h = 1; h <= halo; ++h)
+        {
+            if (B == PERIODIC)
+            {
+                row[-h] = row[((cols - h) % cols + cols) % cols];
+                row[cols - 1 + h] = row[(h - 1) % cols];
+            }
+            else if (B == FIXED)
+            {
+                row[-h] = row[cols - 1 + h] = static_cast<CellT>(fixed_state);
+            }
+            else
+            {
+                row[-h] = row[0];
+                row[cols - 1 + h] = row[cols - 1];
+            }
+        }
+    }
+
+    // Top and bottom ghost rows (whole padded rows, which also fills the corners)
+    for (int h = 1; h <= halo; ++h)
+    {
+        CellT *top = &cells[static_cast<size_t>(halo - h) * stride];
+        CellT *bottom = &cells[static_cast<size_t>(halo + rows - 1 + h) * stride];
+
+        if (B == FIXED)
+        {
+            std::fill(top, top + stride, static_cast<CellT>(fixed_state));
+            std::fill(bottom, bottom + stride, static_cast<CellT>(fixed_state));
+        }
+        else
+        {
+            int top_source = (B == PERIODIC) ? ((rows - h) % rows + rows) % rows : 0;
+            int bottom_source = (B == PERIODIC) ? (h - 1) % rows : rows - 1;
+            const CellT *top_row = &cells[static_cast<size_t>(halo + top_source) * stride];
+            const CellT *bottom_row = &cells[static_cast<size_t>(halo + bottom_source) * stride];
+            std::copy(top_row, top_row + stride, top);
+            std::copy(bottom_row, bottom_row + stride, bottom);
+        }
+    }
+}
+
+// Helper function that fills the ghost cells for a boundary type chosen at runtime
+// Inputs:
+//      boundary_type : The boundary type used to fill the halo
+//      fixed_state : The state of the ghost cells for fixed boundaries
+template <typename CellT>
+void BasicCellularAutomata<CellT>::fill_halo(BoundaryType boundary_type, int fixed_state)
+{
+    switch (boundary_type)
+    {
+    case PERIODIC:
+        fill_halo<PERIODIC>(fixed_state);
+        break;
+    case FIXED:
+        fill_halo<FIXED>(fixed_state);
+        break;
+    case NO_BOUNDARIES:
+        fill_halo<NO_BOUNDARIES>(fixed_state);
+        break;
+    }
+}
+
+// Helper function that refills the halo from the configured boundaries if it is stale
+template <typename CellT>
+void BasicCellularAutomata<CellT>::ensure_halo()
+{
+    if (!halo_valid)
+    {
+        fill_halo(boundaries, k);
+        halo_valid = true;
+    }
+}
+
+// Setup function to initialize the grid based on the specified dimension
+// The random states are drawn from the model's generator (see set_seed).
+// Note: Kassady made the final changes to this function but had trouble pushing to the repo
+template <typename CellT>
+void BasicCellularAutomata<CellT>::setup_dimensions()
+{
+    allocate_grid();
+    generation = 0;
+
+    // Only the first line is used in 1D
+    int setup_rows = (dimensions == ONE_DIMENSIONAL) ? std::min(rows, 1) : rows;
+
+    // Initialize grid with random states
+    for_each_band(0, setup_rows, cols, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            CellT *row = &cells[cell_index(i, 0)];
+            for (int j = 0; j < cols; ++j)
+            {
+                uint64_t cell = static_cast<uint64_t>(i) * cols + j;
+                int random_state = rng.draw(generation, cell, STREAM_SETUP) % states + 1;
+                row[j] = random_state;
+            }
+        }
+    });
+}
+
+// Setup function to configure the grid based on the specified boundary type
+template <typename CellT>
+void BasicCellularAutomata<CellT>::setup_boundaries()
+{
+    if (boundaries == FIXED && rows > 0 && cols > 0)
+    {
+        // Fixed boundary logic setup
+        int fixed_state = 1; // Replace with the desired fixed state
+        for (int j = 0; j < cols; ++j)
+        {
+            cells[cell_index(0, j)] = cells[cell_index(rows - 1, j)] = fixed_state;
+        }
+        for (int i = 0; i < rows; ++i)
+        {
+            cells[cell_index(i, 0)] = cells[cell_index(i, cols - 1)] = fixed_state;
+        }
+    }
+    // Periodic and no boundaries need no setup: they are applied through the halo
+    halo_valid = false;
+    tiles_valid = false;
+}
+
+// Setup function to establish the neighborhood relationships for each cell.
+// Neighbors are reached through the ghost-cell halo, so this fills the halo
+// from the configured boundaries.
+template <typename CellT>
+void BasicCellularAutomata<CellT>::setup_neighborhood()
+{
+    halo_valid = false;
+    ensure_halo();
+}
+
+// Setup function to apply the specified rule to update the grid's state
+template <typename CellT>
+void BasicCellularAutomata<CellT>::setup_rule()
+{
+    ensure_halo();
+
+    for (int i = 0; i < rows; ++i)
+    {
+        CellT *row = &cells[cell_index(i, 0)];
+        for (int j = 0; j < cols; ++j)
+        {
+            int neighbor_north = row[j - stride];
+            int neighbor_south = row[j + stride];
+            int neighbor_east = row[j + 1];
+            int neighbor_west = row[j - 1];
+
+            if (rule == STRAIGHT_CONDITIONAL)
+            {
+                // Straight conditional transition logic setup
+                int state_condition = k; // Replace with the desired state condition
+                int new_state = kprime;  // Replace with the desired new state
+                if (row[j] == state_condition)
+                    row[j] = new_state;
+            }
+            else if (rule == CONDITIONAL_TRANSITION)
+            {
+                // Conditional transition rule on a neighbor logic setup
+                int state_condition = k;         // Replace with the desired state condition
+                int neighbor_condition = kprime; // Replace with the desired neighbor condition
+                if (row[j] == state_condition && neighbor_south == neighbor_condition)
+                    row[j] = neighbor_south;
+            }
+            else if (rule == MAJORITY_RULE)
+            {
+                // Majority rule logic setup
+                int sum_neighbors = neighbor_north + neighbor_south + neighbor_east + neighbor_west;
+                int majority_state = (sum_neighbors >= 2) ? 1 : 0;
+                row[j] = majority_state;
+            }
+        }
+    }
+    halo_valid = false;
+    tiles_valid = false;
+}
+
+// Helper function that returns the genotype of a draw in Hardy-Weinberg proportions
+// Inputs:
+//      unit : Uniform draw in [0, 1)
+//      q : Frequency of the recessive allele
+// Returns:
+//      Recessive (q^2), Heterzygous (2pq) or HomozygousDominant (p^2)
+static int hardy_weinberg_genotype(double unit, double q)
+{
+    const double p = 1.0 - q;
+    if (unit < q * q)
+        return static_cast<int>(Allele_Genotype::Recessive);
+    if (unit < q * q + 2.0 * p * q)
+        return static_cast<int>(Allele_Genotype::Heterzygous);
+    return static_cast<int>(Allele_Genotype::HomozygousDominant);
+}
+
+// Helper function that allocates the grid for a population
+// The grid is cleared instead of being filled with random states first.
+// Returns:
+//      Number of rows that hold the population (only the first line in 1D)
+template <typename CellT>
+int BasicCellularAutomata<CellT>::begin_population()
+{
+    allocate_grid();
+    generation = 0;
+    return (dimensions == ONE_DIMENSIONAL) ? std::min(rows, 1) : rows;
+}
+
+// Helper function that returns the sort key of a cell for setup_population_counts()
+// The cell breaks ties, so every cell has its own key.
+template <typename CellT>
+std::pair<uint64_t, uint64_t> BasicCellularAutomata<CellT>::population_key(uint64_t cell) const
+{
+    uint32_t words[4];
+    rng.draw4(0, cell, STREAM_INIT, words);
+    return std::make_pair((static_cast<uint64_t>(words[0]) << 32) | words[1], cell);
+}
+
+// Function that fills the grid with cells in Hardy-Weinberg proportions
+// Inputs:
+//      recessive_frequency : Frequency q of the recessive allele (0 to 1)
+// Returns:
+//      True if the grid was filled
+template <typename CellT>
+bool BasicCellularAutomata<CellT>::setup_population(double recessive_frequency)
+{
+    if (!(recessive_frequency >= 0.0 && recessive_frequency <= 1.0))
+    {
+        std::cerr << "Error: The frequency of the recessive allele must be between 0 and 1." << std::endl;
+        return false;
+    }
+    const int setup_rows = begin_population();
+
+    for_each_band(0, setup_rows, cols, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            CellT *row = &cells[cell_index(i, 0)];
+            for (int j = 0; j < cols; ++j)
+            {
+                uint64_t cell = static_cast<uint64_t>(i) * cols + j;
+                double unit = CounterRNG::to_unit(rng.draw(0, cell, STREAM_INIT));
+                row[j] = static_cast<CellT>(hardy_weinberg_genotype(unit, recessive_frequency));
+            }
+        }
+    });
+    return true;
+}
+
+// Function that fills the grid with exact numbers of cells of each genotype
+// Every cell gets a random key; the recessive cells are those with the
+// smallest keys and the heterozygous cells the next ones. The two keys at
+// these ranks are found with a histogram of the top 16 bits of every key,
+// then selected with nth_element among the keys of the two buckets that hold
+// them, so the grid is read three times in parallel and never sorted.
+// Inputs:
+//      dominant, heterozygous, recessive : Number of cells of each genotype
+// Returns:
+//      True if the grid was filled
+template <typename CellT>
+bool BasicCellularAutomata<CellT>::setup_population_counts(uint64_t dominant, uint64_t heterozygous,
+                                                           uint64_t recessive)
+{
+    const int population_rows = (dimensions == ONE_DIMENSIONAL) ? std::min(rows, 1) : rows;
+    const uint64_t num_cells = static_cast<uint64_t>(population_rows) * cols;
+    if (dominant + heterozygous + recessive != num_cells)
+    {
+        std::cerr << "Error: The genotype counts must add up to the " << num_cells << " cells of the grid."
+                  << std::endl;
+        return false;
+    }
+    const int setup_rows = begin_population();
+    const int BUCKET_SHIFT = 48;
+    std::mutex merge_lock;
+
+    // Histogram of the top bits of the keys
+    std::vector<uint64_t> histogram(static_cast<size_t>(1) << (64 - BUCKET_SHIFT), 0);
+    for_each_band(0, setup_rows, cols, [&](int begin, int end) {
+        std::vector<uint64_t> band_histogram(histogram.size(), 0);
+        for (uint64_t cell = static_cast<uint64_t>(begin) * cols; cell < static_cast<uint64_t>(end) * cols; ++cell)
+        {
+            ++band_histogram[population_key(cell).first >> BUCKET_SHIFT];
+        }
+        std::lock_guard<std::mutex> lock(merge_lock);
+        for (size_t bucket = 0; bucket < histogram.size(); ++bucket)
+        {
+            histogram[bucket] += band_histogram[bucket];
+        }
+    });
+
+    // Buckets of the keys at the two ranks (no key when the rank is past the last cell)
+    const uint64_t ranks[2] = {recessive, recessive + heterozygous};
+    uint64_t buckets[2] = {histogram.size(), histogram.size()};
+    uint64_t ranks_in_bucket[2] = {0, 0};
+    for (int r = 0; r < 2; ++r)
+    {
+        uint64_t below = 0;
+        for (size_t bucket = 0; bucket < histogram.size() && ranks[r] < num_cells; ++bucket)
+        {
+            if (below + histogram[bucket] > ranks[r])
+            {
+                buckets[r] = bucket;
+                ranks_in_bucket[r] = ranks[r] - below;
+                break;
+            }
+            below += histogram[bucket];
+        }
+    }
+
+    // Keys of the two buckets, from which the keys at the ranks are selected with nth_element
+    std::vector<std::pair<uint64_t, uint64_t>> bucket_keys[2];
+    for_each_band(0, setup_rows, cols, [&](int begin, int end) {
+        std::vector<std::pair<uint64_t, uint64_t>> band_keys[2];
+        for (uint64_t cell = static_cast<uint64_t>(begin) * cols; cell < static_cast<uint64_t>(end) * cols; ++cell)
+        {
+            std::pair<uint64_t, uint64_t> key = population_key(cell);
+            for (int r = 0; r < 2; ++r)
+            {
+                if ((key.first >> BUCKET_SHIFT) == buckets[r])
+                {
+                    band_keys[r].push_back(key);
+                }
+            }
+        }
+        std::lock_guard<std::mutex> lock(merge_lock);
+        for (int r = 0; r < 2; ++r)
+        {
+            bucket_keys[r].insert(bucket_keys[r].end(), band_keys[r].begin(), band_keys[r].end());
+        }
+    });
+    const std::pair<uint64_t, uint64_t> no_key(UINT64_MAX, UINT64_MAX);
+    std::pair<uint64_t, uint64_t> thresholds[2] = {no_key, no_key};
+    for (int r = 0; r < 2; ++r)
+    {
+        if (buckets[r] < histogram.size())
+        {
+            std::nth_element(bucket_keys[r].begin(), bucket_keys[r].begin() + ranks_in_bucket[r], bucket_keys[r].end());
+            thresholds[r] = bucket_keys[r][ranks_in_bucket[r]];
+        }
+    }
+
+    for_each_band(0, setup_rows, cols, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            CellT *row = &cells[cell_index(i, 0)];
+            for (int j = 0; j < cols; ++j)
+            {
+                std::pair<uint64_t, uint64_t> key = population_key(static_cast<uint64_t>(i) * cols + j);
+                Allele_Genotype genotype = key < thresholds[0]   ? Allele_Genotype::Recessive
+                                           : key < thresholds[1] ? Allele_Genotype::Heterzygous
+                                                                 : Allele_Genotype::HomozygousDominant;
+                row[j] = static_cast<CellT>(genotype);
+            }
+        }
+    });
+    return true;
+}
+
+// Function that fills the grid with patches of genotypes around random seeds
+// Every cell takes the genotype of its nearest seed (the first seed on ties).
+// The seeds are binned into square buckets of about one seed each, and a cell
+// searches the rings of buckets around its own until no closer seed can remain.
+// Inputs:
+//      recessive_frequency : Frequency q of the recessive allele (0 to 1)
+//      num_seeds : Number of patches
+// Returns:
+//      True if the grid was filled
+template <typename CellT>
+bool BasicCellularAutomata<CellT>::setup_clustered_population(double recessive_frequency, int num_seeds)
+{
+    if (!(recessive_frequency >= 0.0 && recessive_frequency <= 1.0))
+    {
+        std::cerr << "Error: The frequency of the recessive allele must be between 0 and 1." << std::endl;
+        return false;
+    }
+    if (num_seeds < 1)
+    {
+        std::cerr << "Error: A clustered population needs at least one seed." << std::endl;
+        return false;
+    }
+    const int setup_rows = begin_population();
+    if (setup_rows <= 0 || cols <= 0)
+    {
+        return true;
+    }
+
+    // Seeds are drawn from generation 1 of the stream, so they never share a counter with a cell
+    std::vector<int> seed_rows(num_seeds), seed_cols(num_seeds), seed_genotypes(num_seeds);
+    for (int seed = 0; seed < num_seeds; ++seed)
+    {
+        uint32_t words[4];
+        rng.draw4(1, static_cast<uint64_t>(seed), STREAM_INIT, words);
+        seed_rows[seed] = static_cast<int>(words[0] % static_cast<uint32_t>(setup_rows));
+        seed_cols[seed] = static_cast<int>(words[1] % static_cast<uint32_t>(cols));
+        seed_genotypes[seed] = hardy_weinberg_genotype(CounterRNG::to_unit(words[2]), recessive_frequency);
+    }
+
+    // Buckets of seeds, stored as the seeds of bucket b at bucket_seeds[bucket_first[b]...]
+    const int bucket_size = std::max(1, static_cast<int>(std::ceil(
+                                            std::sqrt(static_cast<double>(setup_rows) * cols / num_seeds))));
+    const int buckets_down = (setup_rows + bucket_size - 1) / bucket_size;
+    const int buckets_across = (cols + bucket_size - 1) / bucket_size;
+    std::vector<int> bucket_first(static_cast<size_t>(buckets_down) * buckets_across + 1, 0);
+    std::vector<int> bucket_seeds(num_seeds);
+    for (int seed = 0; seed < num_seeds; ++seed)
+    {
+        ++bucket_first[(seed_rows[seed] / bucket_size) * buckets_across + seed_cols[seed] / bucket_size + 1];
+    }
+    for (size_t bucket = 1; bucket < bucket_first.size(); ++bucket)
+    {
+        bucket_first[bucket] += bucket_first[bucket - 1];
+    }
+    std::vector<int> bucket_fill(bucket_first.begin(), bucket_first.end() - 1);
+    for (int seed = 0; seed < num_seeds; ++seed)
+    {
+        bucket_seeds[bucket_fill[(seed_rows[seed] / bucket_size) * buckets_across + seed_cols[seed] / bucket_size]++] =
+            seed;
+    }
+    const int max_ring = std::max(buckets_down, buckets_across);
+
+    for_each_band(0, setup_rows, cols, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            CellT *row = &cells[cell_index(i, 0)];
+            const int bucket_i = i / bucket_size;
+            for (int j = 0; j < cols; ++j)
+            {
+                const int bucket_j = j / bucket_size;
+                long long best_distance = -1;
+                int best_seed = 0;
+                for (int ring = 0; ring <= max_ring; ++ring)
+                {
+                    for (int bi = bucket_i - ring; bi <= bucket_i + ring; ++bi)
+                    {
+                        if (bi < 0 || bi >= buckets_down)
+                            continue;
+                        // Only the edge of the ring is new
+                        int step = (bi == bucket_i - ring || bi == bucket_i + ring) ? 1 : std::max(2 * ring, 1);
+                        for (int bj = bucket_j - ring; bj <= bucket_j + ring; bj += step)
+                        {
+                            if (bj < 0 || bj >= buckets_across)
+                                continue;
+                            int bucket = bi * buckets_across + bj;
+                            for (int s = bucket_first[bucket]; s < bucket_first[bucket + 1]; ++s)
+                            {
+                                int seed = bucket_seeds[s];
+                                long long di = seed_rows[seed] - i, dj = seed_cols[seed] - j;
+                                long long distance = di * di + dj * dj;
+                                if (best_distance < 0 || distance < best_distance ||
+                                    (distance == best_distance && seed < best_seed))
+                                {
+                                    best_distance = distance;
+                                    best_seed = seed;
+                                }
+                            }
+                        }
+                    }
+                    // Seeds in the next rings are at least ring * bucket_size + 1 cells away
+                    long long reach = static_cast<long long>(ring) * bucket_size + 1;
+                    if (best_distance >= 0 && best_distance < reach * reach)
+                        break;
+                }
+                row[j] = static_cast<CellT>(seed_genotypes[best_seed]);
+            }
+        }
+    });
+    return true;
+}
+
+// Setup functions to set and get state "k" to be used on compute step
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_k(int k_state)
+{
+    k = k_state;
+}
+
+template <typename CellT>
+int BasicCellularAutomata<CellT>::get_k() const
+{
+    return k;
+}
+
+// Setup functions to set and get state "k'" to be used on compute step
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_kprime(int kprime_state)
+{
+    kprime = kprime_state;
+}
+
+template <typename CellT>
+int BasicCellularAutomata<CellT>::get_kprime() const
+{
+    return kprime;
+}
+
+// Function to be able to add rules in vector for models that utilize multiple rules
+// The rule is called once per cell with the grid, the row and the column, and
+// returns the new state of the cell. Rules are run in order by step_rules().
+// Per-cell rules are always called from the calling thread, one cell at a
+// time, whatever the number of threads (unlike tile rules).
+template <typename CellT>
+void BasicCellularAutomata<CellT>::add_rule(const RuleFunction &new_rule)
+{
+    RegisteredRule registered;
+    registered.cell = new_rule;
+    rules.push_back(registered);
+}
+
+// Function to add a rule that updates a whole block of rows per call
+// Unlike add_rule, the rule is called once per tile rather than once per
+// cell, so its inner loops can be inlined and vectorized by the compiler.
+// Inputs:
+//      new_rule : Function called as new_rule(tile) (see GridTile), possibly
+//                 on several threads at once
+template <typename CellT>
+void BasicCellularAutomata<CellT>::add_tile_rule(const TileRule &new_rule)
+{
+    RegisteredRule registered;
+    registered.tile = new_rule;
+    rules.push_back(registered);
+}
+
+// Function to remove every rule added with add_rule or add_tile_rule
+template <typename CellT>
+void BasicCellularAutomata<CellT>::clear_rules()
+{
+    rules.clear();
+}
+
+// Getter method to get the number of rules run by step_rules()
+template <typename CellT>
+int BasicCellularAutomata<CellT>::get_num_rules() const
+{
+    return static_cast<int>(rules.size());
+}
+
+// Kernel that advances the grid by one generation of a rule
+// Every combination of dimension, neighborhood, boundary type and rule is its
+// own instantiation, so the loops below never test the configuration; the
+// compute functions and step() select the instantiation once.
+// Straight Conditional: a cell in state k becomes k'
+// Conditional Transition: a cell in state k becomes k' if any neighbor is in state k'
+// Majority Rule: a cell in state k becomes k' if the sum of its neighbors reaches
+// the threshold (1 in 1D, 2 for Von Neumann and 5 for Moore in 2D)
+// Periodic Boundaries: the grid wraps around, as if it were a ring (1D) or a torus (2D)
+// Fixed Boundaries: the out-of-bound neighbors of edge cells have a fixed state (k)
+// No Boundaries: the out-of-bound neighbors of edge cells repeat the nearest edge cell
+// (so orthogonal out-of-bound neighbors have the same state as the current cell)
+// Note: Von Neumann and Moore are the same in 1D space (left/right neighbors)
+// The grid is processed in tiles; with active regions enabled, tiles that
+// cannot change (see set_active_regions) are skipped.
+// Inputs:
+//      k : State k used by the rule
+//      kprime : State k' used by the rule
+template <typename CellT>
+template <DimensionType D, NeighborhoodType N, BoundaryType B, RuleType R>
+void BasicCellularAutomata<CellT>::step_generation(int k, int kprime)
+{
+    const CellT k_state = static_cast<CellT>(k);
+    const CellT kprime_state = static_cast<CellT>(kprime);
+    const int active_rows = (D == ONE_DIMENSIONAL) ? std::min(rows, 1) : rows;
+    const StepFunction self = &BasicCellularAutomata::step_generation<D, N, B, R>;
+
+    // Cells are counted as they are written when statistics are collected
+    StateHistogram histogram(collect_statistics ? table_size : 0);
+    const int bins = table_size;
+    const bool tracked = prepare_tiles(self, k, kprime, B == PERIODIC, D == ONE_DIMENSIONAL);
+
+    const RowKernels<CellT> &kernels = select_row_kernels<CellT>(vectorize);
+    RowKernel<CellT> row_kernel = (R == CONDITIONAL_TRANSITION) ? kernels.conditional[N] : kernels.majority[N];
+    LineKernel<CellT> line_kernel = (R == CONDITIONAL_TRANSITION) ? kernels.conditional_1d : kernels.majority_1d;
+
+    // The neighbor rules read the ghost cells, filled once for this generation
+    if (R != STRAIGHT_CONDITIONAL)
+    {
+        fill_halo<B>(k);
+    }
+
+    // Computes the cells [j, j + width) of row i and reports whether any changed
+    auto compute_segment = [&](int i, int j, int width) -> bool {
+        if (R == STRAIGHT_CONDITIONAL)
+        {
+            // Directly apply rule based on current state (in place, no neighbors needed)
+            CellT *row = &cells[cell_index(i, j)];
+            bool found = false;
+            for (int c = 0; c < width; ++c)
+            {
+                bool hit = row[c] == k_state;
+                found = found || hit;
+                row[c] = hit ? kprime_state : row[c]; // Change state: k -> k'
+            }
+            return found && k_state != kprime_state;
+        }
+
+        const CellT *row = &cells[cell_index(i, j)];
+        CellT *next_row = &next_cells[cell_index(i, j)];
+        if (D == ONE_DIMENSIONAL)
+            line_kernel(row, next_row, width, k_state, kprime_state);
+        else
+            row_kernel(row, stride, next_row, width, k_state, kprime_state);
+        return tracked && std::memcmp(row, next_row, width * sizeof(CellT)) != 0;
+    };
+
+    // Buffer holding the new cells (the rule applies in place for Straight Conditional)
+    std::vector<CellT> &written = (R == STRAIGHT_CONDITIONAL) ? cells : next_cells;
+
+    // Bands are runs of consecutive tiles (in row-major tile order)
+    const int num_tiles = active_rows > 0 ? tiles_down * tiles_across : 0;
+    for_each_band(0, num_tiles, static_cast<long long>(tile_height) * tile_width, [&](int begin, int end) {
+        std::vector<uint64_t> band_counts(histogram.get_num_states());
+        for (int tile = begin; tile < end; ++tile)
+        {
+            if (!tile_active[tile])
+            {
+                tile_changed[tile] = 0;
+                continue;
+            }
+
+            int first_row = (tile / tiles_across) * tile_height;
+            int last_row = std::min(active_rows, first_row + tile_height);
+            int first_col = (tile % tiles_across) * tile_width;
+            int width = std::min(cols, first_col + tile_width) - first_col;
+            bool changed = false;
+            for (int i = first_row; i < last_row; ++i)
+            {
+                changed = compute_segment(i, first_col, width) || changed;
+            }
+            tile_changed[tile] = changed;
+
+            // Tracked runs keep the counts of every tile, since skipped tiles are not revisited
+            if (histogram.get_num_states() > 0)
+            {
+                uint32_t *counts = tracked ? &tile_counts[static_cast<size_t>(tile) * bins] : nullptr;
+                if (counts)
+                {
+                    std::fill(counts, counts + bins, 0);
+                }
+                for (int i = first_row; i < last_row; ++i)
+                {
+                    if (counts)
+                        count_states(&written[cell_index(i, first_col)], width, counts, bins);
+                    else
+                        count_states(&written[cell_index(i, first_col)], width, band_counts.data(), bins);
+                }
+            }
+        }
+        histogram.merge(band_counts);
+    });
+
+    if (R != STRAIGHT_CONDITIONAL && active_rows > 0)
+    {
+        if (D == ONE_DIMENSIONAL)
+        {
+            // Only the line changes in 1D, so exchange it with the back buffer
+            std::swap_ranges(&next_cells[cell_index(0, 0)], &next_cells[cell_index(0, 0)] + cols,
+                             &cells[cell_index(0, 0)]);
+        }
+        else
+        {
+            // Current Grid -> Updated Grid
+            swap_buffers();
+        }
+    }
+    halo_valid = false;
+    ++generation;
+    finish_tiles(self, k, kprime, tracked, histogram);
+    record_statistics(histogram);
+}
+
+// Kernel that advances the grid by one generation of a rule with a neighborhood
+// radius larger than 1
+// The neighbors of a cell are all cells of the window around it: the
+// (2r + 1) x (2r + 1) square for Moore, the diamond |di| + |dj| <= r for Von
+// Neumann and the 2r cells around it in 1D. Window sums are computed with
+// sliding prefix sums (CA_window.h), so the cost per cell does not grow with r.
+// Conditional Transition: a cell in state k becomes k' if any neighbor is in state k'
+// Majority Rule: a cell in state k becomes k' if the sum of its n neighbors reaches
+// n / 2 (Von Neumann and 1D) or n / 2 + 1 (Moore), as for radius 1
+// Inputs:
+//      k : State k used by the rule
+//      kprime : State k' used by the rule
+template <typename CellT>
+template <DimensionType D, NeighborhoodType N, BoundaryType B, RuleType R>
+void BasicCellularAutomata<CellT>::step_generation_radius(int k, int kprime)
+{
+    const int radius = neighborhood_radius;
+    const long long neighbors = (D == ONE_DIMENSIONAL) ? 2LL * radius
+                                : (N == MOORE)         ? (2LL * radius + 1) * (2LL * radius + 1) - 1
+                                                       : 2LL * radius * (radius + 1);
+    const long long threshold = (D == TWO_DIMENSIONAL && N == MOORE) ? neighbors / 2 + 1 : neighbors / 2;
+
+    // Conditional Transition counts the cells in state k', Majority Rule sums the states
+    const int match = (R == CONDITIONAL_TRANSITION) ? kprime : -1;
+    const CellT k_state = static_cast<CellT>(k);
+    const CellT kprime_state = static_cast<CellT>(kprime);
+
+    // New state of a cell from the sum over its window (which includes the cell itself)
+    auto apply_rule = [&](CellT current_state, int window_sum) -> CellT {
+        bool condition_met = (R == CONDITIONAL_TRANSITION) ? window_sum > 0
+                                                           : window_sum - current_state >= threshold;
+        return (current_state == k_state && condition_met) ? kprime_state : current_state;
+    };
+
+    // Cells are counted as they are written when statistics are collected
+    StateHistogram histogram(collect_statistics ? table_size : 0);
+
+    // Fill the ghost cells once for this generation
+    fill_halo<B>(k);
+
+    if (D == ONE_DIMENSIONAL)
+    {
+        if (rows > 0)
+        {
+            const CellT *line = &cells[cell_index(0, 0)];
+            CellT *next_line = &next_cells[cell_index(0, 0)];
+            for_each_band(0, cols, 1, [&](int begin, int end) {
+                static thread_local std::vector<int> sums;
+                sums.resize(end - begin);
+                line_window_sums(line, begin, end, radius, match, sums.data());
+                for (int j = begin; j < end; ++j)
+                {
+                    next_line[j] = apply_rule(line[j], sums[j - begin]);
+                }
+                std::vector<uint64_t> band_counts(histogram.get_num_states());
+                count_states(next_line + begin, end - begin, band_counts);
+                histogram.merge(band_counts);
+            });
+
+            // Only the line changes in 1D, so exchange it with the back buffer
+            std::swap_ranges(next_line, next_line + cols, &cells[cell_index(0, 0)]);
+        }
+        halo_valid = false;
+    }
+    else
+    {
+        const CellT *origin = &cells[cell_index(0, 0)];
+        for_each_band(0, rows, cols, [&](int begin, int end) {
+            static thread_local std::vector<int> sums;
+            sums.resize(static_cast<size_t>(end - begin) * cols);
+            if (N == MOORE)
+                moore_window_sums(origin, stride, begin, end, cols, radius, match, sums.data());
+            else
+                von_neumann_window_sums(origin, stride, begin, end, cols, radius, match, sums.data());
+
+            std::vector<uint64_t> band_counts(histogram.get_num_states());
+            for (int i = begin; i < end; ++i)
+            {
+                const CellT *row = &cells[cell_index(i, 0)];
+                CellT *next_row = &next_cells[cell_index(i, 0)];
+                const int *row_sums = &sums[static_cast<size_t>(i - begin) * cols];
+                for (int j = 0; j < cols; ++j)
+                {
+                    next_row[j] = apply_rule(row[j], row_sums[j]);
+                }
+                count_states(next_row, cols, band_counts);
+            }
+            histogram.merge(band_counts);
+        });
+
+        // Current Grid -> Updated Grid
+        swap_buffers();
+    }
+    tiles_valid = false; // every cell is recomputed, without tracking
+    ++generation;
+    record_statistics(histogram);
+}
+
+// Helper functions that map a configuration chosen at runtime to its kernel
+template <typename CellT>
+template <DimensionType D, NeighborhoodType N, BoundaryType B>
+typename BasicCellularAutomata<CellT>::StepFunction BasicCellularAutomata<CellT>::select_rule_kernel(RuleType rule,
+                                                                                                     bool wide)
+{
+    switch (rule)
+    {
+    case STRAIGHT_CONDITIONAL:
+        return &BasicCellularAutomata::step_generation<D, N, B, STRAIGHT_CONDITIONAL>;
+    case CONDITIONAL_TRANSITION:
+        return wide ? &BasicCellularAutomata::step_generation_radius<D, N, B, CONDITIONAL_TRANSITION>
+                    : &BasicCellularAutomata::step_generation<D, N, B, CONDITIONAL_TRANSITION>;
+    default:
+        return wide ? &BasicCellularAutomata::step_generation_radius<D, N, B, MAJORITY_RULE>
+                    : &BasicCellularAutomata::step_generation<D, N, B, MAJORITY_RULE>;
+    }
+}
+
+template <typename CellT>
+template <DimensionType D, NeighborhoodType N>
+typename BasicCellularAutomata<CellT>::StepFunction
+BasicCellularAutomata<CellT>::select_boundary_kernel(BoundaryType boundaries, RuleType rule, bool wide)
+{
+    switch (boundaries)
+    {
+    case PERIODIC:
+        return select_rule_kernel<D, N, PERIODIC>(rule, wide);
+    case FIXED:
+        return select_rule_kernel<D, N, FIXED>(rule, wide);
+    default:
+        return select_rule_kernel<D, N, NO_BOUNDARIES>(rule, wide);
+    }
+}
+
+// Function that returns the kernel for a configuration
+// Inputs:
+//      dimensions, neighborhood, boundaries, rule : The configuration
+//      radius : Radius of the neighborhood
+// Returns:
+//      Pointer to the kernel instantiated for the configuration
+template <typename CellT>
+typename BasicCellularAutomata<CellT>::StepFunction
+BasicCellularAutomata<CellT>::select_kernel(DimensionType dimensions, NeighborhoodType neighborhood,
+                                            BoundaryType boundaries, RuleType rule, int radius)
+{
+    bool wide = radius > 1;
+    if (dimensions == ONE_DIMENSIONAL)
+    {
+        // Neighborhoods are the same in 1D
+        return select_boundary_kernel<ONE_DIMENSIONAL, VON_NEUMANN>(boundaries, rule, wide);
+    }
+    if (neighborhood == MOORE)
+    {
+        return select_boundary_kernel<TWO_DIMENSIONAL, MOORE>(boundaries, rule, wide);
+    }
+    return select_boundary_kernel<TWO_DIMENSIONAL, VON_NEUMANN>(boundaries, rule, wide);
+}
+
+// Helper function that selects the kernel of the configured model
+// Called whenever the dimension, neighborhood, boundary, rule type or radius changes.
+template <typename CellT>
+void BasicCellularAutomata<CellT>::configure_step()
+{
+    step_function = select_kernel(dimensions, neighborhood, boundaries, rule, neighborhood_radius);
+}
+
+// Step function to advance the CA model by one generation of the configured rule
+// Uses the states k and k' set with set_k and set_kprime. The kernel for the
+// configuration was selected when the model was configured.
+template <typename CellT>
+void BasicCellularAutomata<CellT>::step()
+{
+    CA_PROBE("step");
+    (this->*step_function)(k, kprime);
+}
+
+// Step function to advance the CA model by several generations of the configured rule
+// The generations are computed by the engine chosen with set_engine when it
+// supports the configuration, and by the compute functions otherwise; the
+// neighbor rules on 2D grids then advance several generations per pass of
+// the grid (see set_temporal_blocking).
+// Inputs:
+//      generations : Number of generations
+template <typename CellT>
+void BasicCellularAutomata<CellT>::step(uint64_t generations)
+{
+    CA_PROBE("step(generations)");
+    if (generations == 0)
+    {
+        return;
+    }
+    EngineType active = get_active_engine();
+    if (active == MEMOISED_ENGINE)
+    {
+        step_memoised(generations);
+        return;
+    }
+    if (active == BITSLICED_ENGINE && step_bitsliced(generations))
+    {
+        return;
+    }
+
+    // Neighbor rules on 2D grids advance several generations per pass of the grid
+    if (time_block > 1 && generations > 1 && dimensions == TWO_DIMENSIONAL && neighborhood_radius == 1 &&
+        rule != STRAIGHT_CONDITIONAL && rows > 0 && cols > 0)
+    {
+        const RowKernels<CellT> &kernels = select_row_kernels<CellT>(vectorize);
+        RowKernel<CellT> row_kernel = (rule == CONDITIONAL_TRANSITION) ? kernels.conditional[neighborhood]
+                                                                         : kernels.majority[neighborhood];
+        const CellT k_state = static_cast<CellT>(k);
+        const CellT kprime_state = static_cast<CellT>(kprime);
+        step_blocked(generations, boundaries,
+                     [&](const CellT *row, ptrdiff_t row_stride, CellT *next_row, int, int, int width, uint64_t) {
+                         row_kernel(row, row_stride, next_row, width, k_state, kprime_state);
+                     });
+        return;
+    }
+
+    for (uint64_t g = 0; g < generations; ++g)
+    {
+        step();
+        CA_PROBE_GENERATIONS(nullptr);
+    }
+}
+
+// Helper function that advances the CA model with the memoised engine
+// The generations in between are never stored, so only the last one is added
+// to the statistics.
+// Inputs:
+//      generations : Number of generations
+template <typename CellT>
+void BasicCellularAutomata<CellT>::step_memoised(uint64_t generations)
+{
+    // Copies of a model get their own nodes (the engine is not thread safe)
+    if (!memoised || memoised.use_count() > 1)
+    {
+        memoised = std::make_shared<HashlifeEngine>();
+    }
+    memoised->configure(dimensions, neighborhood, rule, k, kprime);
+
+    // A grid whose sides differ is repeated along the shorter side; the
+    // square is still periodic and every copy evolves the same way
+    bool line = dimensions == ONE_DIMENSIONAL;
+    int side = line ? cols : std::max(rows, cols);
+    int square_rows = line ? 1 : side;
+    std::vector<int> square(static_cast<size_t>(square_rows) * side);
+    for (int i = 0; i < square_rows; ++i)
+    {
+        const CellT *row = &cells[cell_index(i % rows, 0)];
+        for (int j = 0; j < side; ++j)
+        {
+            square[static_cast<size_t>(i) * side + j] = row[j % cols];
+        }
+    }
+
+    memoised->load(square, side);
+    memoised->advance(generations);
+    memoised->store(square);
 
-    for (int i = 0; i < rows; ++i)
+    int active_rows = line ? 1 : rows;
+    for (int i = 0; i < active_rows; ++i)
     {
+        CellT *row = &cells[cell_index(i, 0)];
         for (int j = 0; j < cols; ++j)
         {
-            int north_state = grid[(i - 1 + rows) % rows][j];
-            int south_state = grid[(i + 1) % rows][j];
-            int east_state = grid[i][(j + 1) % cols];
-            int west_state = grid[i][(j - 1 + cols) % cols];
-
-            // Call determine_genotype for each neighbor pair and decide the new state
-            // This is a simplification where we just take an average of the neighbors' influence
-            int sum_states = determine_genotype(north_state, south_state) + determine_genotype(east_state, west_state);
-            int new_state = round(static_cast<double>(sum_states) / 2.0);
+            row[j] = static_cast<CellT>(square[static_cast<size_t>(i) * side + j]);
+        }
+    }
+    generation += generations;
+    halo_valid = false;
+    tiles_valid = false;
+    if (collect_statistics)
+    {
+        record_statistics();
+    }
+}
 
-            temp_grid[i][j] = new_state;
+// Helper function that advances the CA model with the bit-sliced engine
+// The grid is converted to two bit-planes once, every generation is computed
+// (and counted for the statistics) on the planes, and the grid is converted
+// back at the end.
+// Inputs:
+//      generations : Number of generations
+// Returns:
+//      False if a cell is in a state above 3 (nothing was computed)
+template <typename CellT>
+bool BasicCellularAutomata<CellT>::step_bitsliced(uint64_t generations)
+{
+    const bool line = dimensions == ONE_DIMENSIONAL;
+    const int active_rows = line ? 1 : rows;
+    BitSlicedGrid bits;
+    bits.resize(active_rows, cols);
+    for (int i = 0; i < active_rows; ++i)
+    {
+        if (!bits.load_row(i, &cells[cell_index(i, 0)]))
+        {
+            return false;
         }
     }
 
-    grid.swap(temp_grid); // Efficient way to update the main grid
+    // Changed cells of every generation, counted on the planes for the instrumentation
+    const bool count_changes = probing_generations();
+    std::vector<uint64_t> changed(1);
+    std::mutex changed_lock;
+
+    for (uint64_t g = 0; g < generations; ++g)
+    {
+        bits.fill_ghosts(boundaries, k, line);
+        StateHistogram histogram(collect_statistics ? table_size : 0);
+        changed[0] = 0;
+        for_each_band(0, active_rows, cols, [&](int begin, int end) {
+            bits.step_rows(begin, end, dimensions, neighborhood, rule, k, kprime, vectorize);
+            if (histogram.get_num_states() > 0)
+            {
+                std::vector<uint64_t> band_counts(histogram.get_num_states());
+                bits.count_rows(begin, end, band_counts);
+                histogram.merge(band_counts);
+            }
+            if (count_changes)
+            {
+                uint64_t band_changed = bits.count_changed_rows(begin, end);
+                std::lock_guard<std::mutex> lock(changed_lock);
+                changed[0] += band_changed;
+            }
+        });
+        bits.swap();
+        ++generation;
+        record_statistics(histogram);
+        CA_PROBE_GENERATIONS(&changed);
+    }
+
+    for (int i = 0; i < active_rows; ++i)
+    {
+        bits.store_row(i, &cells[cell_index(i, 0)]);
+    }
+    halo_valid = false;
+    tiles_valid = false;
+    return true;
 }
 
-// This function is a specific rules function for our allele model of which
-// we were told to just include in the CA general purpose library.
-int CellularAutomata::determine_genotype(int cell_state1, int cell_state2)
+// Helper function that advances the grid by several generations with temporal blocking
+// The grid is cut into tiles. Each tile is copied with depth extra cells on
+// every side into a small buffer that stays in cache, and advanced depth
+// generations there: every generation the region that can still be computed
+// shrinks by one cell on each side, so after depth generations the cells of
+// the tile are exact. The grid is then read and written once every depth
+// generations instead of once per generation. Tiles only read the current
+// grid, so they run in parallel.
+// Inputs:
+//      generations : Number of generations
+//      edges : Boundary type of the rows and columns of the grid
+//      row_step : Function computing a segment of a row
+//                 (row, stride, next row, grid row, grid column, width, generation)
+template <typename CellT>
+template <typename RowStep>
+void BasicCellularAutomata<CellT>::step_blocked(uint64_t generations, BoundaryType edges, const RowStep &row_step)
 {
-    // HomozygousDominant = 1, Heterozygous = 2, Recessive = 3
+    const CellT fixed_state = static_cast<CellT>(k);
+    const bool count_changes = probing_generations();
+    auto wrap = [](int index, int size) { return ((index % size) + size) % size; };
 
-    // If both cells are Homozygous Dominant (1)
-    if (cell_state1 == 1 && cell_state2 == 1)
+    while (generations > 0)
     {
-        return 1; // Still Homozygous Dominant
+        const int depth = static_cast<int>(std::min<uint64_t>(generations, time_block));
+
+        // Tiles are wide enough to stream rows and tall enough that the rows
+        // computed twice by neighboring tiles stay a small share of the work
+        const int tile_cols = std::min(cols, std::max(16 * depth, static_cast<int>(TIME_BLOCK_ROW_BYTES / sizeof(CellT))));
+        const ptrdiff_t local_stride = tile_cols + 2 * depth + 2;
+        const int rows_in_cache = static_cast<int>(TIME_BLOCK_BYTES / (2 * local_stride * sizeof(CellT)));
+        const int tile_rows = std::min(rows, std::max(16 * depth, rows_in_cache - 2 * depth));
+        const int tiles_per_row = (cols + tile_cols - 1) / tile_cols;
+        const int num_blocks = ((rows + tile_rows - 1) / tile_rows) * tiles_per_row;
+
+        // One histogram per generation of the block
+        std::vector<std::unique_ptr<StateHistogram>> histograms;
+        for (int t = 0; t < depth; ++t)
+        {
+            histograms.emplace_back(new StateHistogram(collect_statistics ? table_size : 0));
+        }
+
+        // Changed cells of every generation of the block, for the instrumentation
+        std::vector<uint64_t> changed(count_changes ? depth : 0);
+        std::mutex changed_lock;
+
+        const long long cells_per_block = static_cast<long long>(tile_rows) * tile_cols * depth;
+        for_each_band(0, num_blocks, cells_per_block, [&](int first, int last) {
+            std::vector<CellT> current, next;
+            std::vector<uint64_t> band_counts;
+            std::vector<uint64_t> band_changed(changed.size());
+            for (int block = first; block < last; ++block)
+            {
+                const int lo = (block / tiles_per_row) * tile_rows;
+                const int hi = std::min(rows, lo + tile_rows);
+                const int col_lo = (block % tiles_per_row) * tile_cols;
+                const int col_hi = std::min(cols, col_lo + tile_cols);
+
+                // Region copied: depth cells around the tile, except beyond the
+                // edges of a grid without periodic boundaries
+                const bool top_edge = edges != PERIODIC && lo - depth <= 0;
+                const bool bottom_edge = edges != PERIODIC && hi + depth >= rows;
+                const bool left_edge = edges != PERIODIC && col_lo - depth <= 0;
+                const bool right_edge = edges != PERIODIC && col_hi + depth >= cols;
+                const int ext_lo = top_edge ? 0 : lo - depth;
+                const int ext_hi = bottom_edge ? rows : hi + depth;
+                const int ext_col_lo = left_edge ? 0 : col_lo - depth;
+                const int ext_col_hi = right_edge ? cols : col_hi + depth;
+                const int width = ext_col_hi - ext_col_lo;
+
+                // Buffer rows: a ghost row, rows ext_lo to ext_hi - 1, a ghost row;
+                // each with a ghost cell on both sides
+                current.resize(static_cast<size_t>(ext_hi - ext_lo + 2) * local_stride);
+                next.resize(current.size());
+                auto local = [&](std::vector<CellT> &buffer, int g, int j) {
+                    return &buffer[(g - ext_lo + 1) * local_stride + 1 + (j - ext_col_lo)];
+                };
+
+                for (int g = ext_lo; g < ext_hi; ++g)
+                {
+                    // Columns past the edges wrap around (periodic boundaries only)
+                    const CellT *source = &cells[cell_index(wrap(g, rows), 0)];
+                    CellT *target = local(current, g, ext_col_lo);
+                    for (int j = ext_col_lo; j < ext_col_hi;)
+                    {
+                        int grid_col = wrap(j, cols);
+                        int count = std::min(ext_col_hi - j, cols - grid_col);
+                        target = std::copy_n(source + grid_col, count, target);
+                        j += count;
+                    }
+                }
+
+                for (int t = 1; t <= depth; ++t)
+                {
+                    // Ghost cells at the edges of the grid follow the current generation
+                    if (left_edge || right_edge)
+                    {
+                        for (int g = ext_lo; g < ext_hi; ++g)
+                        {
+                            if (left_edge)
+                            {
+                                CellT *edge = local(current, g, 0);
+                                edge[-1] = (edges == FIXED) ? fixed_state : edge[0];
+                            }
+                            if (right_edge)
+                            {
+                                CellT *edge = local(current, g, cols - 1);
+                                edge[1] = (edges == FIXED) ? fixed_state : edge[0];
+                            }
+                        }
+                    }
+                    if (top_edge)
+                    {
+                        CellT *ghost = local(current, -1, ext_col_lo) - 1;
+                        if (edges == FIXED)
+                            std::fill(ghost, ghost + width + 2, fixed_state);
+                        else
+                            std::copy_n(local(current, 0, ext_col_lo) - 1, width + 2, ghost);
+                    }
+                    if (bottom_edge)
+                    {
+                        CellT *ghost = local(current, rows, ext_col_lo) - 1;
+                        if (edges == FIXED)
+                            std::fill(ghost, ghost + width + 2, fixed_state);
+                        else
+                            std::copy_n(local(current, rows - 1, ext_col_lo) - 1, width + 2, ghost);
+                    }
+
+                    const int first_row = top_edge ? 0 : ext_lo + t;
+                    const int last_row = bottom_edge ? rows : ext_hi - t;
+                    const int first_col = left_edge ? 0 : ext_col_lo + t;
+                    const int last_col = right_edge ? cols : ext_col_hi - t;
+                    for (int g = first_row; g < last_row; ++g)
+                    {
+                        row_step(local(current, g, first_col), local_stride, local(next, g, first_col), wrap(g, rows),
+                                 wrap(first_col, cols), last_col - first_col, generation + t - 1);
+                    }
+
+                    StateHistogram &histogram = *histograms[t - 1];
+                    if (histogram.get_num_states() > 0)
+                    {
+                        band_counts.assign(histogram.get_num_states(), 0);
+                        for (int g = lo; g < hi; ++g)
+                        {
+                            count_states(local(next, g, col_lo), col_hi - col_lo, band_counts);
+                        }
+                        histogram.merge(band_counts);
+                    }
+                    if (count_changes)
+                    {
+                        for (int g = lo; g < hi; ++g)
+                        {
+                            const CellT *before = local(current, g, col_lo);
+                            const CellT *after = local(next, g, col_lo);
+                            for (int j = 0; j < col_hi - col_lo; ++j)
+                            {
+                                band_changed[t - 1] += before[j] != after[j];
+                            }
+                        }
+                    }
+                    current.swap(next);
+                }
+
+                for (int g = lo; g < hi; ++g)
+                {
+                    std::copy_n(local(current, g, col_lo), col_hi - col_lo, &next_cells[cell_index(g, col_lo)]);
+                }
+            }
+            if (count_changes)
+            {
+                std::lock_guard<std::mutex> lock(changed_lock);
+                for (size_t t = 0; t < changed.size(); ++t)
+                {
+                    changed[t] += band_changed[t];
+                }
+            }
+        });
+
+        swap_buffers();
+        tiles_valid = false;
+        for (int t = 0; t < depth; ++t)
+        {
+            ++generation;
+            record_statistics(*histograms[t]);
+        }
+        CA_PROBE_GENERATIONS(&changed);
+        generations -= depth;
     }
-    // If both cells are Recessive (3)
-    else if (cell_state1 == 3 && cell_state2 == 3)
+}
+
+// Helper function that runs a tile rule over the grid once
+// The halo is filled from the configured boundaries (fixed ghost cells are in
+// state k), the rule writes the back buffer and the buffers are swapped.
+// Inputs:
+//      rule : The tile rule
+//      histogram : Histogram the new cells are counted in (nullptr for none)
+//      parallel : If false, the rule is called once for the whole grid on the calling thread
+template <typename CellT>
+void BasicCellularAutomata<CellT>::run_tile_pass(const TileRule &rule, StateHistogram *histogram, bool parallel)
+{
+    if (rows <= 0 || cols <= 0)
     {
-        return 3; // Still Recessive
+        return;
     }
-    // If one cell is Homozygous Dominant (1) and the other is Recessive (3)
-    else if ((cell_state1 == 1 && cell_state2 == 3) || (cell_state1 == 3 && cell_state2 == 1))
+    fill_halo(boundaries, k);
+    tiles_valid = false;
+
+    auto make_tile = [&](int begin, int end) {
+        GridTile<CellT> tile;
+        tile.in = &cells[cell_index(begin, 0)];
+        tile.out = &next_cells[cell_index(begin, 0)];
+        tile.stride = stride;
+        tile.row_begin = begin;
+        tile.row_end = end;
+        tile.cols = cols;
+        tile.halo = halo;
+        tile.generation = generation;
+        tile.rng = &rng;
+        return tile;
+    };
+
+    if (dimensions == ONE_DIMENSIONAL)
     {
-        return 2; // Heterozygous
+        // Only the line changes in 1D, so exchange it with the back buffer
+        rule(make_tile(0, 1));
+        if (histogram)
+        {
+            std::vector<uint64_t> band_counts(histogram->get_num_states());
+            count_states(&next_cells[cell_index(0, 0)], cols, band_counts);
+            histogram->merge(band_counts);
+        }
+        std::swap_ranges(&next_cells[cell_index(0, 0)], &next_cells[cell_index(0, 0)] + cols, &cells[cell_index(0, 0)]);
+        halo_valid = false;
     }
-    // If both cells are Heterozygous (2)
-    else if (cell_state1 == 2 && cell_state2 == 2)
+    else
     {
-        // Random decision for offspring genotype
-        double rand_value = static_cast<double>(rand()) / RAND_MAX;
+        auto run_band = [&](int begin, int end) {
+            rule(make_tile(begin, end));
+            if (histogram)
+            {
+                std::vector<uint64_t> band_counts(histogram->get_num_states());
+                for (int i = begin; i < end; ++i)
+                {
+                    count_states(&next_cells[cell_index(i, 0)], cols, band_counts);
+                }
+                histogram->merge(band_counts);
+            }
+        };
+        if (parallel)
+            for_each_band(0, rows, cols, run_band);
+        else
+            run_band(0, rows);
+
+        // Current Grid -> Updated Grid
+        swap_buffers();
+    }
+}
 
-        // 50% chance offspring will be heterozygous
-        if (rand_value < 0.5)
+// Function that advances the CA model by one generation of a tile rule
+// Inputs:
+//      rule : Function called as rule(tile) for blocks of rows, possibly on
+//             several threads at once
+template <typename CellT>
+void BasicCellularAutomata<CellT>::apply_tile_rule(const TileRule &rule)
+{
+    StateHistogram histogram(collect_statistics ? table_size : 0);
+    run_tile_pass(rule, collect_statistics ? &histogram : nullptr, true);
+    ++generation;
+    record_statistics(histogram);
+}
+
+// Function that advances the CA model by one generation of the added rules
+// Every rule sees the grid produced by the rule before it. Nothing happens
+// (not even a new generation) if no rule was added.
+template <typename CellT>
+void BasicCellularAutomata<CellT>::step_rules()
+{
+    if (rules.empty())
+    {
+        return;
+    }
+    CA_PROBE("step_rules");
+    // Only the cells written by the last rule are counted
+    StateHistogram histogram(collect_statistics ? table_size : 0);
+    for (size_t r = 0; r < rules.size(); ++r)
+    {
+        const RegisteredRule &registered = rules[r];
+        StateHistogram *counted = (collect_statistics && r + 1 == rules.size()) ? &histogram : nullptr;
+        if (registered.tile)
         {
-            return 2; // Heterozygous
+            run_tile_pass(registered.tile, counted, true);
+            continue;
         }
-        // 25% chance offspring will be homozygous dominant
-        else if (rand_value < 0.75)
+
+        // Per-cell rules read the grid view, which is built once per rule. They
+        // run on the calling thread, so rules that keep state need no locking.
+        const std::vector<std::vector<int>> &view = get_grid();
+        const RuleFunction &cell_rule = registered.cell;
+        run_tile_pass([&](const GridTile<CellT> &tile) {
+            for (int i = tile.row_begin; i < tile.row_end; ++i)
+            {
+                CellT *out = tile.out_row(i);
+                for (int j = 0; j < tile.cols; ++j)
+                {
+                    out[j] = static_cast<CellT>(cell_rule(view, i, j));
+                }
+            }
+        }, counted, false);
+    }
+    ++generation;
+    record_statistics(histogram);
+}
+
+// Compute function for 1-Dimension/Rule 1
+// Updates grid based on Straight Conditional
+template <typename CellT>
+void BasicCellularAutomata<CellT>::onedim_rule1(int k, int kprime)
+{
+    CA_PROBE("onedim_rule1");
+    if (dimensions == ONE_DIMENSIONAL && rule == STRAIGHT_CONDITIONAL)
+    {
+        step_generation<ONE_DIMENSIONAL, VON_NEUMANN, PERIODIC, STRAIGHT_CONDITIONAL>(k, kprime);
+    }
+}
+
+// Compute function for 1-Dimension/Rule 2
+// Updates grid based on Conditional Transition
+// Note: Von Neumann and Moore are the same in 1D space (left/right neighbors)
+// For fixed boundaries, edge cells see a fixed state (k) beyond the edge
+// For no boundaries, edge cells see their own state beyond the edge
+template <typename CellT>
+void BasicCellularAutomata<CellT>::onedim_rule2(int k, int kprime)
+{
+    CA_PROBE("onedim_rule2");
+    (this->*select_kernel(ONE_DIMENSIONAL, neighborhood, boundaries, CONDITIONAL_TRANSITION, neighborhood_radius))(k, kprime);
+}
+
+// Compute function for 1-Dimension/Rule 3
+// Updates grid based on Majority Rule
+// Note: Von Neumann and Moore are the same in 1D space (left/right neighbors)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::onedim_rule3(int k, int kprime)
+{
+    CA_PROBE("onedim_rule3");
+    (this->*select_kernel(ONE_DIMENSIONAL, neighborhood, boundaries, MAJORITY_RULE, neighborhood_radius))(k, kprime);
+}
+
+// Compute function for 2-Dimension/Rule 1
+// Updates grid based on Straight Conditional
+template <typename CellT>
+void BasicCellularAutomata<CellT>::twodim_rule1(int k, int kprime)
+{
+    CA_PROBE("twodim_rule1");
+    if (dimensions == TWO_DIMENSIONAL && rule == STRAIGHT_CONDITIONAL)
+    {
+        step_generation<TWO_DIMENSIONAL, VON_NEUMANN, PERIODIC, STRAIGHT_CONDITIONAL>(k, kprime);
+    }
+}
+
+// Compute function for 2-Dimension/Rule 2
+// Updates grid based on Conditional Transition
+// Periodic Boundaries: The grid wraps around, and the neighbors of edge cells are calculated as if the grid is a torus
+// Fixed Boundaries: The out-of-bound neighbors of edge cells have a predefined state (k)
+// No Boundaries: The out-of-bound neighbors of edge cells repeat the nearest edge cell
+// (so orthogonal out-of-bound neighbors have the same state as the current cell)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::twodim_rule2(int k, int kprime)
+{
+    CA_PROBE("twodim_rule2");
+    (this->*select_kernel(TWO_DIMENSIONAL, neighborhood, boundaries, CONDITIONAL_TRANSITION, neighborhood_radius))(k, kprime);
+}
+
+// Compute function for 2-Dimension/Rule 3
+// Updates grid based on Majority Rule
+// For periodic boundaries, the grid wraps around
+// For fixed boundaries, edge cells assume a fixed state (k)
+// For no boundaries, edge cells are treated as having the same state as the cell itself
+template <typename CellT>
+void BasicCellularAutomata<CellT>::twodim_rule3(int k, int kprime)
+{
+    CA_PROBE("twodim_rule3");
+    (this->*select_kernel(TWO_DIMENSIONAL, neighborhood, boundaries, MAJORITY_RULE, neighborhood_radius))(k, kprime);
+}
+
+// Helper function that computes a segment of a row of the allele model
+// Inputs:
+//      row : First cell of the segment, with the north and south rows at -row_stride and +row_stride
+//      row_stride : Distance between two rows
+//      next_row : First cell of the segment in the next generation
+//      i, j : Row and column of the first cell in the grid (key the random draws)
+//      width : Number of cells in the segment (columns past the last one wrap around)
+//      current_generation : Generation being computed (keys the random draws)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::update_row(const CellT *row, ptrdiff_t row_stride, CellT *next_row, int i, int j,
+                                              int width, uint64_t current_generation) const
+{
+    const CellT *crosses = genotype_table.data();
+    const CellT *averages = average_table.data();
+    const int size = table_size;
+
+    int col = j;
+    for (int c = 0; c < width; ++c)
+    {
+        int north_state = table_state(row[c - row_stride]);
+        int south_state = table_state(row[c + row_stride]);
+        int east_state = table_state(row[c + 1]);
+        int west_state = table_state(row[c - 1]);
+
+        // One draw per cell gives the random bits of both neighbor pairs
+        uint32_t random_bits[4];
+        rng.draw4(current_generation, static_cast<uint64_t>(i) * cols + col, STREAM_UPDATE, random_bits);
+        col = (col + 1 == cols) ? 0 : col + 1;
+
+        // Look up the offspring of each neighbor pair and their rounded average
+        // This is a simplification where we just take an average of the neighbors' influence
+        int offspring1 = crosses[(north_state * size + south_state) * GENOTYPE_BUCKETS + (random_bits[0] >> 30)];
+        int offspring2 = crosses[(east_state * size + west_state) * GENOTYPE_BUCKETS + (random_bits[1] >> 30)];
+
+        next_row[c] = averages[offspring1 * size + offspring2];
+    }
+}
+
+// Update function to advance the CA model to the next generation
+// The population is treated as a torus, whatever the boundary type.
+// The random draws of each cell come from the counter (generation, cell), so
+// the rows can be computed in parallel bands with identical results.
+// States above the number of states are treated as the highest state.
+// Note: Kassady created this function but had trouble pushing it to the repo
+template <typename CellT>
+void BasicCellularAutomata<CellT>::update()
+{
+    CA_PROBE("update");
+    fill_halo(PERIODIC, k);
+
+    // Genotypes are counted as they are written when statistics are collected
+    StateHistogram histogram(collect_statistics ? table_size : 0);
+
+    for_each_band(0, rows, cols, [&](int begin, int end) {
+        std::vector<uint64_t> band_counts(histogram.get_num_states());
+        for (int i = begin; i < end; ++i)
         {
-            return 1; // Homozygous Dominant
+            CellT *next_row = &next_cells[cell_index(i, 0)];
+            update_row(&cells[cell_index(i, 0)], stride, next_row, i, 0, cols, generation);
+            count_states(next_row, cols, band_counts);
         }
-        // 25% chance offspring will be recessive
-        else
+        histogram.merge(band_counts);
+    });
+
+    swap_buffers(); // Efficient way to update the main grid
+    tiles_valid = false;
+    ++generation;
+    record_statistics(histogram);
+}
+
+// Update function to advance the CA model by several generations
+// The results and statistics are those of as many calls to update(). On
+// several threads the generations are computed with temporal blocking (see
+// set_temporal_blocking), since the threads then share the memory bandwidth;
+// a single thread spends most of its time on the random draws, where the
+// cells recomputed at the edges of the tiles would only add work.
+// Inputs:
+//      generations : Number of generations
+template <typename CellT>
+void BasicCellularAutomata<CellT>::update(uint64_t generations)
+{
+    CA_PROBE("update(generations)");
+    if (time_block < 2 || generations < 2 || num_threads < 2 || rows <= 0 || cols <= 0)
+    {
+        for (uint64_t g = 0; g < generations; ++g)
         {
-            return 3; // Recessive
+            update();
+            CA_PROBE_GENERATIONS(nullptr);
         }
+        return;
     }
+    step_blocked(generations, PERIODIC, [this](const CellT *row, ptrdiff_t row_stride, CellT *next_row, int i, int j,
+                                              int width, uint64_t current_generation) {
+        update_row(row, row_stride, next_row, i, j, width, current_generation);
+    });
+}
+
+// This function is a specific rules function for our allele model of which
+// we were told to just include in the CA general purpose library.
+// The random bits for a Heterozygous x Heterozygous cross are drawn from the
+// model's generator.
+template <typename CellT>
+int BasicCellularAutomata<CellT>::determine_genotype(int cell_state1, int cell_state2)
+{
+    return determine_genotype(cell_state1, cell_state2, rng.draw(generation, user_draws++, STREAM_USER));
+}
+
+// Function that determines the offspring genotype of two parent cells
+// Inputs:
+//      cell_state1, cell_state2 : Genotypes of the parents
+//      random_bits : Uniform random word choosing the outcome of the cross
+// Returns:
+//      The genotype of the offspring
+template <typename CellT>
+int BasicCellularAutomata<CellT>::determine_genotype(int cell_state1, int cell_state2, uint32_t random_bits) const
+{
+    // HomozygousDominant = 1, Heterozygous = 2, Recessive = 3
+    // The top 2 random bits pick one of the equally likely outcomes of the cross
+    int index = table_state(cell_state1) * table_size + table_state(cell_state2);
+    return genotype_table[index * GENOTYPE_BUCKETS + (random_bits >> 30)];
 }
 
 // Getter function to get neighbors of cell
-std::vector<int> CellularAutomata::get_neighbors(int i, int j)
+// Neighbors are returned in the order north, south, east, west and, for the
+// Moore neighborhood, northeast, northwest, southeast, southwest. Neighbors
+// beyond the edge of the grid follow the configured boundary type.
+template <typename CellT>
+std::vector<int> BasicCellularAutomata<CellT>::get_neighbors(int i, int j)
 {
-    std::vector<int> neighbors;
+    ensure_halo();
 
-    // Calculate indices for orthogonal neighbors (Von Neumann)
-    int north = (i == 0) ? (boundaries == PERIODIC ? rows - 1 : i) : i - 1;
-    int south = (i == rows - 1) ? (boundaries == PERIODIC ? 0 : i) : i + 1;
-    int east = (j == cols - 1) ? (boundaries == PERIODIC ? 0 : j) : j + 1;
-    int west = (j == 0) ? (boundaries == PERIODIC ? cols - 1 : j) : j - 1;
+    const CellT *cell = &cells[cell_index(i, j)];
+    std::vector<int> neighbors;
 
-    // Add orthogonal neighbors
-    neighbors.push_back(grid[north][j]);
-    neighbors.push_back(grid[south][j]);
-    neighbors.push_back(grid[i][east]);
-    neighbors.push_back(grid[i][west]);
+    // Add orthogonal neighbors (Von Neumann)
+    neighbors.push_back(cell[-stride]);
+    neighbors.push_back(cell[stride]);
+    neighbors.push_back(cell[1]);
+    neighbors.push_back(cell[-1]);
 
     // Include diagonal neighbors for Moore neighborhood
     if (neighborhood == MOORE)
     {
-        int northeast = (boundaries == PERIODIC) ? ((north + rows) % rows) * cols + (east + cols) % cols : north * cols + east;
-        int northwest = (boundaries == PERIODIC) ? ((north + rows) % rows) * cols + (west + cols) % cols : north * cols + west;
-        int southeast = (boundaries == PERIODIC) ? ((south + rows) % rows) * cols + (east + cols) % cols : south * cols + east;
-        int southwest = (boundaries == PERIODIC) ? ((south + rows) % rows) * cols + (west + cols) % cols : south * cols + west;
-
-        neighbors.push_back(grid[northeast / cols][northeast % cols]);
-        neighbors.push_back(grid[northwest / cols][northwest % cols]);
-        neighbors.push_back(grid[southeast / cols][southeast % cols]);
-        neighbors.push_back(grid[southwest / cols][southwest % cols]);
+        neighbors.push_back(cell[-stride + 1]);
+        neighbors.push_back(cell[-stride - 1]);
+        neighbors.push_back(cell[stride + 1]);
+        neighbors.push_back(cell[stride - 1]);
     }
 
     return neighbors;
 }
 
 // Function responsible for setting state of a cell
-void CellularAutomata::set_cell_state(int row, int col, int state)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_cell_state(int row, int col, int state)
 {
     if (row >= 0 && row < rows && col >= 0 && col < cols)
     {
-        grid[row][col] = state;
+        cells[cell_index(row, col)] = state;
+        halo_valid = false;
+        mark_tile_changed(row, col);
     }
     else
     {
         std::cerr << "Error: Index out of bounds while trying to set cell state." << std::endl;
     }
-}
\ No newline at end of file
+}
+
+
+// Function that sets every cell of a row
+// Inputs:
+//      row : Row of the grid
+//      values : The cols new cell states of the row
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_row(int row, const CellT *values)
+{
+    if (row < 0 || row >= rows)
+    {
+        std::cerr << "Error: Row index out of bounds while trying to set a row." << std::endl;
+        return;
+    }
+    std::copy_n(values, cols, &cells[cell_index(row, 0)]);
+    halo_valid = false;
+    for (int col = 0; col < cols; col += tile_width)
+    {
+        mark_tile_changed(row, col);
+    }
+}
+
+// Function that saves the run to a checkpoint file
+// The file holds the grid, the configuration, the genotype table (with the
+// crosses changed by set_cross), the generation, the seed and draw counter of
+// the random number generator and the statistics, which is everything the
+// next generations depend on. The number of threads and the custom rules are
+// not saved.
+// Inputs:
+//      path : Path of the file
+// Returns:
+//      True if the file was written
+template <typename CellT>
+bool BasicCellularAutomata<CellT>::save_checkpoint(const std::string &path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Error opening " << path << " for writing." << std::endl;
+        return false;
+    }
+
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    header.version = CHECKPOINT_VERSION;
+    header.cell_bytes = sizeof(CellT);
+    header.rows = rows;
+    header.cols = cols;
+    header.neighborhood_radius = neighborhood_radius;
+    header.states = states;
+    header.k = k;
+    header.kprime = kprime;
+    header.halo = halo;
+    header.table_size = table_size;
+    header.dimensions = dimensions;
+    header.neighborhood = neighborhood;
+    header.boundaries = boundaries;
+    header.rule = rule;
+    header.engine = engine;
+    header.time_block = time_block;
+    header.flags = (vectorize ? CHECKPOINT_VECTORIZE : 0) | (collect_statistics ? CHECKPOINT_STATISTICS : 0) |
+                   (active_regions ? CHECKPOINT_ACTIVE_REGIONS : 0);
+    header.statistics_states = statistics.get_num_states();
+    header.seed = rng.get_seed();
+    header.generation = generation;
+    header.user_draws = user_draws;
+    header.statistics_samples = statistics.size();
+
+    size_t table_bytes = genotype_table.size() * sizeof(CellT);
+    size_t grid_bytes = cells.size() * sizeof(CellT);
+    header.table_offset = CHECKPOINT_HEADER_BYTES;
+    header.grid_offset = (header.table_offset + table_bytes + CHECKPOINT_GRID_ALIGNMENT - 1) /
+                         CHECKPOINT_GRID_ALIGNMENT * CHECKPOINT_GRID_ALIGNMENT;
+    header.statistics_offset = (header.grid_offset + grid_bytes + 7) / 8 * 8;
+    header.file_size = header.statistics_offset +
+                       header.statistics_samples * (header.statistics_states + 1) * sizeof(uint64_t);
+
+    std::vector<char> padding(CHECKPOINT_GRID_ALIGNMENT, 0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(padding.data(), CHECKPOINT_HEADER_BYTES - sizeof(header));
+    file.write(reinterpret_cast<const char *>(genotype_table.data()), table_bytes);
+    file.write(padding.data(), header.grid_offset - header.table_offset - table_bytes);
+    file.write(reinterpret_cast<const char *>(cells.data()), grid_bytes);
+    file.write(padding.data(), header.statistics_offset - header.grid_offset - grid_bytes);
+    file.write(reinterpret_cast<const char *>(statistics.get_generations().data()),
+               header.statistics_samples * sizeof(uint64_t));
+    for (int state = 0; header.statistics_samples > 0 && state < statistics.get_num_states(); ++state)
+    {
+        file.write(reinterpret_cast<const char *>(statistics.get_counts(state).data()),
+                   header.statistics_samples * sizeof(uint64_t));
+    }
+
+    file.close();
+    if (!file)
+    {
+        std::cerr << "Error writing " << path << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Function that resumes a run from a checkpoint file
+// The file is mapped, so the grid is copied straight from the page cache.
+// The model keeps its number of threads and its custom rules.
+// Inputs:
+//      path : Path of a file written by save_checkpoint with the same cell type
+// Returns:
+//      True if the run was restored (the model is unchanged otherwise)
+template <typename CellT>
+bool BasicCellularAutomata<CellT>::load_checkpoint(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Error opening " << path << " for reading." << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < CHECKPOINT_HEADER_BYTES)
+    {
+        std::cerr << "Error: " << path << " is not a checkpoint file." << std::endl;
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "Error mapping " << path << "." << std::endl;
+        return false;
+    }
+    const char *data = static_cast<const char *>(mapping);
+
+    CheckpointHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    // The sizes are bounded before any product of them is formed, and the
+    // regions are checked against the space left in the file by division, so
+    // no check can overflow on a corrupt header
+    const int64_t padded_rows = static_cast<int64_t>(header.rows) + 2 * static_cast<int64_t>(header.halo);
+    const int64_t padded_cols = static_cast<int64_t>(header.cols) + 2 * static_cast<int64_t>(header.halo);
+    const uint64_t table_side = static_cast<uint64_t>(header.table_size);
+    bool valid = std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) == 0 &&
+                 header.version == CHECKPOINT_VERSION && header.rows >= 0 && header.cols >= 0 &&
+                 header.neighborhood_radius >= 1 && header.halo >= header.neighborhood_radius &&
+                 padded_rows <= INT32_MAX && padded_cols <= INT32_MAX &&
+                 header.dimensions >= ONE_DIMENSIONAL && header.dimensions <= TWO_DIMENSIONAL &&
+                 header.neighborhood >= VON_NEUMANN && header.neighborhood <= MOORE &&
+                 header.boundaries >= PERIODIC && header.boundaries <= NO_BOUNDARIES &&
+                 header.rule >= STRAIGHT_CONDITIONAL && header.rule <= MAJORITY_RULE &&
+                 header.engine >= DIRECT_ENGINE && header.engine <= BITSLICED_ENGINE && header.time_block >= 1 &&
+                 header.table_size == static_cast<int64_t>(std::max<int32_t>(header.states, 3)) + 1 &&
+                 header.file_size == size && header.table_offset <= header.grid_offset &&
+                 header.grid_offset <= header.statistics_offset && header.statistics_offset <= size &&
+                 table_side * table_side <=
+                     (header.grid_offset - header.table_offset) / (GENOTYPE_BUCKETS * sizeof(CellT)) &&
+                 static_cast<uint64_t>(padded_rows * padded_cols) <=
+                     (header.statistics_offset - header.grid_offset) / sizeof(CellT) &&
+                 header.statistics_samples <=
+                     (size - header.statistics_offset) / ((header.statistics_states + uint64_t(1)) * sizeof(uint64_t));
+    if (!valid || header.cell_bytes != sizeof(CellT))
+    {
+        std::cerr << "Error: " << path << (valid ? " was saved with another cell width." : " is not a checkpoint file.")
+                  << std::endl;
+        munmap(mapping, size);
+        return false;
+    }
+
+    dimensions = static_cast<DimensionType>(header.dimensions);
+    neighborhood = static_cast<NeighborhoodType>(header.neighborhood);
+    boundaries = static_cast<BoundaryType>(header.boundaries);
+    rule = static_cast<RuleType>(header.rule);
+    engine = static_cast<EngineType>(header.engine);
+    time_block = header.time_block;
+    neighborhood_radius = header.neighborhood_radius;
+    k = header.k;
+    kprime = header.kprime;
+    states = header.states;
+    build_genotype_table();
+    size_t table_cells = table_side * table_side * GENOTYPE_BUCKETS;
+    std::memcpy(genotype_table.data(), data + header.table_offset, table_cells * sizeof(CellT));
+
+    rows = header.rows;
+    cols = header.cols;
+    halo = header.halo;
+    allocate_grid();
+    size_t padded_cells = static_cast<size_t>(padded_rows * padded_cols);
+    std::memcpy(cells.data(), data + header.grid_offset, padded_cells * sizeof(CellT));
+    tile_counts_valid = false;
+
+    vectorize = (header.flags & CHECKPOINT_VECTORIZE) != 0;
+    collect_statistics = (header.flags & CHECKPOINT_STATISTICS) != 0;
+    active_regions = (header.flags & CHECKPOINT_ACTIVE_REGIONS) != 0;
+    rng.set_seed(header.seed);
+    generation = header.generation;
+    user_draws = header.user_draws;
+
+    // The frequencies of every sample are recomputed from its counts
+    statistics.clear();
+    const uint64_t *columns = reinterpret_cast<const uint64_t *>(data + header.statistics_offset);
+    std::vector<uint64_t> counts(header.statistics_samples > 0 ? header.statistics_states : 0);
+    for (uint64_t sample = 0; sample < header.statistics_samples; ++sample)
+    {
+        for (uint32_t state = 0; state < header.statistics_states; ++state)
+        {
+            counts[state] = columns[(state + 1) * header.statistics_samples + sample];
+        }
+        statistics.add(columns[sample], counts);
+    }
+
+    munmap(mapping, size);
+    configure_step();
+    return true;
+}
+
+// Function that copies the grid into a 2-bit packed genotype grid
+// Inputs:
+//      packed : The packed grid to fill (resized to the grid size)
+template <typename CellT>
+void BasicCellularAutomata<CellT>::get_packed_grid(PackedGenotypeGrid &packed) const
+{
+    packed.resize(rows, cols);
+    for (int i = 0; i < rows; ++i)
+    {
+        const CellT *row = &cells[cell_index(i, 0)];
+        for (int j = 0; j < cols; ++j)
+        {
+            packed.set(i, j, row[j]);
+        }
+    }
+}
+
+// Function that sets the grid from a 2-bit packed genotype grid
+// The grid size is taken from the packed grid.
+// Inputs:
+//      packed : The packed configuration of the CA grid
+template <typename CellT>
+void BasicCellularAutomata<CellT>::set_packed_grid(const PackedGenotypeGrid &packed)
+{
+    rows = packed.get_rows();
+    cols = packed.get_cols();
+    allocate_grid();
+
+    for (int i = 0; i < rows; ++i)
+    {
+        CellT *row = &cells[cell_index(i, 0)];
+        for (int j = 0; j < cols; ++j)
+        {
+            row[j] = static_cast<CellT>(packed.get(i, j));
+        }
+    }
+}
+
+// Default constructor
+PackedGenotypeGrid::PackedGenotypeGrid() : rows(0), cols(0) {}
+
+// Constructor for a packed grid where every cell is in state 0
+// Inputs:
+//      rows : The number of rows in the grid
+//      cols : The number of columns in the grid
+PackedGenotypeGrid::PackedGenotypeGrid(int rows, int cols) : rows(0), cols(0)
+{
+    resize(rows, cols);
+}
+
+// Function to resize the packed grid; every cell is reset to state 0
+// Inputs:
+//      rows : The number of rows in the grid
+//      cols : The number of columns in the grid
+void PackedGenotypeGrid::resize(int rows, int cols)
+{
+    this->rows = rows;
+    this->cols = cols;
+    data.assign((static_cast<size_t>(rows) * cols + 3) / 4, 0);
+}
+
+// Function to set the state of a cell in the packed grid
+// Inputs:
+//      row, col : Position of the cell in the grid
+//      state : The new state of the cell (only the low 2 bits are stored)
+void PackedGenotypeGrid::set(int row, int col, int state)
+{
+    size_t index = static_cast<size_t>(row) * cols + col;
+    int shift = static_cast<int>(index & 3) * 2;
+    uint8_t &byte = data[index >> 2];
+    byte = static_cast<uint8_t>((byte & ~(3 << shift)) | ((state & 3) << shift));
+}
+
+// Getter methods for the packed grid size and storage
+int PackedGenotypeGrid::get_rows() const
+{
+    return rows;
+}
+
+int PackedGenotypeGrid::get_cols() const
+{
+    return cols;
+}
+
+size_t PackedGenotypeGrid::size_bytes() const
+{
+    return data.size();
+}
+
+const std::vector<uint8_t> &PackedGenotypeGrid::get_data() const
+{
+    return data;
+}
+
+std::vector<uint8_t> &PackedGenotypeGrid::get_data()
+{
+    return data;
+}
+
+// The library is compiled for these cell widths
+template class BasicCellularAutomata<int>;
+template class BasicCellularAutomata<uint16_t>;
+template class BasicCellularAutomata<uint8_t>;
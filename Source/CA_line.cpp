@@ -0,0 +1,430 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the implementation of the 1D engine of the cellular
+// automata library. A generation reads the current line of the ring and
+// writes the next one over the oldest line; nothing else moves. The line is
+// cut into segments handed to the 1D row kernels (radius 1) or to the window
+// sums (larger radii), and the segments are spread over the threads.
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include "CA_line.h"
+#include "CA_kernels.h"
+#include "CA_threadpool.h"
+#include "CA_window.h"
+
+// Number of cells handed to a kernel at once
+static const int64_t LINE_SEGMENT_CELLS = 1 << 16;
+
+// Default constructor
+template <typename CellT>
+BasicLineAutomata<CellT>::BasicLineAutomata()
+    : boundaries(PERIODIC), rule(STRAIGHT_CONDITIONAL), width(0), radius(1), states(2), k(0), kprime(0), depth(0),
+      slots(2), history_lines(0), pitch(0), generation(0), vectorize(true), num_threads(1), rng(5489),
+      collect_statistics(false)
+{
+    allocate();
+}
+
+// Helper function that allocates the ring for the width, radius and history depth
+// Lines start on a cache line, and the current line is cleared.
+template <typename CellT>
+void BasicLineAutomata<CellT>::allocate()
+{
+    const size_t line_cells = 64 / sizeof(CellT);
+    slots = std::max(depth, 1) + 1;
+    pitch = (static_cast<size_t>(width) + 2 * radius + line_cells - 1) / line_cells * line_cells;
+    ring.assign(static_cast<size_t>(slots) * pitch, 0);
+    generation = 0;
+    history_lines = 0;
+}
+
+template <typename CellT>
+void BasicLineAutomata<CellT>::set_boundaries(BoundaryType boundaries)
+{
+    this->boundaries = boundaries;
+}
+
+template <typename CellT>
+void BasicLineAutomata<CellT>::set_rule(RuleType rule)
+{
+    this->rule = rule;
+}
+
+// Setter method to set the neighborhood radius (the ring is reallocated and cleared)
+// Inputs:
+//      radius : Number of cells on each side of a cell that are its neighbors
+template <typename CellT>
+void BasicLineAutomata<CellT>::set_neighborhood_radius(int radius)
+{
+    this->radius = std::max(radius, 1);
+    allocate();
+}
+
+template <typename CellT>
+void BasicLineAutomata<CellT>::set_states(int states)
+{
+    this->states = states;
+}
+
+template <typename CellT>
+void BasicLineAutomata<CellT>::set_k(int k_state)
+{
+    k = k_state;
+}
+
+template <typename CellT>
+void BasicLineAutomata<CellT>::set_kprime(int kprime_state)
+{
+    kprime = kprime_state;
+}
+
+template <typename CellT>
+void BasicLineAutomata<CellT>::set_vectorization(bool enabled)
+{
+    vectorize = enabled;
+}
+
+// Setter method to set the number of threads used by step
+// Inputs:
+//      num_threads : Number of threads (0 uses every hardware thread, 1 runs serially)
+template <typename CellT>
+void BasicLineAutomata<CellT>::set_num_threads(int num_threads)
+{
+    if (num_threads <= 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    this->num_threads = num_threads;
+    pool.reset();
+    if (num_threads > 1)
+    {
+        pool = std::make_shared<ThreadPool>(num_threads);
+    }
+}
+
+template <typename CellT>
+void BasicLineAutomata<CellT>::set_seed(uint64_t seed)
+{
+    rng.set_seed(seed);
+}
+
+template <typename CellT>
+void BasicLineAutomata<CellT>::set_statistics(bool enabled)
+{
+    collect_statistics = enabled;
+}
+
+// Setter method to set the number of cells in the line (the line is cleared)
+// Inputs:
+//      width : Number of cells
+template <typename CellT>
+void BasicLineAutomata<CellT>::set_width(int64_t width)
+{
+    this->width = std::max<int64_t>(width, 0);
+    allocate();
+}
+
+// Setter method to set the number of past generations kept for space-time diagrams
+// The current line is kept; the history restarts from it.
+// Inputs:
+//      depth : Number of past generations (0 keeps only the current line)
+template <typename CellT>
+void BasicLineAutomata<CellT>::set_history_depth(int depth)
+{
+    std::vector<CellT> current(slot_line(generation), slot_line(generation) + width);
+    uint64_t current_generation = generation;
+    this->depth = std::max(depth, 0);
+    allocate();
+    generation = current_generation;
+    std::copy(current.begin(), current.end(), slot_line(generation));
+}
+
+// Helper function that runs a task over the line, cut into bands of segments
+// Inputs:
+//      task : Function computing the cells [begin, end) and adding the states it
+//             wrote to its band counts
+//      counts : Counts of the states, merged from the bands (nothing is counted if empty)
+template <typename CellT>
+void BasicLineAutomata<CellT>::for_each_segment(
+    const std::function<void(int64_t, int64_t, std::vector<uint64_t> &)> &task, std::vector<uint64_t> &counts)
+{
+    int64_t segments = (width + LINE_SEGMENT_CELLS - 1) / LINE_SEGMENT_CELLS;
+    if (!pool || segments <= 1)
+    {
+        task(0, width, counts);
+        return;
+    }
+
+    std::mutex merge_lock;
+    pool->parallel_for(0, static_cast<int>(segments), [&](int begin, int end) {
+        std::vector<uint64_t> band_counts(counts.size(), 0);
+        task(begin * LINE_SEGMENT_CELLS, std::min<int64_t>(end * LINE_SEGMENT_CELLS, width), band_counts);
+        std::lock_guard<std::mutex> lock(merge_lock);
+        for (size_t state = 0; state < counts.size(); ++state)
+        {
+            counts[state] += band_counts[state];
+        }
+    }, static_cast<int>(std::min<int64_t>(segments, num_threads)));
+}
+
+// Function that fills the line with random states, as setup_dimensions does in 1D
+// (cell j of the line gets the state of cell j of the first row of a model
+// with the same seed). The generation and the history are reset.
+template <typename CellT>
+void BasicLineAutomata<CellT>::setup_line()
+{
+    generation = 0;
+    history_lines = 0;
+    CellT *line = slot_line(0);
+    std::vector<uint64_t> no_counts;
+    for_each_segment([&](int64_t begin, int64_t end, std::vector<uint64_t> &) {
+        for (int64_t j = begin; j < end; ++j)
+        {
+            line[j] = static_cast<CellT>(rng.draw(0, static_cast<uint64_t>(j), STREAM_SETUP) % states + 1);
+        }
+    }, no_counts);
+}
+
+// Function that sets the cells of the current line
+// Inputs:
+//      line : The states of the first width cells (missing cells are left unchanged)
+template <typename CellT>
+void BasicLineAutomata<CellT>::set_line(const std::vector<int> &line)
+{
+    CellT *current = slot_line(generation);
+    int64_t count = std::min<int64_t>(width, static_cast<int64_t>(line.size()));
+    for (int64_t j = 0; j < count; ++j)
+    {
+        current[j] = static_cast<CellT>(line[j]);
+    }
+}
+
+template <typename CellT>
+void BasicLineAutomata<CellT>::set_cell_state(int64_t cell, int state)
+{
+    if (cell >= 0 && cell < width)
+    {
+        slot_line(generation)[cell] = static_cast<CellT>(state);
+    }
+    else
+    {
+        std::cerr << "Error: Index out of bounds while trying to set cell state." << std::endl;
+    }
+}
+
+// Helper function that fills the ghost cells at both ends of a line
+// Periodic: the line wraps around. Fixed: the ghost cells are in state k.
+// No boundaries: the ghost cells repeat the cell at the end of the line.
+// Inputs:
+//      line : First cell of the line
+template <typename CellT>
+void BasicLineAutomata<CellT>::fill_ghosts(CellT *line) const
+{
+    for (int h = 1; h <= radius; ++h)
+    {
+        if (boundaries == PERIODIC)
+        {
+            line[-h] = line[((width - h) % width + width) % width];
+            line[width - 1 + h] = line[(h - 1) % width];
+        }
+        else if (boundaries == FIXED)
+        {
+            line[-h] = line[width - 1 + h] = static_cast<CellT>(k);
+        }
+        else
+        {
+            line[-h] = line[0];
+            line[width - 1 + h] = line[width - 1];
+        }
+    }
+}
+
+// Function that advances the line by several generations of the configured rule
+// The rules are those of onedim_rule1-3 on a model with the same radius and
+// boundaries: Straight Conditional turns k into k', Conditional Transition
+// turns k into k' next to a cell in state k', and Majority Rule turns k into
+// k' when the sum of the 2r neighbors reaches r.
+// Inputs:
+//      generations : Number of generations
+template <typename CellT>
+void BasicLineAutomata<CellT>::step(uint64_t generations)
+{
+    if (width <= 0)
+    {
+        return;
+    }
+    const RowKernels<CellT> &kernels = select_row_kernels<CellT>(vectorize);
+    const LineKernel<CellT> line_kernel = (rule == CONDITIONAL_TRANSITION) ? kernels.conditional_1d : kernels.majority_1d;
+    const CellT k_state = static_cast<CellT>(k);
+    const CellT kprime_state = static_cast<CellT>(kprime);
+    const int match = (rule == CONDITIONAL_TRANSITION) ? kprime : -1;
+    const int bins = std::max(states, 3) + 1;
+
+    for (uint64_t g = 0; g < generations; ++g)
+    {
+        const CellT *line = slot_line(generation);
+        CellT *next_line = slot_line(generation + 1);
+        if (rule != STRAIGHT_CONDITIONAL)
+        {
+            fill_ghosts(slot_line(generation));
+        }
+
+        std::vector<uint64_t> counts(collect_statistics ? bins : 0, 0);
+        for_each_segment([&](int64_t begin, int64_t end, std::vector<uint64_t> &band_counts) {
+            static thread_local std::vector<int> sums;
+            for (int64_t start = begin; start < end; start += LINE_SEGMENT_CELLS)
+            {
+                const int segment = static_cast<int>(std::min(LINE_SEGMENT_CELLS, end - start));
+                const CellT *in = line + start;
+                CellT *out = next_line + start;
+                if (rule == STRAIGHT_CONDITIONAL)
+                {
+                    for (int j = 0; j < segment; ++j)
+                    {
+                        out[j] = in[j] == k_state ? kprime_state : in[j];
+                    }
+                }
+                else if (radius == 1)
+                {
+                    line_kernel(in, out, segment, k_state, kprime_state);
+                }
+                else
+                {
+                    sums.resize(segment);
+                    line_window_sums(in, 0, segment, radius, match, sums.data());
+                    for (int j = 0; j < segment; ++j)
+                    {
+                        bool condition_met = (rule == CONDITIONAL_TRANSITION) ? sums[j] > 0 : sums[j] - in[j] >= radius;
+                        out[j] = (in[j] == k_state && condition_met) ? kprime_state : in[j];
+                    }
+                }
+                if (!band_counts.empty())
+                {
+                    for (int j = 0; j < segment; ++j)
+                    {
+                        int state = out[j];
+                        ++band_counts[state < 0 ? 0 : (state >= bins ? bins - 1 : state)];
+                    }
+                }
+            }
+        }, counts);
+
+        ++generation;
+        history_lines = std::min(history_lines + 1, depth);
+        if (collect_statistics)
+        {
+            statistics.add(generation, counts);
+        }
+    }
+}
+
+// Function that adds a statistics sample for the current line
+template <typename CellT>
+void BasicLineAutomata<CellT>::record_statistics()
+{
+    const int bins = std::max(states, 3) + 1;
+    std::vector<uint64_t> counts(bins, 0);
+    const CellT *line = slot_line(generation);
+    for (int64_t j = 0; j < width; ++j)
+    {
+        int state = line[j];
+        ++counts[state < 0 ? 0 : (state >= bins ? bins - 1 : state)];
+    }
+    statistics.add(generation, counts);
+}
+
+template <typename CellT>
+BoundaryType BasicLineAutomata<CellT>::get_boundaries() const
+{
+    return boundaries;
+}
+
+template <typename CellT>
+RuleType BasicLineAutomata<CellT>::get_rule() const
+{
+    return rule;
+}
+
+template <typename CellT>
+int64_t BasicLineAutomata<CellT>::get_width() const
+{
+    return width;
+}
+
+template <typename CellT>
+int BasicLineAutomata<CellT>::get_neighborhood_radius() const
+{
+    return radius;
+}
+
+template <typename CellT>
+int BasicLineAutomata<CellT>::get_states() const
+{
+    return states;
+}
+
+template <typename CellT>
+int BasicLineAutomata<CellT>::get_k() const
+{
+    return k;
+}
+
+template <typename CellT>
+int BasicLineAutomata<CellT>::get_kprime() const
+{
+    return kprime;
+}
+
+template <typename CellT>
+int BasicLineAutomata<CellT>::get_history_depth() const
+{
+    return depth;
+}
+
+template <typename CellT>
+int BasicLineAutomata<CellT>::get_num_threads() const
+{
+    return num_threads;
+}
+
+template <typename CellT>
+uint64_t BasicLineAutomata<CellT>::get_generation() const
+{
+    return generation;
+}
+
+template <typename CellT>
+int BasicLineAutomata<CellT>::get_cell_state(int64_t cell) const
+{
+    return slot_line(generation)[cell];
+}
+
+template <typename CellT>
+const StatisticsSeries &BasicLineAutomata<CellT>::get_statistics() const
+{
+    return statistics;
+}
+
+// Getter method to get a line of the history
+// Inputs:
+//      age : 0 for the current generation, 1 for the one before, ...
+// Returns:
+//      The width cells of the line, or nullptr if that generation is not kept
+template <typename CellT>
+const CellT *BasicLineAutomata<CellT>::get_line(int age) const
+{
+    if (age < 0 || age > history_lines)
+    {
+        return nullptr;
+    }
+    return slot_line(generation - age);
+}
+
+// Explicit instantiations for the cell widths of the library
+template class BasicLineAutomata<int>;
+template class BasicLineAutomata<uint16_t>;
+template class BasicLineAutomata<uint8_t>;
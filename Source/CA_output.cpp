@@ -0,0 +1,205 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the implementation of the asynchronous output stage of
+// the cellular automata library. The calling thread and the writer thread
+// share two queues of buffer numbers: write_frame() takes a free buffer,
+// copies the grid into it and queues it; the writer thread takes the oldest
+// queued buffer, writes it through a SnapshotWriter and frees it. Frames are
+// written in the order they were queued, so the file is the one the
+// synchronous writer gives.
+
+#include <algorithm>
+#include <iostream>
+#include "CA_output.h"
+
+// Default constructor
+template <typename CellT>
+BasicAsyncSnapshotWriter<CellT>::BasicAsyncSnapshotWriter()
+    : rows(0), cols(0), frames_written(0), stalls(0), stopping(false), failed(false), is_open(false)
+{
+}
+
+// Destructor, writes the queued frames and closes the file
+template <typename CellT>
+BasicAsyncSnapshotWriter<CellT>::~BasicAsyncSnapshotWriter()
+{
+    close();
+}
+
+// Helper function run by the writer thread
+// Writes the queued frames in order until close() has queued the last one.
+template <typename CellT>
+void BasicAsyncSnapshotWriter<CellT>::writer_loop()
+{
+    for (;;)
+    {
+        int buffer;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            frame_queued.wait(lock, [this] { return !queued_buffers.empty() || stopping; });
+            if (queued_buffers.empty())
+            {
+                return;
+            }
+            buffer = queued_buffers.front();
+        }
+
+        // Pack, encode and write without holding the lock
+        bool written = writer.write_frame(generations[buffer], buffers[buffer].data());
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queued_buffers.pop_front();
+            free_buffers.push_back(buffer);
+            if (written)
+            {
+                ++frames_written;
+            }
+            else
+            {
+                failed = true;
+            }
+        }
+        buffer_freed.notify_one();
+    }
+}
+
+// Function to create a snapshot file for a model and start the writer thread
+// Inputs:
+//      path : Path of the file
+//      model : Model whose configuration is stored in the header
+//      encoding : How the frames are encoded
+//      keyframe_interval : Frames between two keyframes (SNAPSHOT_DELTA)
+//      queue_frames : Number of buffers (frames that can wait for the writer)
+// Returns:
+//      True if the file was created
+template <typename CellT>
+bool BasicAsyncSnapshotWriter<CellT>::open(const std::string &path, const BasicCellularAutomata<CellT> &model,
+                                           SnapshotEncoding encoding, int keyframe_interval, int queue_frames)
+{
+    close();
+    if (!writer.open(path, model, encoding, keyframe_interval))
+    {
+        return false;
+    }
+
+    rows = model.get_grid_rows();
+    cols = model.get_grid_cols();
+    queue_frames = std::max(queue_frames, 1);
+    buffers.assign(queue_frames, std::vector<CellT>(static_cast<size_t>(rows) * cols));
+    generations.assign(queue_frames, 0);
+    free_buffers.clear();
+    queued_buffers.clear();
+    for (int buffer = 0; buffer < queue_frames; ++buffer)
+    {
+        free_buffers.push_back(buffer);
+    }
+    frames_written = 0;
+    stalls = 0;
+    stopping = false;
+    failed = false;
+    is_open = true;
+    writer_thread = std::thread(&BasicAsyncSnapshotWriter<CellT>::writer_loop, this);
+    return true;
+}
+
+// Function to queue the current generation of a model as a frame
+// Waits for a free buffer when every buffer is queued.
+// Returns:
+//      False if the file is not open, the grid size differs or a frame could not be written
+template <typename CellT>
+bool BasicAsyncSnapshotWriter<CellT>::write_frame(const BasicCellularAutomata<CellT> &model)
+{
+    if (!is_open || model.get_grid_rows() != rows || model.get_grid_cols() != cols)
+    {
+        return false;
+    }
+
+    int buffer;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (failed)
+        {
+            return false;
+        }
+        if (free_buffers.empty())
+        {
+            ++stalls;
+            buffer_freed.wait(lock, [this] { return !free_buffers.empty(); });
+        }
+        buffer = free_buffers.front();
+        free_buffers.pop_front();
+    }
+
+    // Copy the grid while the writer thread works on earlier frames
+    CellT *cells = buffers[buffer].data();
+    for (int i = 0; i < rows; ++i)
+    {
+        std::copy_n(model.get_row(i), cols, cells + static_cast<size_t>(i) * cols);
+    }
+    generations[buffer] = model.get_generation();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued_buffers.push_back(buffer);
+    }
+    frame_queued.notify_one();
+    return true;
+}
+
+// Function to write the queued frames, stop the writer thread and close the file
+// Returns:
+//      True if every frame and the index were written
+template <typename CellT>
+bool BasicAsyncSnapshotWriter<CellT>::close()
+{
+    if (!is_open)
+    {
+        return false;
+    }
+    is_open = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    frame_queued.notify_one();
+    writer_thread.join();
+
+    bool written = writer.close() && !failed;
+    if (failed)
+    {
+        std::cerr << "Error: A frame could not be written to the snapshot file." << std::endl;
+    }
+    buffers.clear();
+    return written;
+}
+
+// Getter method to get the number of frames written to the file so far
+template <typename CellT>
+uint64_t BasicAsyncSnapshotWriter<CellT>::get_num_frames()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return frames_written;
+}
+
+// Getter method to get the number of frames queued but not yet written
+template <typename CellT>
+uint64_t BasicAsyncSnapshotWriter<CellT>::get_pending_frames()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return queued_buffers.size();
+}
+
+// Getter method to get the number of calls of write_frame() that waited for a buffer
+template <typename CellT>
+uint64_t BasicAsyncSnapshotWriter<CellT>::get_stalls()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stalls;
+}
+
+// Explicit instantiations for the cell widths of the library
+template class BasicAsyncSnapshotWriter<int>;
+template class BasicAsyncSnapshotWriter<uint16_t>;
+template class BasicAsyncSnapshotWriter<uint8_t>;
@@ -0,0 +1,686 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the writer and the memory-mapped reader of the binary
+// snapshot format (see CA_snapshot.h for the layout of a file).
+
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "CA_snapshot.h"
+#include "CA_endian.h"
+
+// Size of the fixed parts of a snapshot file
+static const size_t HEADER_SIZE = 64;
+static const size_t FRAME_HEADER_SIZE = 24;
+static const size_t INDEX_ENTRY_SIZE = 32;
+static const uint32_t SNAPSHOT_VERSION = 1;
+static const char SNAPSHOT_MAGIC[8] = {'C', 'A', 'S', 'N', 'A', 'P', 'S', 'H'};
+
+// Shortest run of equal bytes worth storing as a run
+static const size_t MIN_RUN = 4;
+
+// Helper functions that store and load variable-length integers (7 bits per byte)
+static void put_varint(std::vector<uint8_t> &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static bool get_varint(const uint8_t *&in, const uint8_t *end, uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && in < end; shift += 7)
+    {
+        uint8_t byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// Function that run-length encodes bytes, optionally XORed with a previous frame
+// The output is a list of tokens: varint (length << 1 | 1) followed by one
+// byte for a run, varint (length << 1) followed by the bytes for a literal.
+// Inputs:
+//      bytes : Bytes to encode
+//      previous : Bytes XORed with the input (nullptr for none)
+//      count : Number of bytes
+//      out : Encoded bytes
+static void rle_encode(const uint8_t *bytes, const uint8_t *previous, size_t count, std::vector<uint8_t> &out)
+{
+    auto value = [&](size_t p) { return previous ? static_cast<uint8_t>(bytes[p] ^ previous[p]) : bytes[p]; };
+    auto flush_literal = [&](size_t begin, size_t end) {
+        if (begin < end)
+        {
+            put_varint(out, static_cast<uint64_t>(end - begin) << 1);
+            for (size_t p = begin; p < end; ++p)
+                out.push_back(value(p));
+        }
+    };
+
+    out.clear();
+    size_t literal_begin = 0;
+    size_t p = 0;
+    while (p < count)
+    {
+        uint8_t byte = value(p);
+        size_t run = 1;
+        while (p + run < count && value(p + run) == byte)
+            ++run;
+
+        if (run >= MIN_RUN)
+        {
+            flush_literal(literal_begin, p);
+            put_varint(out, (static_cast<uint64_t>(run) << 1) | 1);
+            out.push_back(byte);
+            literal_begin = p + run;
+        }
+        p += run;
+    }
+    flush_literal(literal_begin, count);
+}
+
+// Function that decodes run-length encoded bytes
+// Inputs:
+//      in, size : Encoded bytes
+//      out, count : Decoded bytes; exactly count bytes must be decoded
+//      xor_into : XOR the decoded bytes into out instead of storing them
+// Returns:
+//      True if the encoded bytes were valid
+static bool rle_decode(const uint8_t *in, size_t size, uint8_t *out, size_t count, bool xor_into)
+{
+    const uint8_t *end = in + size;
+    size_t p = 0;
+    while (in < end)
+    {
+        uint64_t token;
+        if (!get_varint(in, end, token))
+            return false;
+        uint64_t length = token >> 1;
+        if (length > count - p)
+            return false;
+
+        if (token & 1)
+        {
+            if (in >= end)
+                return false;
+            uint8_t byte = *in++;
+            if (!xor_into)
+                std::memset(out + p, byte, length);
+            else if (byte != 0)
+                for (uint64_t q = 0; q < length; ++q)
+                    out[p + q] ^= byte;
+        }
+        else
+        {
+            if (length > static_cast<uint64_t>(end - in))
+                return false;
+            for (uint64_t q = 0; q < length; ++q)
+                out[p + q] = xor_into ? static_cast<uint8_t>(out[p + q] ^ in[q]) : in[q];
+            in += length;
+        }
+        p += length;
+    }
+    return p == count;
+}
+
+// Function that returns the bits a packed cell needs to hold the states 0 to states
+static int bits_for_states(int states)
+{
+    for (int bits : {1, 2, 4, 8, 16})
+    {
+        if (states < (1 << bits))
+            return bits;
+    }
+    return 32;
+}
+
+// Function that returns the size of a bit-packed frame
+static size_t packed_size(const SnapshotHeader &header)
+{
+    uint64_t cells = static_cast<uint64_t>(header.rows) * header.cols;
+    return static_cast<size_t>((cells * header.bits_per_cell + 7) / 8);
+}
+
+// Helper functions that serialize the header of a file
+static void encode_header(const SnapshotHeader &header, uint8_t out[HEADER_SIZE])
+{
+    std::memset(out, 0, HEADER_SIZE);
+    std::memcpy(out, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    put_u32(out + 8, SNAPSHOT_VERSION);
+    put_u32(out + 12, static_cast<uint32_t>(HEADER_SIZE));
+    put_u32(out + 16, static_cast<uint32_t>(header.rows));
+    put_u32(out + 20, static_cast<uint32_t>(header.cols));
+    put_u32(out + 24, static_cast<uint32_t>(header.states));
+    put_u32(out + 28, static_cast<uint32_t>(header.neighborhood_radius));
+    out[32] = static_cast<uint8_t>(header.dimensions);
+    out[33] = static_cast<uint8_t>(header.neighborhood);
+    out[34] = static_cast<uint8_t>(header.boundaries);
+    out[35] = static_cast<uint8_t>(header.rule);
+    out[36] = static_cast<uint8_t>(header.bits_per_cell);
+    out[37] = static_cast<uint8_t>(header.encoding);
+    out[38] = static_cast<uint8_t>(header.keyframe_interval);
+    out[39] = static_cast<uint8_t>(header.keyframe_interval >> 8);
+    put_u64(out + 40, header.seed);
+    put_u64(out + 48, header.num_frames);
+    put_u64(out + 56, header.index_offset);
+}
+
+static bool decode_header(const uint8_t *in, size_t size, SnapshotHeader &header)
+{
+    if (size < HEADER_SIZE || std::memcmp(in, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        get_u32(in + 8) != SNAPSHOT_VERSION || get_u32(in + 12) != HEADER_SIZE)
+    {
+        return false;
+    }
+    header.rows = static_cast<int>(get_u32(in + 16));
+    header.cols = static_cast<int>(get_u32(in + 20));
+    header.states = static_cast<int>(get_u32(in + 24));
+    header.neighborhood_radius = static_cast<int>(get_u32(in + 28));
+    header.dimensions = static_cast<DimensionType>(in[32]);
+    header.neighborhood = static_cast<NeighborhoodType>(in[33]);
+    header.boundaries = static_cast<BoundaryType>(in[34]);
+    header.rule = static_cast<RuleType>(in[35]);
+    header.bits_per_cell = in[36];
+    header.encoding = static_cast<SnapshotEncoding>(in[37]);
+    header.keyframe_interval = in[38] | (in[39] << 8);
+    header.seed = get_u64(in + 40);
+    header.num_frames = get_u64(in + 48);
+    header.index_offset = get_u64(in + 56);
+    return header.rows >= 0 && header.cols >= 0 && header.bits_per_cell == bits_for_states(header.states);
+}
+
+// Default constructor
+SnapshotWriter::SnapshotWriter() : header(), offset(0), max_state(0), overflow(false), is_open(false) {}
+
+// Destructor, writes the index if the file is still open
+SnapshotWriter::~SnapshotWriter()
+{
+    close();
+}
+
+// Helper function that creates the file and writes a provisional header
+// Inputs:
+//      path : Path of the file
+// Returns:
+//      True if the file was created
+bool SnapshotWriter::open_file(const std::string &path)
+{
+    close();
+    header.bits_per_cell = bits_for_states(header.states);
+    header.num_frames = 0;
+    header.index_offset = 0;
+    max_state = header.bits_per_cell == 32 ? 0xFFFFFFFFu : (1u << header.bits_per_cell) - 1;
+
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Error opening " << path << " for writing." << std::endl;
+        return false;
+    }
+
+    packed.assign(packed_size(header), 0);
+    previous.assign(packed.size(), 0);
+    index.clear();
+
+    uint8_t bytes[HEADER_SIZE];
+    encode_header(header, bytes);
+    file.write(reinterpret_cast<const char *>(bytes), HEADER_SIZE);
+    offset = HEADER_SIZE;
+    is_open = true;
+    return file.good();
+}
+
+// Helper function that clears the packed cells before a frame is packed
+void SnapshotWriter::begin_frame()
+{
+    std::fill(packed.begin(), packed.end(), 0);
+    overflow = false;
+}
+
+// Helper function that packs the cells of one row into the current frame
+// Inputs:
+//      row : Index of the row
+//      cells : The cols cells of the row
+template <typename T>
+void SnapshotWriter::pack_cells(int row, const T *cells)
+{
+    const int bits = header.bits_per_cell;
+    const uint64_t first = static_cast<uint64_t>(row) * header.cols;
+    uint32_t largest = 0;
+
+    if (bits >= 8)
+    {
+        const int bytes = bits / 8;
+        uint8_t *out = &packed[first * bytes];
+        for (int j = 0; j < header.cols; ++j)
+        {
+            uint32_t value = static_cast<uint32_t>(cells[j]);
+            largest = std::max(largest, value);
+            for (int b = 0; b < bytes; ++b)
+                out[j * bytes + b] = static_cast<uint8_t>(value >> (8 * b));
+        }
+    }
+    else
+    {
+        for (int j = 0; j < header.cols; ++j)
+        {
+            uint32_t value = static_cast<uint32_t>(cells[j]);
+            largest = std::max(largest, value);
+            uint64_t bit = (first + j) * bits;
+            packed[bit >> 3] |= static_cast<uint8_t>((value & max_state) << (bit & 7));
+        }
+    }
+
+    if (largest > max_state)
+    {
+        overflow = true;
+    }
+}
+
+void SnapshotWriter::pack_row(int row, const int *cells)
+{
+    pack_cells(row, cells);
+}
+
+void SnapshotWriter::pack_row(int row, const uint16_t *cells)
+{
+    pack_cells(row, cells);
+}
+
+void SnapshotWriter::pack_row(int row, const uint8_t *cells)
+{
+    pack_cells(row, cells);
+}
+
+// Helper function that encodes the packed cells and appends them as a frame
+// Inputs:
+//      generation : Generation of the frame
+// Returns:
+//      True if the frame was written
+bool SnapshotWriter::write_packed_frame(uint64_t generation)
+{
+    if (overflow)
+    {
+        std::cerr << "Error: Cell state does not fit in the " << header.bits_per_cell
+                  << " bits per cell of the snapshot." << std::endl;
+        return false;
+    }
+
+    // Keep the encoding that gives the smallest frame; a frame that is not a
+    // difference is a keyframe
+    FrameEncoding frame_encoding = FRAME_PACKED;
+    if (header.encoding == SNAPSHOT_DELTA && header.num_frames % header.keyframe_interval != 0)
+    {
+        rle_encode(packed.data(), previous.data(), packed.size(), encoded);
+        if (encoded.size() < packed.size())
+            frame_encoding = FRAME_DELTA_RLE;
+    }
+    if (frame_encoding == FRAME_PACKED && header.encoding != SNAPSHOT_PACKED)
+    {
+        rle_encode(packed.data(), nullptr, packed.size(), encoded);
+        if (encoded.size() < packed.size())
+            frame_encoding = FRAME_RLE;
+    }
+    const std::vector<uint8_t> &payload = (frame_encoding == FRAME_PACKED) ? packed : encoded;
+
+    uint8_t frame_header[FRAME_HEADER_SIZE] = {};
+    put_u64(frame_header, generation);
+    put_u64(frame_header + 8, payload.size());
+    put_u32(frame_header + 16, frame_encoding);
+    file.write(reinterpret_cast<const char *>(frame_header), FRAME_HEADER_SIZE);
+    file.write(reinterpret_cast<const char *>(payload.data()), payload.size());
+
+    uint8_t entry[INDEX_ENTRY_SIZE] = {};
+    put_u64(entry, generation);
+    put_u64(entry + 8, offset);
+    put_u64(entry + 16, payload.size());
+    put_u32(entry + 24, frame_encoding);
+    index.insert(index.end(), entry, entry + INDEX_ENTRY_SIZE);
+
+    offset += FRAME_HEADER_SIZE + payload.size();
+    ++header.num_frames;
+    if (header.encoding == SNAPSHOT_DELTA)
+    {
+        previous.swap(packed);
+    }
+    return file.good();
+}
+
+// Function to write the index and close the file
+// Returns:
+//      True if the whole file was written
+bool SnapshotWriter::close()
+{
+    if (!is_open)
+    {
+        return false;
+    }
+    is_open = false;
+
+    header.index_offset = offset;
+    file.write(reinterpret_cast<const char *>(index.data()), index.size());
+
+    uint8_t bytes[HEADER_SIZE];
+    encode_header(header, bytes);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(bytes), HEADER_SIZE);
+
+    bool written = file.good();
+    file.close();
+    return written;
+}
+
+// Getter method to get the number of frames written so far
+uint64_t SnapshotWriter::get_num_frames() const
+{
+    return header.num_frames;
+}
+
+// Getter method to get the size of the file so far (without the index)
+uint64_t SnapshotWriter::get_bytes_written() const
+{
+    return offset;
+}
+
+// Default constructor
+SnapshotReader::SnapshotReader() : data(nullptr), size(0), header(), decoded_frame(-1) {}
+
+// Destructor, unmaps the file
+SnapshotReader::~SnapshotReader()
+{
+    close();
+}
+
+// Function to map a snapshot file
+// Files without an index (for example from a run that stopped before the
+// writer was closed) are scanned frame by frame instead.
+// Inputs:
+//      path : Path of the file
+// Returns:
+//      True if the file is a valid snapshot
+bool SnapshotReader::open(const std::string &path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Error opening " << path << " for reading." << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < HEADER_SIZE)
+    {
+        std::cerr << "Error: " << path << " is not a snapshot file." << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    size = static_cast<size_t>(info.st_size);
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "Error mapping " << path << "." << std::endl;
+        size = 0;
+        return false;
+    }
+    data = static_cast<const uint8_t *>(mapping);
+
+    if (!decode_header(data, size, header) || !(read_index() || scan_frames()))
+    {
+        std::cerr << "Error: " << path << " is not a valid snapshot file." << std::endl;
+        close();
+        return false;
+    }
+    packed.assign(packed_size(header), 0);
+    decoded_frame = -1;
+    return true;
+}
+
+// Function to unmap the file
+void SnapshotReader::close()
+{
+    if (data != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(data), size);
+    }
+    data = nullptr;
+    size = 0;
+    generations.clear();
+    offsets.clear();
+    payload_sizes.clear();
+    encodings.clear();
+    decoded_frame = -1;
+}
+
+// Helper function that loads the frame index written at the end of the file
+// Returns:
+//      True if the index is present and consistent
+bool SnapshotReader::read_index()
+{
+    uint64_t frames = header.num_frames;
+    if (header.index_offset < HEADER_SIZE || header.index_offset > size ||
+        frames > (size - header.index_offset) / INDEX_ENTRY_SIZE)
+    {
+        return false;
+    }
+
+    generations.resize(frames);
+    offsets.resize(frames);
+    payload_sizes.resize(frames);
+    encodings.resize(frames);
+    for (uint64_t f = 0; f < frames; ++f)
+    {
+        const uint8_t *entry = data + header.index_offset + f * INDEX_ENTRY_SIZE;
+        generations[f] = get_u64(entry);
+        offsets[f] = get_u64(entry + 8) + FRAME_HEADER_SIZE;
+        payload_sizes[f] = get_u64(entry + 16);
+        encodings[f] = get_u32(entry + 24);
+        if (offsets[f] > header.index_offset || payload_sizes[f] > header.index_offset - offsets[f])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Helper function that rebuilds the frame index by walking the frames
+// A frame cut short at the end of the file is ignored.
+// Returns:
+//      True (a file without frames is valid)
+bool SnapshotReader::scan_frames()
+{
+    generations.clear();
+    offsets.clear();
+    payload_sizes.clear();
+    encodings.clear();
+
+    uint64_t position = HEADER_SIZE;
+    uint64_t end = (header.index_offset >= HEADER_SIZE && header.index_offset <= size) ? header.index_offset : size;
+    while (end - position >= FRAME_HEADER_SIZE)
+    {
+        const uint8_t *frame = data + position;
+        uint64_t payload = get_u64(frame + 8);
+        if (payload > end - position - FRAME_HEADER_SIZE)
+        {
+            break;
+        }
+        generations.push_back(get_u64(frame));
+        offsets.push_back(position + FRAME_HEADER_SIZE);
+        payload_sizes.push_back(payload);
+        encodings.push_back(get_u32(frame + 16));
+        position += FRAME_HEADER_SIZE + payload;
+    }
+    header.num_frames = generations.size();
+    return true;
+}
+
+// Helper function that decodes a frame into the packed cells
+// Difference frames are applied on top of the last keyframe before them, or
+// on top of the previously decoded frame when reading forward.
+// Inputs:
+//      frame : Index of the frame
+// Returns:
+//      True if the frame was decoded
+bool SnapshotReader::decode_frame(size_t frame)
+{
+    if (frame >= generations.size())
+    {
+        return false;
+    }
+    if (decoded_frame == static_cast<long long>(frame))
+    {
+        return true;
+    }
+
+    size_t keyframe = frame;
+    while (keyframe > 0 && encodings[keyframe] == FRAME_DELTA_RLE)
+    {
+        --keyframe;
+    }
+
+    size_t next;
+    if (decoded_frame >= static_cast<long long>(keyframe) && decoded_frame < static_cast<long long>(frame))
+    {
+        next = static_cast<size_t>(decoded_frame) + 1;
+    }
+    else
+    {
+        decoded_frame = -1;
+        const uint8_t *payload = data + offsets[keyframe];
+        bool valid = false;
+        if (encodings[keyframe] == FRAME_PACKED && payload_sizes[keyframe] == packed.size())
+        {
+            std::memcpy(packed.data(), payload, packed.size());
+            valid = true;
+        }
+        else if (encodings[keyframe] == FRAME_RLE)
+        {
+            valid = rle_decode(payload, payload_sizes[keyframe], packed.data(), packed.size(), false);
+        }
+        if (!valid)
+        {
+            return false;
+        }
+        next = keyframe + 1;
+    }
+
+    for (size_t f = next; f <= frame; ++f)
+    {
+        if (!rle_decode(data + offsets[f], payload_sizes[f], packed.data(), packed.size(), true))
+        {
+            decoded_frame = -1;
+            return false;
+        }
+    }
+    decoded_frame = static_cast<long long>(frame);
+    return true;
+}
+
+// Getter method to get the header of the file
+const SnapshotHeader &SnapshotReader::get_header() const
+{
+    return header;
+}
+
+// Getter method to get the number of frames in the file
+size_t SnapshotReader::get_num_frames() const
+{
+    return generations.size();
+}
+
+// Getter method to get the generation a frame was saved at
+uint64_t SnapshotReader::get_frame_generation(size_t frame) const
+{
+    return generations.at(frame);
+}
+
+// Function that finds the frame saved at a generation
+// Inputs:
+//      generation : The generation to look for
+// Returns:
+//      Index of the frame, or -1 if the generation was not saved
+long long SnapshotReader::find_generation(uint64_t generation) const
+{
+    auto found = std::lower_bound(generations.begin(), generations.end(), generation);
+    if (found != generations.end() && *found == generation)
+    {
+        return found - generations.begin();
+    }
+    // Generations are increasing unless the writer was fed an older model
+    found = std::find(generations.begin(), generations.end(), generation);
+    return found == generations.end() ? -1 : found - generations.begin();
+}
+
+// Function that reads the cells of a frame
+// Inputs:
+//      frame : Index of the frame
+//      cells : The rows * cols states, in row-major order
+// Returns:
+//      True if the frame was read
+bool SnapshotReader::read_frame(size_t frame, std::vector<int> &cells)
+{
+    if (!decode_frame(frame))
+    {
+        return false;
+    }
+
+    const int bits = header.bits_per_cell;
+    const uint64_t count = static_cast<uint64_t>(header.rows) * header.cols;
+    cells.resize(count);
+    if (bits >= 8)
+    {
+        const int bytes = bits / 8;
+        for (uint64_t c = 0; c < count; ++c)
+        {
+            uint32_t value = 0;
+            for (int b = 0; b < bytes; ++b)
+                value |= static_cast<uint32_t>(packed[c * bytes + b]) << (8 * b);
+            cells[c] = static_cast<int>(value);
+        }
+    }
+    else
+    {
+        const uint32_t mask = (1u << bits) - 1;
+        for (uint64_t c = 0; c < count; ++c)
+        {
+            uint64_t bit = c * bits;
+            cells[c] = (packed[bit >> 3] >> (bit & 7)) & mask;
+        }
+    }
+    return true;
+}
+
+// Function that reads the cells of a frame as a grid (see set_grid)
+// Inputs:
+//      frame : Index of the frame
+//      grid : The rows x cols states
+// Returns:
+//      True if the frame was read
+bool SnapshotReader::read_frame(size_t frame, std::vector<std::vector<int>> &grid)
+{
+    std::vector<int> cells;
+    if (!read_frame(frame, cells))
+    {
+        return false;
+    }
+    grid.resize(header.rows);
+    for (int i = 0; i < header.rows; ++i)
+    {
+        grid[i].assign(cells.begin() + static_cast<size_t>(i) * header.cols,
+                       cells.begin() + static_cast<size_t>(i + 1) * header.cols);
+    }
+    return true;
+}
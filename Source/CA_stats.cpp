@@ -0,0 +1,292 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the state histogram filled by the compute functions and
+// the time series of per-generation statistics, with its columnar file format.
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <vector>
+#include "CA_stats.h"
+#include "CA_endian.h"
+
+static const char STATS_MAGIC[8] = {'C', 'A', 'S', 'T', 'A', 'T', 'S', '1'};
+static const uint32_t STATS_VERSION = 1;
+
+// Constructor for a histogram of states 0 to num_states - 1
+// Inputs:
+//      num_states : Number of states counted
+StateHistogram::StateHistogram(int num_states) : counts(num_states > 0 ? num_states : 0, 0) {}
+
+// Getter method to get the number of states counted
+int StateHistogram::get_num_states() const
+{
+    return static_cast<int>(counts.size());
+}
+
+// Function that adds the counts of one band
+// Inputs:
+//      band_counts : Number of cells of the band in every state
+void StateHistogram::merge(const std::vector<uint64_t> &band_counts)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    for (size_t state = 0; state < counts.size() && state < band_counts.size(); ++state)
+    {
+        counts[state] += band_counts[state];
+    }
+}
+
+// Getter method to get the number of cells in every state
+const std::vector<uint64_t> &StateHistogram::get_counts() const
+{
+    return counts;
+}
+
+// Default constructor
+StatisticsSeries::StatisticsSeries() : num_states(0) {}
+
+// Function to remove every sample
+void StatisticsSeries::clear()
+{
+    num_states = 0;
+    generations.clear();
+    counts.clear();
+    p_values.clear();
+    q_values.clear();
+    heterozygosity.clear();
+}
+
+// Function to append the statistics of a generation
+// The number of states is fixed by the first sample; later samples with more
+// states are truncated and samples with fewer are padded with zeros.
+// Inputs:
+//      generation : Generation of the sample
+//      state_counts : Number of cells in every state
+void StatisticsSeries::add(uint64_t generation, const std::vector<uint64_t> &state_counts)
+{
+    if (generations.empty())
+    {
+        num_states = static_cast<int>(state_counts.size());
+        counts.assign(num_states, std::vector<uint64_t>());
+    }
+
+    generations.push_back(generation);
+    for (int state = 0; state < num_states; ++state)
+    {
+        counts[state].push_back(state < static_cast<int>(state_counts.size()) ? state_counts[state] : 0);
+    }
+
+    // HomozygousDominant = 1, Heterozygous = 2, Recessive = 3
+    uint64_t dominant = num_states > 1 ? counts[1].back() : 0;
+    uint64_t heterozygous = num_states > 2 ? counts[2].back() : 0;
+    uint64_t recessive = num_states > 3 ? counts[3].back() : 0;
+    uint64_t individuals = dominant + heterozygous + recessive;
+
+    double p = individuals > 0 ? (2.0 * dominant + heterozygous) / (2.0 * individuals) : 0.0;
+    p_values.push_back(p);
+    q_values.push_back(individuals > 0 ? 1.0 - p : 0.0);
+    heterozygosity.push_back(individuals > 0 ? static_cast<double>(heterozygous) / individuals : 0.0);
+}
+
+// Getter method to get the number of samples
+size_t StatisticsSeries::size() const
+{
+    return generations.size();
+}
+
+// Getter method to get the number of states counted in every sample
+int StatisticsSeries::get_num_states() const
+{
+    return num_states;
+}
+
+// Getter methods to get one value of a sample
+// Inputs:
+//      sample : Index of the sample (in the order they were added)
+uint64_t StatisticsSeries::get_generation(size_t sample) const
+{
+    return generations.at(sample);
+}
+
+uint64_t StatisticsSeries::get_count(size_t sample, int state) const
+{
+    return (state >= 0 && state < num_states) ? counts[state].at(sample) : 0;
+}
+
+double StatisticsSeries::get_p(size_t sample) const
+{
+    return p_values.at(sample);
+}
+
+double StatisticsSeries::get_q(size_t sample) const
+{
+    return q_values.at(sample);
+}
+
+double StatisticsSeries::get_heterozygosity(size_t sample) const
+{
+    return heterozygosity.at(sample);
+}
+
+// Getter methods to get whole columns
+const std::vector<uint64_t> &StatisticsSeries::get_generations() const
+{
+    return generations;
+}
+
+const std::vector<uint64_t> &StatisticsSeries::get_counts(int state) const
+{
+    return counts.at(state);
+}
+
+const std::vector<double> &StatisticsSeries::get_p_values() const
+{
+    return p_values;
+}
+
+const std::vector<double> &StatisticsSeries::get_q_values() const
+{
+    return q_values;
+}
+
+const std::vector<double> &StatisticsSeries::get_heterozygosity_values() const
+{
+    return heterozygosity;
+}
+
+// Helper functions that convert a column value to and from its 64-bit pattern
+static uint64_t to_bits(uint64_t value)
+{
+    return value;
+}
+
+static uint64_t to_bits(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static void from_bits(uint64_t bits, uint64_t &value)
+{
+    value = bits;
+}
+
+static void from_bits(uint64_t bits, double &value)
+{
+    std::memcpy(&value, &bits, sizeof(value));
+}
+
+// Helper functions that write and read a column as little-endian 64-bit values
+template <typename T>
+static void write_column(std::ofstream &file, const std::vector<T> &column)
+{
+    std::vector<uint8_t> bytes(column.size() * 8);
+    for (size_t sample = 0; sample < column.size(); ++sample)
+    {
+        put_u64(&bytes[sample * 8], to_bits(column[sample]));
+    }
+    file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+}
+
+template <typename T>
+static bool read_column(std::ifstream &file, std::vector<T> &column, uint64_t samples)
+{
+    std::vector<uint8_t> bytes(samples * 8);
+    if (!file.read(reinterpret_cast<char *>(bytes.data()), bytes.size()))
+    {
+        return false;
+    }
+    column.resize(samples);
+    for (size_t sample = 0; sample < samples; ++sample)
+    {
+        from_bits(get_u64(&bytes[sample * 8]), column[sample]);
+    }
+    return true;
+}
+
+// Function to save the series as a columnar binary file
+// Inputs:
+//      path : Path of the file
+// Returns:
+//      True if the file was written
+bool StatisticsSeries::write(const std::string &path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Error opening " << path << " for writing." << std::endl;
+        return false;
+    }
+
+    uint8_t header[32] = {};
+    std::memcpy(header, STATS_MAGIC, sizeof(STATS_MAGIC));
+    put_u32(header + 8, STATS_VERSION);
+    put_u32(header + 12, static_cast<uint32_t>(num_states));
+    put_u64(header + 16, generations.size());
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+    write_column(file, generations);
+    for (const std::vector<uint64_t> &column : counts)
+    {
+        write_column(file, column);
+    }
+    write_column(file, p_values);
+    write_column(file, q_values);
+    write_column(file, heterozygosity);
+    return file.good();
+}
+
+// Function to load a series saved with write
+// Inputs:
+//      path : Path of the file
+// Returns:
+//      True if the file was read
+bool StatisticsSeries::read(const std::string &path)
+{
+    clear();
+    std::ifstream file(path, std::ios::binary);
+    uint8_t header[32];
+    if (!file.read(reinterpret_cast<char *>(header), sizeof(header)) || std::memcmp(header, STATS_MAGIC, sizeof(STATS_MAGIC)) != 0)
+    {
+        std::cerr << "Error: " << path << " is not a statistics file." << std::endl;
+        return false;
+    }
+
+    uint32_t version = get_u32(header + 8);
+    uint32_t states = get_u32(header + 12);
+    uint64_t samples = get_u64(header + 16);
+    if (version != STATS_VERSION)
+    {
+        std::cerr << "Error: " << path << " has an unsupported version." << std::endl;
+        return false;
+    }
+
+    // The columns (generations, the counts of every state, p, q and the
+    // heterozygosity) must fit in the file before anything is allocated
+    file.seekg(0, std::ios::end);
+    uint64_t column_bytes = static_cast<uint64_t>(file.tellg()) - sizeof(header);
+    file.seekg(sizeof(header));
+    if (states > static_cast<uint32_t>(INT32_MAX) || samples > column_bytes / 8 / (states + uint64_t(4)))
+    {
+        std::cerr << "Error: " << path << " is truncated." << std::endl;
+        return false;
+    }
+
+    num_states = static_cast<int>(states);
+    counts.assign(num_states, std::vector<uint64_t>());
+    bool valid = read_column(file, generations, samples);
+    for (std::vector<uint64_t> &column : counts)
+    {
+        valid = valid && read_column(file, column, samples);
+    }
+    valid = valid && read_column(file, p_values, samples) && read_column(file, q_values, samples) &&
+            read_column(file, heterozygosity, samples);
+    if (!valid)
+    {
+        std::cerr << "Error: " << path << " is truncated." << std::endl;
+        clear();
+    }
+    return valid;
+}
@@ -0,0 +1,125 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the persistent thread pool used by the cellular
+// automata library. The workers are started once and then wait for jobs,
+// so a generation does not pay for creating threads.
+
+#include <algorithm>
+#include "CA_threadpool.h"
+
+// Constructor starting the worker threads
+// Inputs:
+//      num_threads : Total number of threads, including the calling thread
+ThreadPool::ThreadPool(int num_threads)
+    : task(nullptr), begin(0), end(0), bands(0), job(0), pending(0), stopping(false)
+{
+    for (int band = 1; band < num_threads; ++band)
+    {
+        workers.emplace_back(&ThreadPool::worker_loop, this, band);
+    }
+}
+
+// Destructor that stops and joins the worker threads
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start_cv.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+// Getter method to get the number of threads (workers and calling thread)
+int ThreadPool::get_num_threads() const
+{
+    return static_cast<int>(workers.size()) + 1;
+}
+
+// Helper function that runs one band of the current job
+// Inputs:
+//      band : Index of the band; bands are contiguous and in order
+void ThreadPool::run_band(int band)
+{
+    long long size = static_cast<long long>(end) - begin;
+    int band_begin = begin + static_cast<int>(size * band / bands);
+    int band_end = begin + static_cast<int>(size * (band + 1) / bands);
+    if (band_begin < band_end)
+    {
+        (*task)(band_begin, band_end);
+    }
+}
+
+// Loop run by every worker: wait for a job, run its band, report completion
+// Inputs:
+//      band : Index of the band this worker runs
+void ThreadPool::worker_loop(int band)
+{
+    int seen_job = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_cv.wait(lock, [&] { return stopping || job != seen_job; });
+            if (stopping)
+            {
+                return;
+            }
+            seen_job = job;
+            if (band >= bands)
+            {
+                continue;
+            }
+        }
+
+        run_band(band);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0)
+            {
+                done_cv.notify_one();
+            }
+        }
+    }
+}
+
+// Function that runs task over [begin, end) split into contiguous bands
+// The calling thread runs the first band and waits for the others.
+// Inputs:
+//      begin, end : Range of indices (for example grid rows) to split
+//      task : Function called as task(band_begin, band_end)
+//      max_bands : Largest number of bands to split the range into
+void ThreadPool::parallel_for(int begin, int end, const BandFunction &task, int max_bands)
+{
+    int num_bands = std::min(std::min(get_num_threads(), max_bands), end - begin);
+    if (num_bands <= 1)
+    {
+        if (begin < end)
+        {
+            task(begin, end);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(run_mutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        this->begin = begin;
+        this->end = end;
+        bands = num_bands;
+        pending = num_bands - 1;
+        ++job;
+    }
+    start_cv.notify_all();
+
+    run_band(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cv.wait(lock, [&] { return pending == 0; });
+}
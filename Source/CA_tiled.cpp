@@ -0,0 +1,535 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the implementation of the out-of-core mode of the
+// cellular automata library. The grid file is a 4096-byte header followed by
+// the rows of the grid. A generation is computed in place, tile by tile from
+// the first row: before a tile is written, its last radius rows are kept in
+// memory for the ghost rows of the next tile, and the first radius rows of
+// the grid are kept for the last tile of periodic grids. The page cache
+// streams the file: the next tile is prefetched with MADV_WILLNEED, written
+// tiles are flushed asynchronously, and tiles further behind than the working
+// set are synced and dropped with MADV_DONTNEED.
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "CA_tiled.h"
+
+namespace
+{
+const char TILED_MAGIC[8] = {'C', 'A', 'T', 'I', 'L', 'E', 'D', '1'};
+const uint32_t TILED_VERSION = 1;
+const size_t TILED_GRID_OFFSET = 4096; // the rows start on a page
+
+// Header at the start of a grid file
+struct TiledHeader
+{
+    char magic[8];        // TILED_MAGIC
+    uint32_t version;     // TILED_VERSION
+    uint32_t cell_bytes;  // size of one cell
+    int32_t rows;         // number of rows in the grid
+    int32_t cols;         // number of columns in the grid
+    uint64_t generation;  // number of generations computed so far
+    uint64_t grid_offset; // offset of the first row
+};
+
+// Helper function that returns the size of a page
+size_t page_bytes()
+{
+    static const size_t bytes = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return bytes;
+}
+}
+
+// Default constructor
+template <typename CellT>
+BasicTiledAutomata<CellT>::BasicTiledAutomata()
+    : fd(-1), mapping(nullptr), mapping_bytes(0), grid_offset(TILED_GRID_OFFSET), rows(0), cols(0), radius(1),
+      tile_rows(0), resident_tiles(0), bins(0), boundaries(PERIODIC), k(0), collect_statistics(false), generation(0)
+{
+}
+
+// Destructor (flushes and closes the file)
+template <typename CellT>
+BasicTiledAutomata<CellT>::~BasicTiledAutomata()
+{
+    close();
+}
+
+// Helper function that returns a row of the grid file
+template <typename CellT>
+CellT *BasicTiledAutomata<CellT>::grid_row(int row) const
+{
+    return reinterpret_cast<CellT *>(static_cast<char *>(mapping) + grid_offset) + static_cast<size_t>(row) * cols;
+}
+
+// Helper function that passes advice about rows of the grid file to the kernel
+// MADV_WILLNEED covers every page the rows touch; MADV_DONTNEED only the pages
+// that lie entirely inside the rows, so no page of another tile is dropped.
+// Inputs:
+//      first : First row (clamped to the grid)
+//      count : Number of rows
+//      advice : MADV_WILLNEED or MADV_DONTNEED
+template <typename CellT>
+void BasicTiledAutomata<CellT>::advise_rows(int first, int count, int advice) const
+{
+    int last = std::min(first + count, rows);
+    first = std::max(first, 0);
+    if (first >= last)
+    {
+        return;
+    }
+    const size_t page = page_bytes();
+    size_t begin = reinterpret_cast<char *>(grid_row(first)) - static_cast<char *>(mapping);
+    size_t end = reinterpret_cast<char *>(grid_row(last)) - static_cast<char *>(mapping);
+    if (advice == MADV_DONTNEED)
+    {
+        begin = (begin + page - 1) / page * page;
+        end = end / page * page;
+        if (begin >= end)
+        {
+            return;
+        }
+        msync(static_cast<char *>(mapping) + begin, end - begin, MS_SYNC);
+    }
+    else
+    {
+        begin = begin / page * page;
+    }
+    madvise(static_cast<char *>(mapping) + begin, end - begin, advice);
+}
+
+// Helper function that flushes a written tile behind the computation
+// The tile is handed to writeback without waiting for it; the tile that is
+// resident_tiles behind it is synced (by then its writeback has usually
+// finished) and dropped from memory.
+// Inputs:
+//      tile : The tile that was just written
+template <typename CellT>
+void BasicTiledAutomata<CellT>::write_behind(int tile)
+{
+    const size_t page = page_bytes();
+    size_t begin = reinterpret_cast<char *>(grid_row(tile * tile_rows)) - static_cast<char *>(mapping);
+    size_t end = reinterpret_cast<char *>(grid_row(std::min((tile + 1) * tile_rows, rows))) -
+                 static_cast<char *>(mapping);
+    begin = begin / page * page;
+    msync(static_cast<char *>(mapping) + begin, end - begin, MS_ASYNC);
+
+    int released = tile - resident_tiles;
+    if (released >= 0)
+    {
+        advise_rows(released * tile_rows, tile_rows, MADV_DONTNEED);
+    }
+}
+
+// Helper function that opens and maps a grid file
+// Inputs:
+//      path : Path of the grid file
+//      create_file : Create the file for rows x cols cells (otherwise its header is read)
+// Returns:
+//      True if the file was mapped
+template <typename CellT>
+bool BasicTiledAutomata<CellT>::map_file(const std::string &path, bool create_file)
+{
+    fd = ::open(path.c_str(), create_file ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "Error opening " << path << " for the tiled grid." << std::endl;
+        return false;
+    }
+
+    if (create_file)
+    {
+        grid_offset = TILED_GRID_OFFSET;
+        mapping_bytes = grid_offset + static_cast<size_t>(rows) * cols * sizeof(CellT);
+        if (ftruncate(fd, static_cast<off_t>(mapping_bytes)) != 0)
+        {
+            std::cerr << "Error: Could not size " << path << " for the tiled grid." << std::endl;
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+    }
+    else
+    {
+        TiledHeader header;
+        struct stat status;
+        bool valid = pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                     std::memcmp(header.magic, TILED_MAGIC, sizeof(TILED_MAGIC)) == 0 &&
+                     header.version == TILED_VERSION && header.cell_bytes == sizeof(CellT) && header.rows > 0 &&
+                     header.cols > 0 && fstat(fd, &status) == 0;
+        if (valid)
+        {
+            rows = header.rows;
+            cols = header.cols;
+            generation = header.generation;
+            grid_offset = header.grid_offset;
+            mapping_bytes = grid_offset + static_cast<size_t>(rows) * cols * sizeof(CellT);
+            valid = static_cast<size_t>(status.st_size) >= mapping_bytes;
+        }
+        if (!valid)
+        {
+            std::cerr << "Error: " << path << " is not a tiled grid of this cell width." << std::endl;
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+    }
+
+    mapping = mmap(nullptr, mapping_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "Error: Could not map " << path << "." << std::endl;
+        mapping = nullptr;
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    // Tiles are read in order, and each page once per generation
+    madvise(mapping, mapping_bytes, MADV_SEQUENTIAL);
+    return true;
+}
+
+// Helper function that copies the configuration of a model into the tile models
+// Inputs:
+//      model : Configured 2D model
+//      tile_rows : Number of rows in a tile
+//      resident_tiles : Computed tiles kept in memory behind the current tile
+// Returns:
+//      True if the configuration can be tiled
+template <typename CellT>
+bool BasicTiledAutomata<CellT>::configure(const BasicCellularAutomata<CellT> &model, int tile_rows,
+                                           int resident_tiles)
+{
+    if (model.get_dimensions() != TWO_DIMENSIONAL)
+    {
+        std::cerr << "Error: The out-of-core mode only tiles 2D grids." << std::endl;
+        return false;
+    }
+    radius = model.get_neighborhood_radius();
+    if (rows < radius || cols <= 0)
+    {
+        std::cerr << "Error: The tiled grid needs at least one column and radius rows." << std::endl;
+        return false;
+    }
+
+    // A tile holds at least radius rows, so the ghost rows of a tile only come from its neighbors
+    this->tile_rows = std::max(radius, std::min(tile_rows, rows));
+    this->resident_tiles = std::max(resident_tiles, 0);
+    bins = std::max(model.get_states(), 3) + 1;
+    boundaries = model.get_boundaries();
+    k = model.get_k();
+    collect_statistics = model.get_statistics_enabled();
+    statistics.clear();
+
+    // The tile models compute every generation directly, on the threads of the model
+    int last_rows = rows % this->tile_rows;
+    BasicCellularAutomata<CellT> *models[] = {&tile_model, &last_model};
+    for (int index = 0; index < (last_rows > 0 ? 2 : 1); ++index)
+    {
+        BasicCellularAutomata<CellT> &local = *models[index];
+        local = model;
+        local.set_num_threads(model.get_num_threads());
+        local.set_statistics(false);
+        local.set_instrumentation(false);
+        if (local.get_engine() == MEMOISED_ENGINE)
+        {
+            local.set_engine(DIRECT_ENGINE);
+        }
+        int local_rows = (index == 0 ? this->tile_rows : last_rows) + 2 * radius;
+        local.set_grid(std::vector<std::vector<int>>(local_rows, std::vector<int>(cols, 0)));
+    }
+    carry_rows.assign(static_cast<size_t>(radius) * cols, 0);
+    wrap_rows.assign(static_cast<size_t>(radius) * cols, 0);
+    return true;
+}
+
+// Helper function that stores the size and the generation in the header of the file
+template <typename CellT>
+void BasicTiledAutomata<CellT>::write_header() const
+{
+    TiledHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TILED_MAGIC, sizeof(TILED_MAGIC));
+    header.version = TILED_VERSION;
+    header.cell_bytes = sizeof(CellT);
+    header.rows = rows;
+    header.cols = cols;
+    header.generation = generation;
+    header.grid_offset = grid_offset;
+    std::memcpy(mapping, &header, sizeof(header));
+}
+
+// Function that creates a grid file, filled with the random states
+// setup_dimensions() gives a model with the same seed and grid size
+// Inputs:
+//      model : Configured 2D model (its grid is not used)
+//      path : Path of the grid file
+//      rows : Number of rows in the grid
+//      cols : Number of columns in the grid
+//      tile_rows : Number of rows in a tile (at least the neighborhood radius)
+//      resident_tiles : Computed tiles kept in memory behind the current tile
+// Returns:
+//      True if the file was created
+template <typename CellT>
+bool BasicTiledAutomata<CellT>::create(const BasicCellularAutomata<CellT> &model, const std::string &path, int rows,
+                                       int cols, int tile_rows, int resident_tiles)
+{
+    close();
+    this->rows = rows;
+    this->cols = cols;
+    generation = 0;
+    if (!configure(model, tile_rows, resident_tiles) || !map_file(path, true))
+    {
+        return false;
+    }
+    write_header();
+
+    // The cells are drawn as setup_dimensions() draws them, and streamed to the file tile by tile
+    CounterRNG rng(model.get_seed());
+    const int states = model.get_states();
+    const int num_tiles = (rows + this->tile_rows - 1) / this->tile_rows;
+    for (int tile = 0; tile < num_tiles; ++tile)
+    {
+        int first = tile * this->tile_rows;
+        int last = std::min(first + this->tile_rows, rows);
+        for (int i = first; i < last; ++i)
+        {
+            CellT *row = grid_row(i);
+            for (int j = 0; j < cols; ++j)
+            {
+                uint64_t cell = static_cast<uint64_t>(i) * cols + j;
+                row[j] = static_cast<CellT>(rng.draw(0, cell, STREAM_SETUP) % states + 1);
+            }
+        }
+        write_behind(tile);
+    }
+    return true;
+}
+
+// Function that opens a grid file created by create(), to resume its run
+// Inputs:
+//      model : Configured 2D model (its grid is not used)
+//      path : Path of the grid file
+//      tile_rows : Number of rows in a tile (at least the neighborhood radius)
+//      resident_tiles : Computed tiles kept in memory behind the current tile
+// Returns:
+//      True if the file was opened
+template <typename CellT>
+bool BasicTiledAutomata<CellT>::open(const BasicCellularAutomata<CellT> &model, const std::string &path,
+                                     int tile_rows, int resident_tiles)
+{
+    close();
+    if (!map_file(path, false))
+    {
+        return false;
+    }
+    if (!configure(model, tile_rows, resident_tiles))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+// Function that flushes and closes the grid file
+template <typename CellT>
+void BasicTiledAutomata<CellT>::close()
+{
+    if (fd < 0)
+    {
+        return;
+    }
+    write_header();
+    msync(mapping, mapping_bytes, MS_SYNC);
+    munmap(mapping, mapping_bytes);
+    ::close(fd);
+    fd = -1;
+    mapping = nullptr;
+    mapping_bytes = 0;
+}
+
+// Function that advances the grid by several generations of the rule of the model
+// Every tile is loaded with radius ghost rows above and below it into a tile
+// model and stepped there. Ghost rows inside the grid come from the rows kept
+// before the previous tile was written, or from the file for the next tile;
+// at the first and last rows they follow the boundaries of the model
+// (periodic: the rows at the other end, fixed: rows in state k, no
+// boundaries: the edge row repeated), as the halo of the in-memory grid does.
+// Inputs:
+//      generations : Number of generations
+template <typename CellT>
+void BasicTiledAutomata<CellT>::step(uint64_t generations)
+{
+    if (!get_open())
+    {
+        return;
+    }
+    const std::vector<CellT> fixed_row(cols, static_cast<CellT>(k));
+    const int num_tiles = (rows + tile_rows - 1) / tile_rows;
+    const size_t ghost_cells = static_cast<size_t>(radius) * cols;
+
+    for (uint64_t g = 0; g < generations; ++g)
+    {
+        std::vector<uint64_t> counts(bins, 0);
+        advise_rows(0, tile_rows + radius, MADV_WILLNEED);
+        if (boundaries == PERIODIC)
+        {
+            advise_rows(rows - radius, radius, MADV_WILLNEED);
+        }
+        std::copy_n(grid_row(0), ghost_cells, wrap_rows.data());
+
+        for (int tile = 0; tile < num_tiles; ++tile)
+        {
+            const int first = tile * tile_rows;
+            const int count = std::min(tile_rows, rows - first);
+            BasicCellularAutomata<CellT> &local = (count == tile_rows) ? tile_model : last_model;
+
+            // Prefetch the next tile while this one is computed
+            if (tile + 1 < num_tiles)
+            {
+                advise_rows(first + tile_rows + radius, tile_rows, MADV_WILLNEED);
+            }
+
+            for (int i = -radius; i < count + radius; ++i)
+            {
+                const int row = first + i;
+                const CellT *source;
+                if (row < 0)
+                {
+                    source = boundaries == PERIODIC ? grid_row(row + rows)
+                             : boundaries == FIXED  ? fixed_row.data()
+                                                    : grid_row(0);
+                }
+                else if (row >= rows)
+                {
+                    source = boundaries == PERIODIC ? &wrap_rows[static_cast<size_t>(row - rows) * cols]
+                             : boundaries == FIXED  ? fixed_row.data()
+                                                    : grid_row(rows - 1);
+                }
+                else if (row < first)
+                {
+                    source = &carry_rows[static_cast<size_t>(row - first + radius) * cols];
+                }
+                else
+                {
+                    source = grid_row(row);
+                }
+                local.set_row(radius + i, source);
+            }
+
+            // The next tile needs the last rows of this one as they were before this generation
+            if (tile + 1 < num_tiles)
+            {
+                std::copy_n(grid_row(first + count - radius), ghost_cells, carry_rows.data());
+            }
+
+            local.step();
+
+            const int last = bins - 1;
+            for (int i = 0; i < count; ++i)
+            {
+                const CellT *row = local.get_row(radius + i);
+                std::copy_n(row, cols, grid_row(first + i));
+                if (collect_statistics)
+                {
+                    for (int j = 0; j < cols; ++j)
+                    {
+                        int state = row[j];
+                        ++counts[state < 0 ? 0 : (state > last ? last : state)];
+                    }
+                }
+            }
+            write_behind(tile);
+        }
+
+        ++generation;
+        if (collect_statistics)
+        {
+            statistics.add(generation, counts);
+        }
+    }
+    write_header();
+}
+
+// Function to copy one row of the grid file
+// Inputs:
+//      row : The row
+//      values : Set to the cols cells of the row
+template <typename CellT>
+void BasicTiledAutomata<CellT>::read_row(int row, CellT *values) const
+{
+    if (!get_open() || row < 0 || row >= rows)
+    {
+        std::cerr << "Error: Row index out of bounds while trying to read a row." << std::endl;
+        return;
+    }
+    std::copy_n(grid_row(row), cols, values);
+}
+
+// Function to set one row of the grid file
+// Inputs:
+//      row : The row
+//      values : The cols cells of the row
+template <typename CellT>
+void BasicTiledAutomata<CellT>::write_row(int row, const CellT *values)
+{
+    if (!get_open() || row < 0 || row >= rows)
+    {
+        std::cerr << "Error: Row index out of bounds while trying to set a row." << std::endl;
+        return;
+    }
+    std::copy_n(values, cols, grid_row(row));
+}
+
+template <typename CellT>
+bool BasicTiledAutomata<CellT>::get_open() const
+{
+    return fd >= 0;
+}
+
+template <typename CellT>
+int BasicTiledAutomata<CellT>::get_grid_rows() const
+{
+    return rows;
+}
+
+template <typename CellT>
+int BasicTiledAutomata<CellT>::get_grid_cols() const
+{
+    return cols;
+}
+
+template <typename CellT>
+int BasicTiledAutomata<CellT>::get_tile_rows() const
+{
+    return tile_rows;
+}
+
+template <typename CellT>
+int BasicTiledAutomata<CellT>::get_resident_tiles() const
+{
+    return resident_tiles;
+}
+
+template <typename CellT>
+uint64_t BasicTiledAutomata<CellT>::get_generation() const
+{
+    return generation;
+}
+
+template <typename CellT>
+const StatisticsSeries &BasicTiledAutomata<CellT>::get_statistics() const
+{
+    return statistics;
+}
+
+// Explicit instantiations for the cell widths of the library
+template class BasicTiledAutomata<int>;
+template class BasicTiledAutomata<uint16_t>;
+template class BasicTiledAutomata<uint8_t>;
@@ -0,0 +1,210 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the window sums used by the compute functions for
+// neighborhoods with a radius larger than 1. A window sum is updated from
+// its neighbor's in O(1) per cell:
+// - Moore (square) windows are separable: a horizontal running sum per row,
+//   then a vertical running sum of those per column.
+// - Von Neumann (diamond) windows slide by adding and removing the four
+//   diagonal edges of the diamond, each read in O(1) from prefix sums along
+//   the diagonals and anti-diagonals of the grid.
+// Only the rows a window can reach are kept, in ring buffers of O(radius)
+// rows per thread, and the sums use modular (unsigned) arithmetic so the
+// prefix sums may wrap around while the window sums stay exact.
+
+#include <vector>
+#include <cstdint>
+#include "CA_window.h"
+
+// Function that returns the value a cell contributes to a window
+// Inputs:
+//      state : State of the cell
+//      match : If negative the state itself; otherwise 1 if state == match, else 0
+template <typename CellT>
+inline uint32_t window_value(CellT state, int match)
+{
+    return match < 0 ? static_cast<uint32_t>(state) : static_cast<uint32_t>(static_cast<int>(state) == match);
+}
+
+// Sums over the (2 * radius + 1) x (2 * radius + 1) square (Moore neighborhood)
+template <typename CellT>
+void moore_window_sums(const CellT *grid, ptrdiff_t stride, int begin, int end, int cols,
+                       int radius, int match, int *sums)
+{
+    const int ring_rows = 2 * radius + 2;
+    static thread_local std::vector<uint32_t> row_sums; // horizontal sums of the rows in reach
+    static thread_local std::vector<uint32_t> column_sums;
+    row_sums.resize(static_cast<size_t>(ring_rows) * cols);
+    column_sums.assign(cols, 0);
+
+    // Horizontal running sum of row q, stored in its ring slot
+    auto horizontal = [&](int q) -> uint32_t * {
+        const CellT *row = grid + static_cast<ptrdiff_t>(q) * stride;
+        uint32_t *out = &row_sums[static_cast<size_t>((q - begin + ring_rows) % ring_rows) * cols];
+        uint32_t sum = 0;
+        for (int c = -radius; c <= radius; ++c)
+        {
+            sum += window_value(row[c], match);
+        }
+        out[0] = sum;
+        for (int j = 1; j < cols; ++j)
+        {
+            sum += window_value(row[j + radius], match) - window_value(row[j - radius - 1], match);
+            out[j] = sum;
+        }
+        return out;
+    };
+
+    for (int q = begin - radius; q <= begin + radius; ++q)
+    {
+        const uint32_t *h = horizontal(q);
+        for (int j = 0; j < cols; ++j)
+        {
+            column_sums[j] += h[j];
+        }
+    }
+
+    for (int i = begin; i < end; ++i)
+    {
+        int *out = sums + static_cast<ptrdiff_t>(i - begin) * cols;
+        for (int j = 0; j < cols; ++j)
+        {
+            out[j] = static_cast<int>(column_sums[j]);
+        }
+
+        if (i + 1 < end)
+        {
+            // Slide the window down: add row i + radius + 1, remove row i - radius
+            const uint32_t *removed = &row_sums[static_cast<size_t>((i - radius - begin + ring_rows) % ring_rows) * cols];
+            for (int j = 0; j < cols; ++j)
+            {
+                column_sums[j] -= removed[j];
+            }
+            const uint32_t *added = horizontal(i + radius + 1);
+            for (int j = 0; j < cols; ++j)
+            {
+                column_sums[j] += added[j];
+            }
+        }
+    }
+}
+
+// Sums over the diamond |di| + |dj| <= radius (Von Neumann neighborhood)
+// Moving the diamond one cell right adds its right edges and removes its left
+// edges; moving it one cell down adds its bottom edges and removes its top
+// edges. Each edge is a segment of a diagonal (down-right) or anti-diagonal
+// (down-left), whose sum is a difference of two prefix sums.
+template <typename CellT>
+void von_neumann_window_sums(const CellT *grid, ptrdiff_t stride, int begin, int end, int cols,
+                             int radius, int match, int *sums)
+{
+    const int r = radius;
+    const int width = cols + 2 * r + 2; // prefix columns -r - 1 .. cols + r
+    const int ring_rows = 2 * r + 3;    // rows i - r - 1 .. i + r + 1
+    const int base = begin - r - 1;     // row above the highest row in reach (all zero)
+    static thread_local std::vector<uint32_t> diagonal; // prefix sums along down-right diagonals
+    static thread_local std::vector<uint32_t> anti;     // prefix sums along down-left diagonals
+    diagonal.assign(static_cast<size_t>(ring_rows) * width, 0);
+    anti.assign(static_cast<size_t>(ring_rows) * width, 0);
+
+    auto slot = [&](int q) { return static_cast<size_t>((q - base) % ring_rows) * width; };
+    auto D = [&](int q, int c) { return diagonal[slot(q) + c + r + 1]; };
+    auto A = [&](int q, int c) { return anti[slot(q) + c + r + 1]; };
+
+    // Sum of the diagonal segment (q1, c1) -> (q2, c2), with q2 - q1 == c2 - c1
+    auto diagonal_segment = [&](int q1, int c1, int q2, int c2) { return D(q2, c2) - D(q1 - 1, c1 - 1); };
+    // Sum of the anti-diagonal segment (q1, c1) -> (q2, c2), with q2 - q1 == c1 - c2
+    auto anti_segment = [&](int q1, int c1, int q2, int c2) { return A(q2, c2) - A(q1 - 1, c1 + 1); };
+
+    // Prefix sums of row q from those of row q - 1 (cells beyond the halo count as 0)
+    int computed = base;
+    auto compute_until = [&](int last) {
+        for (int q = computed + 1; q <= last; ++q)
+        {
+            const CellT *row = grid + static_cast<ptrdiff_t>(q) * stride;
+            uint32_t *d = &diagonal[slot(q)];
+            uint32_t *a = &anti[slot(q)];
+            const uint32_t *d_above = &diagonal[slot(q - 1)];
+            const uint32_t *a_above = &anti[slot(q - 1)];
+
+            d[0] = 0;
+            a[width - 1] = 0;
+            for (int x = 1; x < width - 1; ++x)
+            {
+                uint32_t value = window_value(row[x - r - 1], match);
+                d[x] = value + d_above[x - 1];
+                a[x] = value + a_above[x + 1];
+            }
+            d[width - 1] = d_above[width - 2];
+            a[0] = a_above[1];
+        }
+        computed = last;
+    };
+
+    // Direct sum of the first diamond of the band
+    uint32_t first_column = 0;
+    for (int di = -r; di <= r; ++di)
+    {
+        int half = r - (di < 0 ? -di : di);
+        const CellT *row = grid + static_cast<ptrdiff_t>(begin + di) * stride;
+        for (int dj = -half; dj <= half; ++dj)
+        {
+            first_column += window_value(row[dj], match);
+        }
+    }
+
+    for (int i = begin; i < end; ++i)
+    {
+        compute_until(i + r);
+
+        int *out = sums + static_cast<ptrdiff_t>(i - begin) * cols;
+        uint32_t sum = first_column;
+        out[0] = static_cast<int>(sum);
+        for (int j = 0; j + 1 < cols; ++j)
+        {
+            sum += diagonal_segment(i - r, j + 1, i, j + 1 + r) + anti_segment(i + 1, j + r, i + r, j + 1);
+            sum -= anti_segment(i - r, j, i, j - r) + diagonal_segment(i + 1, j - r + 1, i + r, j);
+            out[j + 1] = static_cast<int>(sum);
+        }
+
+        if (i + 1 < end)
+        {
+            compute_until(i + r + 1);
+            first_column += diagonal_segment(i + 1, -r, i + 1 + r, 0) + anti_segment(i + 1, r, i + r, 1);
+            first_column -= anti_segment(i - r, 0, i, -r) + diagonal_segment(i - r + 1, 1, i, r);
+        }
+    }
+}
+
+// Sums over the 2 * radius + 1 cells around each cell of the 1D line
+template <typename CellT>
+void line_window_sums(const CellT *line, int begin, int end, int radius, int match, int *sums)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+
+    uint32_t sum = 0;
+    for (int c = begin - radius; c <= begin + radius; ++c)
+    {
+        sum += window_value(line[c], match);
+    }
+    sums[0] = static_cast<int>(sum);
+    for (int j = begin + 1; j < end; ++j)
+    {
+        sum += window_value(line[j + radius], match) - window_value(line[j - radius - 1], match);
+        sums[j - begin] = static_cast<int>(sum);
+    }
+}
+
+// The library is compiled for these cell widths
+#define CA_INSTANTIATE_WINDOWS(CellT)                                                                      \
+    template void moore_window_sums<CellT>(const CellT *, ptrdiff_t, int, int, int, int, int, int *);       \
+    template void von_neumann_window_sums<CellT>(const CellT *, ptrdiff_t, int, int, int, int, int, int *); \
+    template void line_window_sums<CellT>(const CellT *, int, int, int, int, int *);
+
+CA_INSTANTIATE_WINDOWS(int)
+CA_INSTANTIATE_WINDOWS(uint16_t)
+CA_INSTANTIATE_WINDOWS(uint8_t)
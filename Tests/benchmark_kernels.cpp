@@ -0,0 +1,225 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the C++ benchmark of the compute functions of the
+// cellular automata library. onedim_rule1-3, twodim_rule1-3, update(),
+// get_neighbors() and setup_dimensions() are timed for square grids from
+// 10 x 10 up to 16384 x 16384, both neighborhoods, every boundary type, several
+// thread counts and two cell widths. Every configuration is repeated until it
+// has run for a minimum time; the results are printed and written to a CSV
+// file so runs of different releases can be compared.
+//
+// Usage: benchmark_kernels [results.csv] [max_size] [max_threads] [min_seconds]
+//
+// Stable tiles are not skipped while benchmarking (set_active_regions(false)),
+// so every call computes every cell.
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <functional>
+#include <algorithm>
+#include "CA_library.h"
+
+// Settings of a benchmark run
+struct BenchmarkSettings
+{
+    int max_size;       // largest number of rows (and columns) of a grid
+    int max_threads;    // largest number of threads
+    double min_seconds; // minimum time every configuration is repeated for
+};
+
+// Function that times a function until it has run for a minimum time
+// Inputs:
+//      settings : The benchmark settings
+//      function : The function timed (one call)
+//      calls : Set to the number of calls timed
+// Returns:
+//      Seconds per call
+double time_calls(const BenchmarkSettings &settings, const std::function<void()> &function, long long &calls)
+{
+    typedef std::chrono::steady_clock Clock;
+    function(); // warm-up (page faults, thread start-up)
+
+    calls = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed = 0.0;
+    long long batch = 1;
+    while (elapsed < settings.min_seconds)
+    {
+        for (long long call = 0; call < batch; ++call)
+        {
+            function();
+        }
+        calls += batch;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        batch *= 2;
+    }
+    return elapsed / calls;
+}
+
+// Names of the configuration values in the results
+const char *neighborhood_name(NeighborhoodType neighborhood)
+{
+    return neighborhood == VON_NEUMANN ? "von_neumann" : "moore";
+}
+
+const char *boundary_name(BoundaryType boundaries)
+{
+    return boundaries == PERIODIC ? "periodic" : (boundaries == FIXED ? "fixed" : "no_boundaries");
+}
+
+// Function that writes one result to the console and the CSV file
+// Inputs:
+//      csv : The results file
+//      cell_type, kernel, neighborhood, boundaries : Names of the configuration
+//      isa : Instruction set of the SIMD kernels
+//      rows, cols, threads : The configuration
+//      cells : Number of cells computed by one call
+//      bytes_per_cell : Bytes of grid storage (both buffers and the halo) per cell of the model
+//      calls, seconds : Number of calls timed and seconds per call
+void report(std::ofstream &csv, const char *cell_type, const char *kernel, const char *neighborhood,
+            const char *boundaries, const char *isa, int rows, int cols, int threads, double cells,
+            double bytes_per_cell, long long calls, double seconds)
+{
+    double cells_per_second = cells / seconds;
+    csv << cell_type << "," << kernel << "," << rows << "," << cols << "," << neighborhood << "," << boundaries
+        << "," << threads << "," << isa << "," << calls << "," << seconds << "," << cells_per_second << ","
+        << bytes_per_cell << "\n";
+    std::cout << cell_type << "\t" << kernel << "\t" << rows << "x" << cols << "\t" << neighborhood << "\t"
+              << boundaries << "\t" << threads << " threads\t" << cells_per_second / 1e6 << " Mcells/s" << std::endl;
+}
+
+// Function that benchmarks every compute function for one cell width
+// Inputs:
+//      csv : The results file
+//      cell_type : Name of the cell width
+//      settings : The benchmark settings
+template <typename Model>
+void benchmark_model(std::ofstream &csv, const char *cell_type, const BenchmarkSettings &settings)
+{
+    const int k = 1, kprime = 2;
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < settings.max_threads; threads *= 2)
+    {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(settings.max_threads);
+
+    for (int size : {10, 100, 1000, 4096, 16384})
+    {
+        if (size > settings.max_size)
+        {
+            continue;
+        }
+        for (int threads : thread_counts)
+        {
+            Model model;
+            model.set_grid_size(size, size);
+            model.set_states(3);
+            model.set_num_threads(threads);
+            model.set_active_regions(false);
+            model.setup_dimensions();
+
+            const char *isa = model.get_kernel_isa();
+            int halo = model.get_halo_width();
+            double storage_bytes = 2.0 * (size + 2 * halo) * (size + 2 * halo) * sizeof(model.get_row(0)[0]);
+            double bytes_per_cell = storage_bytes / (static_cast<double>(size) * size);
+            long long calls;
+            double seconds;
+
+            // Grid setup and the allele model (periodic, independent of the neighborhood)
+            seconds = time_calls(settings, [&]() { model.setup_dimensions(); }, calls);
+            report(csv, cell_type, "setup_dimensions", "-", "-", isa, size, size, threads, 1.0 * size * size,
+                   bytes_per_cell, calls, seconds);
+            seconds = time_calls(settings, [&]() { model.update(); }, calls);
+            report(csv, cell_type, "update", "-", "periodic", isa, size, size, threads, 1.0 * size * size,
+                   bytes_per_cell, calls, seconds);
+
+            for (NeighborhoodType neighborhood : {VON_NEUMANN, MOORE})
+            {
+                for (BoundaryType boundaries : {PERIODIC, FIXED, NO_BOUNDARIES})
+                {
+                    const char *n = neighborhood_name(neighborhood);
+                    const char *b = boundary_name(boundaries);
+                    model.set_neighborhood(neighborhood);
+                    model.set_boundaries(boundaries);
+
+                    // 2D rules
+                    model.set_dimensions(TWO_DIMENSIONAL);
+                    model.setup_dimensions();
+                    const double cells_2d = 1.0 * size * size;
+                    seconds = time_calls(settings, [&]() { model.twodim_rule1(k, kprime); }, calls);
+                    report(csv, cell_type, "twodim_rule1", n, b, isa, size, size, threads, cells_2d, bytes_per_cell,
+                           calls, seconds);
+                    seconds = time_calls(settings, [&]() { model.twodim_rule2(k, kprime); }, calls);
+                    report(csv, cell_type, "twodim_rule2", n, b, isa, size, size, threads, cells_2d, bytes_per_cell,
+                           calls, seconds);
+                    seconds = time_calls(settings, [&]() { model.twodim_rule3(k, kprime); }, calls);
+                    report(csv, cell_type, "twodim_rule3", n, b, isa, size, size, threads, cells_2d, bytes_per_cell,
+                           calls, seconds);
+
+                    // Neighbors of a sample of cells (one call per cell)
+                    const int sample = std::min(size, 256);
+                    seconds = time_calls(settings, [&]() {
+                        for (int i = 0; i < sample; ++i)
+                        {
+                            model.get_neighbors(i * (size / sample), (i * 7) % size);
+                        }
+                    }, calls);
+                    report(csv, cell_type, "get_neighbors", n, b, isa, size, size, threads, sample, bytes_per_cell,
+                           calls, seconds);
+
+                    // 1D rules (the first line of the grid, independent of the neighborhood)
+                    if (neighborhood == VON_NEUMANN)
+                    {
+                        model.set_dimensions(ONE_DIMENSIONAL);
+                        seconds = time_calls(settings, [&]() { model.onedim_rule1(k, kprime); }, calls);
+                        report(csv, cell_type, "onedim_rule1", "-", b, isa, 1, size, threads, size, storage_bytes / size,
+                               calls, seconds);
+                        seconds = time_calls(settings, [&]() { model.onedim_rule2(k, kprime); }, calls);
+                        report(csv, cell_type, "onedim_rule2", "-", b, isa, 1, size, threads, size, storage_bytes / size,
+                               calls, seconds);
+                        seconds = time_calls(settings, [&]() { model.onedim_rule3(k, kprime); }, calls);
+                        report(csv, cell_type, "onedim_rule3", "-", b, isa, 1, size, threads, size, storage_bytes / size,
+                               calls, seconds);
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string path = argc > 1 ? argv[1] : "benchmark_results.csv";
+    BenchmarkSettings settings;
+    settings.max_size = argc > 2 ? std::atoi(argv[2]) : 16384;
+    settings.max_threads = argc > 3 ? std::atoi(argv[3]) : static_cast<int>(std::thread::hardware_concurrency());
+    settings.min_seconds = argc > 4 ? std::atof(argv[4]) : 0.2;
+    settings.max_threads = std::max(settings.max_threads, 1);
+
+    std::ofstream csv(path);
+    if (!csv.is_open())
+    {
+        std::cerr << "Error opening " << path << " for writing." << std::endl;
+        return 1;
+    }
+    csv << "cell_type,kernel,rows,cols,neighborhood,boundaries,threads,isa,calls,seconds_per_call,"
+           "cells_per_second,bytes_per_cell\n";
+
+    benchmark_model<CellularAutomata>(csv, "int", settings);
+    benchmark_model<CellularAutomata8>(csv, "uint8_t", settings);
+
+    if (!csv)
+    {
+        std::cerr << "Error writing " << path << "." << std::endl;
+        return 1;
+    }
+    std::cout << "Benchmark results have been written to " << path << std::endl;
+    return 0;
+}
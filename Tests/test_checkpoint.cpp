@@ -0,0 +1,177 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the C++ testing code that checks the checkpoint files.
+// Runs are saved part way, resumed in a fresh model and compared with the
+// same runs continued without interruption: the grid, the generation and the
+// statistics must be identical.
+
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include "CA_library.h"
+
+// Function that overwrites a field of the header of a checkpoint file
+// Inputs:
+//      path : Path of the file
+//      offset : Position of the field
+//      value : New value of the field
+template <typename T>
+void write_field(const char *path, long offset, T value)
+{
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(offset);
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+// Function that checks that a resumed run matches an uninterrupted one
+// Inputs:
+//      name : Name of the run for error messages
+//      model : Configured model with a grid
+//      advance : Function computing the generations after the checkpoint
+// Returns:
+//      Number of failed checks
+template <typename Model, typename Advance>
+int check_resume(const char *name, Model &model, Advance advance)
+{
+    const char *path = "test_checkpoint.ckpt";
+    if (!model.save_checkpoint(path))
+    {
+        std::cerr << name << ": checkpoint was not written" << std::endl;
+        return 1;
+    }
+
+    Model resumed;
+    resumed.set_num_threads(3);
+    bool loaded = resumed.load_checkpoint(path);
+    std::remove(path);
+
+    advance(model);
+    if (loaded)
+    {
+        advance(resumed);
+    }
+
+    const StatisticsSeries &expected = model.get_statistics();
+    const StatisticsSeries &series = resumed.get_statistics();
+    bool same = loaded && resumed.get_grid() == model.get_grid() &&
+                resumed.get_generation() == model.get_generation() && resumed.get_seed() == model.get_seed() &&
+                resumed.get_k() == model.get_k() && resumed.get_kprime() == model.get_kprime() &&
+                resumed.get_neighborhood_radius() == model.get_neighborhood_radius() &&
+                resumed.get_boundaries() == model.get_boundaries() &&
+                series.get_generations() == expected.get_generations() &&
+                series.get_p_values() == expected.get_p_values() &&
+                series.get_heterozygosity_values() == expected.get_heterozygosity_values();
+    for (int state = 0; same && state < expected.get_num_states(); ++state)
+    {
+        same = series.get_counts(state) == expected.get_counts(state);
+    }
+    if (!same)
+    {
+        std::cerr << name << ": resumed run differs from the uninterrupted run" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main()
+{
+    int failures = 0;
+
+    // Allele model with a changed cross and a direct determine_genotype draw
+    CellularAutomata8 allele;
+    allele.set_grid_size(70, 90);
+    allele.set_states(3);
+    allele.set_seed(2023);
+    allele.setup_dimensions();
+    allele.set_cross(2, 3, {3, 3, 3, 2});
+    allele.set_statistics(true);
+    allele.record_statistics();
+    allele.update(12);
+    allele.determine_genotype(2, 2);
+    failures += check_resume("allele", allele, [](CellularAutomata8 &m) {
+        m.update(15);
+        m.determine_genotype(2, 2);
+        m.update();
+    });
+
+    // Rules with a wide neighborhood and fixed boundaries
+    CellularAutomata wide;
+    wide.set_neighborhood(MOORE);
+    wide.set_boundaries(FIXED);
+    wide.set_rule(MAJORITY_RULE);
+    wide.set_neighborhood_radius(2);
+    wide.set_k(2);
+    wide.set_kprime(3);
+    wide.set_grid_size(40, 33);
+    wide.set_states(3);
+    wide.set_seed(7);
+    wide.setup_dimensions();
+    wide.set_statistics(true);
+    wide.step(4);
+    failures += check_resume("radius 2", wide, [](CellularAutomata &m) { m.step(9); });
+
+    // 1D line with periodic boundaries
+    CellularAutomata16 line;
+    line.set_dimensions(ONE_DIMENSIONAL);
+    line.set_rule(CONDITIONAL_TRANSITION);
+    line.set_k(1);
+    line.set_kprime(2);
+    line.set_grid_size(1, 500);
+    line.set_states(3);
+    line.setup_dimensions();
+    line.step(3);
+    failures += check_resume("1D", line, [](CellularAutomata16 &m) { m.step(20); });
+
+    // A file saved with another cell width is rejected and leaves the model unchanged
+    const char *path = "test_checkpoint_width.ckpt";
+    CellularAutomata8 narrow;
+    narrow.set_grid_size(5, 5);
+    narrow.setup_dimensions();
+    wide.save_checkpoint(path);
+    if (narrow.load_checkpoint(path) || narrow.get_grid_rows() != 5)
+    {
+        std::cerr << "checkpoint with another cell width was loaded" << std::endl;
+        ++failures;
+    }
+    std::remove(path);
+
+    // Corrupt headers are rejected and leave the model unchanged: a rule out of
+    // range (int32 at byte 60), a grid too large to pad (rows, int32 at byte 16),
+    // a radius of 0 (int32 at byte 24) and a number of statistics samples whose
+    // size wraps around (uint64 at byte 104)
+    const char *corrupt_path = "test_checkpoint_corrupt.ckpt";
+    for (int field = 0; field < 4; ++field)
+    {
+        wide.save_checkpoint(corrupt_path);
+        if (field == 0)
+            write_field<int32_t>(corrupt_path, 60, 7);
+        else if (field == 1)
+            write_field<int32_t>(corrupt_path, 16, INT32_MAX);
+        else if (field == 2)
+            write_field<int32_t>(corrupt_path, 24, 0);
+        else
+            write_field<uint64_t>(corrupt_path, 104, static_cast<uint64_t>(1) << 61);
+
+        CellularAutomata loaded;
+        loaded.set_grid_size(5, 5);
+        loaded.setup_dimensions();
+        if (loaded.load_checkpoint(corrupt_path) || loaded.get_grid_rows() != 5)
+        {
+            std::cerr << "checkpoint with corrupt field " << field << " was loaded" << std::endl;
+            ++failures;
+        }
+    }
+    std::remove(corrupt_path);
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "All checkpoint tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,118 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the C++ testing code that checks the distributed mode.
+// Grids split across worker processes are advanced for every neighborhood,
+// boundary type and rule and gathered back, and compared with the same model
+// advanced by the compute functions of one process, together with the
+// statistics of every generation.
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include "CA_distributed.h"
+
+typedef std::vector<std::vector<int>> Grid;
+
+// Function that checks a distributed model against a single-process model
+// Inputs:
+//      name : Name of the cell width for error messages
+//      num_workers : Number of worker processes
+//      radius : Neighborhood radius
+//      rows, cols : Grid size
+// Returns:
+//      Number of failed configurations
+template <typename Model, typename Distributed>
+int check_distributed(const char *name, int num_workers, int radius, int rows, int cols)
+{
+    const int k = 1, kprime = 2;
+    int failures = 0;
+
+    for (int n = 0; n < 2; ++n)
+        for (int b = 0; b < 3; ++b)
+            for (int r = 0; r < 3; ++r)
+            {
+                std::srand(777 + n * 10 + b * 3 + r + rows);
+                Grid grid(rows, std::vector<int>(cols));
+                for (std::vector<int> &row : grid)
+                    for (int &cell : row)
+                        cell = (std::rand() % 5 == 0) ? 2 : (std::rand() % 6 == 0 ? std::rand() % 4 : 1);
+
+                Model single, gathered;
+                for (Model *model : {&single, &gathered})
+                {
+                    model->set_neighborhood(static_cast<NeighborhoodType>(n));
+                    model->set_boundaries(static_cast<BoundaryType>(b));
+                    model->set_rule(static_cast<RuleType>(r));
+                    model->set_neighborhood_radius(radius);
+                    model->set_k(k);
+                    model->set_kprime(kprime);
+                    model->set_grid(grid);
+                }
+                single.set_statistics(true);
+
+                Distributed distributed;
+                bool same = distributed.start(single, num_workers);
+                for (int jump : {1, 3, 4})
+                {
+                    distributed.step(jump);
+                    single.step(jump);
+                    same = same && distributed.gather(gathered) && gathered.get_grid() == single.get_grid() &&
+                           distributed.get_generation() == single.get_generation();
+                }
+
+                const StatisticsSeries &expected = single.get_statistics();
+                const StatisticsSeries &series = distributed.get_statistics();
+                same = same && series.get_generations() == expected.get_generations();
+                for (int state = 0; same && state < expected.get_num_states(); ++state)
+                {
+                    same = series.get_counts(state) == expected.get_counts(state);
+                }
+                distributed.stop();
+
+                if (!same)
+                {
+                    std::cerr << name << " (" << num_workers << " workers, radius " << radius
+                              << "): distributed mode differs for neighborhood " << n << ", boundaries " << b
+                              << ", rule " << r << std::endl;
+                    ++failures;
+                }
+            }
+    return failures;
+}
+
+int main()
+{
+    int failures = 0;
+
+    // One worker (its own neighbor on periodic grids), several workers and uneven slabs
+    failures += check_distributed<CellularAutomata, DistributedAutomata>("int", 1, 1, 9, 37);
+    failures += check_distributed<CellularAutomata, DistributedAutomata>("int", 4, 1, 30, 45);
+    failures += check_distributed<CellularAutomata8, DistributedAutomata8>("uint8_t", 3, 1, 40, 200);
+    failures += check_distributed<CellularAutomata16, DistributedAutomata16>("uint16_t", 2, 1, 7, 20);
+
+    // Halos of several rows, and more workers than the slabs of radius rows allow
+    failures += check_distributed<CellularAutomata, DistributedAutomata>("int", 3, 2, 17, 23);
+    failures += check_distributed<CellularAutomata8, DistributedAutomata8>("uint8_t", 8, 3, 12, 30);
+
+    // Only 2D grids are split
+    CellularAutomata line;
+    line.set_dimensions(ONE_DIMENSIONAL);
+    line.set_grid_size(1, 16);
+    line.setup_dimensions();
+    DistributedAutomata rejected;
+    if (rejected.start(line, 2) || rejected.get_running())
+    {
+        std::cerr << "1D grid was distributed" << std::endl;
+        ++failures;
+    }
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " configuration(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "All distributed tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,179 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the C++ testing code that checks the ensemble runner.
+// A sweep run on several threads must give the statistics of the same sweep
+// run on one thread, every replicate must match a model set up and run by
+// hand, and the summaries must be the mean and variance over the seeds.
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include "CA_ensemble.h"
+#include "CA_random.h"
+
+// Function that runs one replicate of a sweep by hand
+// Inputs:
+//      spec : The sweep
+//      replicate : The replicate
+// Returns:
+//      The statistics of the replicate
+StatisticsSeries run_by_hand(const SweepSpec &spec, const EnsembleRun &replicate)
+{
+    CellularAutomata8 model;
+    model.set_dimensions(spec.dimensions);
+    model.set_neighborhood(spec.neighborhood);
+    model.set_boundaries(spec.boundaries);
+    model.set_rule(replicate.rule);
+    model.set_states(spec.states);
+    model.set_k(spec.k);
+    model.set_kprime(spec.kprime);
+    model.set_seed(replicate.seed);
+    model.set_grid_size(replicate.rows, replicate.cols);
+    model.setup_population(replicate.recessive_frequency);
+
+    model.set_statistics(true);
+    model.record_statistics();
+    for (int g = 0; g < spec.generations; ++g)
+    {
+        if (spec.model == GENOTYPE_MODEL)
+            model.update();
+        else
+            model.step();
+    }
+    return model.get_statistics();
+}
+
+// Function that checks a sweep
+// Inputs:
+//      name : Name of the sweep for error messages
+//      spec : The sweep
+// Returns:
+//      Number of failed checks
+int check_sweep(const char *name, const SweepSpec &spec)
+{
+    int failures = 0;
+
+    EnsembleRunner8 parallel, serial;
+    parallel.set_num_threads(4);
+    serial.set_num_threads(1);
+    if (!parallel.run(spec) || !serial.run(spec))
+    {
+        std::cerr << name << ": sweep was not run" << std::endl;
+        return 1;
+    }
+
+    size_t expected_runs = spec.recessive_frequencies.size() * spec.grid_sizes.size() * spec.rules.size() *
+                           spec.seeds.size();
+    if (parallel.get_num_runs() != expected_runs ||
+        parallel.get_num_summaries() != expected_runs / spec.seeds.size())
+    {
+        std::cerr << name << ": " << parallel.get_num_runs() << " replicates instead of " << expected_runs << std::endl;
+        return 1;
+    }
+
+    for (size_t run = 0; run < parallel.get_num_runs(); ++run)
+    {
+        const StatisticsSeries &series = parallel.get_statistics(run);
+        bool same = series.size() == static_cast<size_t>(spec.generations) + 1 &&
+                    series.get_generations() == serial.get_statistics(run).get_generations();
+        for (int state = 0; same && state < series.get_num_states(); ++state)
+        {
+            same = series.get_counts(state) == serial.get_statistics(run).get_counts(state);
+        }
+        if (!same)
+        {
+            std::cerr << name << ": replicate " << run << " depends on the threads" << std::endl;
+            ++failures;
+        }
+    }
+
+    // A few replicates against models run by hand
+    for (size_t run : {static_cast<size_t>(0), parallel.get_num_runs() / 2, parallel.get_num_runs() - 1})
+    {
+        StatisticsSeries expected = run_by_hand(spec, parallel.get_run(run));
+        bool same = expected.get_generations() == parallel.get_statistics(run).get_generations();
+        for (int state = 0; same && state < expected.get_num_states(); ++state)
+        {
+            same = expected.get_counts(state) == parallel.get_statistics(run).get_counts(state);
+        }
+        if (!same)
+        {
+            std::cerr << name << ": replicate " << run << " differs from the model run by hand" << std::endl;
+            ++failures;
+        }
+    }
+
+    // Summaries over the seeds
+    size_t replicates = spec.seeds.size();
+    for (size_t configuration = 0; configuration < parallel.get_num_summaries(); ++configuration)
+    {
+        const EnsembleSummary &summary = parallel.get_summary(configuration);
+        bool same = summary.replicates == static_cast<int>(replicates);
+        for (size_t sample = 0; same && sample < summary.generations.size(); ++sample)
+        {
+            double mean = 0.0, variance = 0.0;
+            for (size_t seed = 0; seed < replicates; ++seed)
+                mean += parallel.get_statistics(configuration * replicates + seed).get_p(sample);
+            mean /= replicates;
+            for (size_t seed = 0; seed < replicates; ++seed)
+            {
+                double difference = parallel.get_statistics(configuration * replicates + seed).get_p(sample) - mean;
+                variance += difference * difference;
+            }
+            variance = replicates > 1 ? variance / (replicates - 1) : 0.0;
+            same = std::fabs(summary.mean_p[sample] - mean) < 1e-12 &&
+                   std::fabs(summary.variance_p[sample] - variance) < 1e-12;
+        }
+        if (!same)
+        {
+            std::cerr << name << ": summary " << configuration << " is not the mean over the seeds" << std::endl;
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+int main()
+{
+    int failures = 0;
+
+    // Allele model over starting frequencies, grid sizes of very different cost, and seeds
+    SweepSpec genotype;
+    genotype.recessive_frequencies = {0.1, 0.5, 0.9};
+    genotype.grid_sizes = {{10, 10}, {64, 300}, {3, 7}};
+    genotype.seeds = {1, 2, 3, 4, 5};
+    genotype.generations = 20;
+    failures += check_sweep("genotype", genotype);
+
+    // Rules of the model
+    SweepSpec rules;
+    rules.model = RULE_MODEL;
+    rules.neighborhood = MOORE;
+    rules.boundaries = PERIODIC;
+    rules.recessive_frequencies = {0.3};
+    rules.grid_sizes = {{40, 40}, {9, 130}};
+    rules.rules = {STRAIGHT_CONDITIONAL, CONDITIONAL_TRANSITION, MAJORITY_RULE};
+    rules.seeds = {11, 12};
+    rules.generations = 8;
+    failures += check_sweep("rules", rules);
+
+    // Invalid sweeps are rejected
+    SweepSpec invalid;
+    invalid.recessive_frequencies = {1.5};
+    EnsembleRunner8 runner;
+    if (runner.run(invalid))
+    {
+        std::cerr << "invalid sweep was run" << std::endl;
+        ++failures;
+    }
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "All ensemble tests passed." << std::endl;
+    return 0;
+}
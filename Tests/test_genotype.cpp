@@ -6,19 +6,18 @@
 // a population.
 
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <random>
 #include <functional>
+#include <ctime>
 #include "CA_library.h"
+#include "CA_output.h"
 
 int main()
 {
-    // Seeding the rand()
-    std::srand(static_cast<unsigned>(std::time(nullptr)));
-    
     // Create a model instance of the CellularAutomata class
-    CellularAutomata model;
+    // -> cells stored as uint8_t since there are only three genotypes
+    CellularAutomata8 model;
 
     // Set the appropriate dimensions for CA model
     // -> 2D since it is a grid
@@ -48,11 +47,9 @@ int main()
     // -> 3 since there are three genotypes (homodom, hetero, and rec)
     model.set_states(3);
 
-    // Setup the CA model based on specific configurations
-    model.setup_dimensions();
-    model.setup_boundaries();
-    model.setup_neighborhood();
-    model.setup_rule();
+    // Seed the model's random number generator
+    // -> current time so every run simulates a different population
+    model.set_seed(static_cast<uint64_t>(std::time(nullptr)));
 
     // Ask user for the starting frequency of the recessive allele
     double recessive_frequency;
@@ -66,49 +63,32 @@ int main()
         return 1; // Exit with error code
     }
 
-    // Convert the frequency to a probability threshold for easier comparison
-    int recessive_threshold = static_cast<int>(recessive_frequency * RAND_MAX);
-
-    // Modify the grid based on the recessive frequency
-    for (int i = 0; i < model.get_grid_rows(); ++i)
-    {
-        for (int j = 0; j < model.get_grid_cols(); ++j)
-        {
-            // Generate a random number and compare it to the threshold
-            if (std::rand() < recessive_threshold)
-            {
-                // If the random number is less than the threshold, set the cell to recessive
-                model.set_cell_state(i, j, 3); // Assuming there is a function to set the state of a cell
-            }
-            else
-            {
-                // Otherwise, randomly assign a dominant or heterozygous state
-                model.set_cell_state(i, j, (std::rand() % 2) + 1); // 1 or 2
-            }
-        }
-    }
+    // Setup the CA model based on specific configurations
+    // -> the grid is filled in parallel with genotypes in Hardy-Weinberg
+    //    proportions for the recessive allele frequency (aa: q^2, Aa: 2pq, AA: p^2)
+    model.setup_population(recessive_frequency);
+    model.setup_boundaries();
+    model.setup_neighborhood();
+    model.setup_rule();
 
     // Open file to write results to
-    std::ofstream output_file("simulation_output.txt");
-    // Check to make sure file is open, exit with error code if not
-    if (!output_file.is_open())
+    // -> binary snapshot: 2 bits per cell, each generation stored as its
+    //    difference from the previous one (see Utils/Plots/snapshot.py)
+    // -> written by a background thread while the next generations are computed
+    AsyncSnapshotWriter8 output_file;
+    if (!output_file.open("simulation_output.snap", model, SNAPSHOT_DELTA))
     {
-        std::cerr << "Error opening simulation_output.txt for writing." << std::endl;
+        std::cerr << "Error opening simulation_output.snap for writing." << std::endl;
         return 1;
     }
 
-    // Display the initial (current) state of the grid
-    output_file << "Initial state:\n";
-    const std::vector<std::vector<int>> &current_grid = model.get_grid();
-    for (const auto &row : current_grid)
-    {
-        for (int cell_state : row)
-        {
-            output_file << cell_state << ' ';
-        }
+    // Save the initial (current) state of the grid
+    output_file.write_frame(model);
 
-        output_file << '\n';
-    }
+    // Count the genotypes of every generation
+    // -> the initial population is counted here, update() counts the others
+    model.set_statistics(true);
+    model.record_statistics();
 
     // Run the CA model for a specified number of generations
     int num_generations = 100;
@@ -117,23 +97,25 @@ int main()
         // Update model for the next generation
         model.update();
 
-        // Display the updated state of the grid
-        output_file << "Generation " << generation << ":\n";
-        const std::vector<std::vector<int>> &updated_grid = model.get_grid();
-        for (const auto &row : updated_grid)
-        {
-            for (int cell_state : row)
-            {
-                output_file << cell_state << ' ';
-            }
-            output_file << '\n';
-        }
+        // Save the updated state of the grid
+        output_file.write_frame(model);
     }
-    
+
     // Close output file
-    output_file.close();
+    if (!output_file.close())
+    {
+        std::cerr << "Error writing simulation_output.snap." << std::endl;
+        return 1;
+    }
+
+    // Write the genotype counts and allele frequencies of every generation
+    if (!model.get_statistics().write("simulation_statistics.stats"))
+    {
+        return 1;
+    }
 
-    std::cout << "Simulation results have been written to simulation_output.txt" << std::endl;
+    std::cout << "Simulation results have been written to simulation_output.snap" << std::endl;
+    std::cout << "Genotype counts and allele frequencies have been written to simulation_statistics.stats" << std::endl;
 
     return 0;
 }
\ No newline at end of file
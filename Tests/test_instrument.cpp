@@ -0,0 +1,192 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the C++ testing code that checks the instrumentation.
+// With a library compiled with CA_INSTRUMENTATION, the records of update(),
+// step() and the compute functions must hold one generation each, also on
+// the multi-generation paths, and are compared with a copy of the model
+// advanced one generation at a time; the CSV and JSON traces are read back.
+// Without it, the model must refuse to record anything.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include "CA_library.h"
+
+// Function that counts the cells that differ between two grids
+uint64_t count_changes(const std::vector<std::vector<int>> &before, const std::vector<std::vector<int>> &after)
+{
+    uint64_t changes = 0;
+    for (size_t i = 0; i < before.size(); ++i)
+        for (size_t j = 0; j < before[i].size(); ++j)
+            changes += before[i][j] != after[i][j];
+    return changes;
+}
+
+// Function that counts the lines of a file
+int count_lines(const char *path)
+{
+    std::ifstream file(path);
+    std::string line;
+    int lines = 0;
+    while (std::getline(file, line))
+        ++lines;
+    return lines;
+}
+
+int main()
+{
+    int failures = 0;
+
+    CellularAutomata8 model;
+    model.set_neighborhood(MOORE);
+    model.set_rule(MAJORITY_RULE);
+    model.set_k(1);
+    model.set_kprime(2);
+    model.set_grid_size(60, 90);
+    model.set_states(3);
+    model.set_num_threads(2);
+    model.setup_dimensions();
+    model.set_instrumentation(true);
+
+    if (!model.get_instrumentation())
+    {
+        model.update();
+        if (model.get_trace().size() != 0)
+        {
+            std::cerr << "calls were recorded without CA_INSTRUMENTATION" << std::endl;
+            return 1;
+        }
+        std::cout << "Instrumentation is compiled out (build the library with INSTRUMENT=-DCA_INSTRUMENTATION)."
+                  << std::endl;
+        std::cout << "All instrumentation tests passed." << std::endl;
+        return 0;
+    }
+
+    // One record per generation, also for the calls that compute several:
+    // the expected records come from a copy advanced one generation at a time
+    std::vector<uint64_t> expected_changes;
+    for (int call = 0; call < 7; ++call)
+    {
+        CellularAutomata8 reference = model;
+        reference.set_instrumentation(false);
+        int generations = 1;
+        bool update = false;
+        if (call == 2)
+        {
+            model.step(6); // temporal blocking
+            generations = 6;
+        }
+        else if (call == 3)
+        {
+            model.update(4); // temporal blocking on several threads
+            generations = 4;
+            update = true;
+        }
+        else if (call == 4)
+        {
+            model.twodim_rule3(1, 2);
+        }
+        else if (call == 5)
+        {
+            model.set_temporal_blocking(1);
+            model.step(3); // one step() per generation
+            generations = 3;
+        }
+        else if (call == 6)
+        {
+            model.set_engine(BITSLICED_ENGINE);
+            model.step(3);
+            model.set_engine(DIRECT_ENGINE);
+            generations = 3;
+        }
+        else
+        {
+            model.update();
+            update = true;
+        }
+        for (int g = 0; g < generations; ++g)
+        {
+            std::vector<std::vector<int>> before = reference.get_grid();
+            if (update)
+                reference.update();
+            else
+                reference.step();
+            expected_changes.push_back(count_changes(before, reference.get_grid()));
+        }
+    }
+
+    const InstrumentationTrace &trace = model.get_trace();
+    if (trace.size() != expected_changes.size())
+    {
+        std::cerr << trace.size() << " records instead of " << expected_changes.size() << std::endl;
+        return 1;
+    }
+    for (size_t index = 0; index < trace.size(); ++index)
+    {
+        const GenerationRecord &record = trace.get_record(index);
+        bool same = record.generations == 1 && record.generation == index + 1 &&
+                    record.cells_updated == 60 * 90 &&
+                    record.bytes_written == record.cells_updated * sizeof(uint8_t) &&
+                    record.cells_changed == expected_changes[index] && record.seconds >= 0.0;
+        for (int counter = 0; counter < NUM_HARDWARE_COUNTERS; ++counter)
+        {
+            same = same && record.counters[counter] >= -1;
+        }
+        if (!same)
+        {
+            std::cerr << "record " << index << " (" << record.function << ") does not match the run" << std::endl;
+            ++failures;
+        }
+    }
+
+    // The memoised engine never computes the generations it jumps over: one record per call
+    CellularAutomata8 square;
+    square.set_rule(MAJORITY_RULE);
+    square.set_boundaries(PERIODIC);
+    square.set_grid_size(32, 32);
+    square.set_states(3);
+    square.setup_dimensions();
+    square.set_engine(MEMOISED_ENGINE);
+    square.set_instrumentation(true);
+    std::vector<std::vector<int>> before = square.get_grid();
+    square.step(10);
+    if (square.get_trace().size() != 1 || square.get_trace().get_record(0).generations != 10 ||
+        square.get_trace().get_record(0).cells_changed != count_changes(before, square.get_grid()))
+    {
+        std::cerr << "memoised jump was not recorded as one record" << std::endl;
+        ++failures;
+    }
+
+    // Traces
+    const char *csv_path = "test_instrument.csv";
+    const char *json_path = "test_instrument.json";
+    if (!trace.write_csv(csv_path) || count_lines(csv_path) != static_cast<int>(trace.size()) + 1 ||
+        !trace.write_json(json_path) || count_lines(json_path) != static_cast<int>(trace.size()) + 2)
+    {
+        std::cerr << "traces were not written" << std::endl;
+        ++failures;
+    }
+    std::remove(csv_path);
+    std::remove(json_path);
+
+    model.clear_trace();
+    model.set_instrumentation(false);
+    model.update();
+    if (model.get_trace().size() != 0)
+    {
+        std::cerr << "calls were recorded with the instrumentation disabled" << std::endl;
+        ++failures;
+    }
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "All instrumentation tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,795 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the C++ testing code that checks the compute functions
+// of the cellular automata library. Every rule is run for each dimension,
+// neighborhood, boundary type and cell width, and the results of the SIMD
+// kernels and of the portable kernels, on one or several threads, are
+// compared with a straightforward reference implementation that works on a
+// vector<vector<int>> grid.
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <thread>
+#include "CA_library.h"
+
+typedef std::vector<std::vector<int>> Grid;
+
+// Reference function that returns the state of a neighbor at (i, j), which
+// may lie outside of the grid
+int reference_neighbor(const Grid &grid, int i, int j, BoundaryType boundaries, int k)
+{
+    int rows = grid.size();
+    int cols = grid[0].size();
+    if (i >= 0 && i < rows && j >= 0 && j < cols)
+    {
+        return grid[i][j];
+    }
+    if (boundaries == PERIODIC)
+    {
+        return grid[(i % rows + rows) % rows][(j % cols + cols) % cols];
+    }
+    if (boundaries == FIXED)
+    {
+        return k;
+    }
+    // No boundaries: repeat the nearest edge cell
+    i = i < 0 ? 0 : (i >= rows ? rows - 1 : i);
+    j = j < 0 ? 0 : (j >= cols ? cols - 1 : j);
+    return grid[i][j];
+}
+
+// Reference function that advances the grid by one generation of a rule
+Grid reference_step(const Grid &grid, DimensionType dimensions, NeighborhoodType neighborhood,
+                    BoundaryType boundaries, RuleType rule, int k, int kprime)
+{
+    Grid next = grid;
+    int rows = (dimensions == ONE_DIMENSIONAL) ? 1 : grid.size();
+    int cols = grid[0].size();
+
+    for (int i = 0; i < rows; ++i)
+    {
+        for (int j = 0; j < cols; ++j)
+        {
+            std::vector<int> neighbors;
+            neighbors.push_back(reference_neighbor(grid, i, j - 1, boundaries, k));
+            neighbors.push_back(reference_neighbor(grid, i, j + 1, boundaries, k));
+            if (dimensions == TWO_DIMENSIONAL)
+            {
+                neighbors.push_back(reference_neighbor(grid, i - 1, j, boundaries, k));
+                neighbors.push_back(reference_neighbor(grid, i + 1, j, boundaries, k));
+                if (neighborhood == MOORE)
+                {
+                    neighbors.push_back(reference_neighbor(grid, i - 1, j - 1, boundaries, k));
+                    neighbors.push_back(reference_neighbor(grid, i - 1, j + 1, boundaries, k));
+                    neighbors.push_back(reference_neighbor(grid, i + 1, j - 1, boundaries, k));
+                    neighbors.push_back(reference_neighbor(grid, i + 1, j + 1, boundaries, k));
+                }
+            }
+
+            int sum = 0;
+            bool found = false;
+            for (int state : neighbors)
+            {
+                sum += state;
+                found = found || state == kprime;
+            }
+
+            if (grid[i][j] != k)
+            {
+                continue;
+            }
+            if (rule == STRAIGHT_CONDITIONAL)
+            {
+                next[i][j] = kprime;
+            }
+            else if (rule == CONDITIONAL_TRANSITION && found)
+            {
+                next[i][j] = kprime;
+            }
+            else if (rule == MAJORITY_RULE)
+            {
+                int threshold = (dimensions == ONE_DIMENSIONAL) ? 1 : (neighborhood == VON_NEUMANN ? 2 : 5);
+                next[i][j] = (sum >= threshold) ? kprime : grid[i][j];
+            }
+        }
+    }
+    return next;
+}
+
+// Reference function that advances the grid by one generation of a rule with
+// a neighborhood radius larger than 1, by visiting every cell of the window
+Grid reference_radius_step(const Grid &grid, DimensionType dimensions, NeighborhoodType neighborhood,
+                           BoundaryType boundaries, RuleType rule, int radius, int k, int kprime)
+{
+    Grid next = grid;
+    int rows = (dimensions == ONE_DIMENSIONAL) ? 1 : grid.size();
+    int cols = grid[0].size();
+    int reach = (dimensions == ONE_DIMENSIONAL) ? 0 : radius;
+
+    for (int i = 0; i < rows; ++i)
+    {
+        for (int j = 0; j < cols; ++j)
+        {
+            int sum = 0, count = 0;
+            bool found = false;
+            for (int di = -reach; di <= reach; ++di)
+            {
+                for (int dj = -radius; dj <= radius; ++dj)
+                {
+                    bool in_window = (neighborhood == MOORE || dimensions == ONE_DIMENSIONAL)
+                                         ? true
+                                         : std::abs(di) + std::abs(dj) <= radius;
+                    if (!in_window || (di == 0 && dj == 0))
+                    {
+                        continue;
+                    }
+                    int state = reference_neighbor(grid, i + di, j + dj, boundaries, k);
+                    sum += state;
+                    found = found || state == kprime;
+                    ++count;
+                }
+            }
+
+            if (grid[i][j] != k)
+            {
+                continue;
+            }
+            if (rule == STRAIGHT_CONDITIONAL || (rule == CONDITIONAL_TRANSITION && found))
+            {
+                next[i][j] = kprime;
+            }
+            else if (rule == MAJORITY_RULE)
+            {
+                int threshold = (dimensions == TWO_DIMENSIONAL && neighborhood == MOORE) ? count / 2 + 1 : count / 2;
+                next[i][j] = (sum >= threshold) ? kprime : grid[i][j];
+            }
+        }
+    }
+    return next;
+}
+
+// Function that runs one generation of the configured rule on the model,
+// either through step() or through the matching compute function
+template <typename Model>
+void run_rule(Model &model, int k, int kprime, bool use_step)
+{
+    if (use_step)
+    {
+        model.set_k(k);
+        model.set_kprime(kprime);
+        model.step();
+        return;
+    }
+
+    bool one_dim = model.get_dimensions() == ONE_DIMENSIONAL;
+    switch (model.get_rule())
+    {
+    case STRAIGHT_CONDITIONAL:
+        one_dim ? model.onedim_rule1(k, kprime) : model.twodim_rule1(k, kprime);
+        break;
+    case CONDITIONAL_TRANSITION:
+        one_dim ? model.onedim_rule2(k, kprime) : model.twodim_rule2(k, kprime);
+        break;
+    case MAJORITY_RULE:
+        one_dim ? model.onedim_rule3(k, kprime) : model.twodim_rule3(k, kprime);
+        break;
+    }
+}
+
+// Function that checks every configuration for one cell width
+// Inputs:
+//      name : Name of the cell width for error messages
+//      vectorize : Use the SIMD kernels (or the portable ones)
+//      threads : Number of threads used by the model
+//      rows, cols : Size of the grid
+//      use_step : Advance the model with step() instead of the compute functions
+// Returns:
+//      Number of configurations where the model differs from the reference
+template <typename Model>
+int check_kernels(const char *name, bool vectorize, int threads, int rows, int cols, bool use_step = false)
+{
+    const int generations = 4;
+    const int k = 1, kprime = 2;
+    int failures = 0;
+
+    for (int d = 0; d < 2; ++d)
+        for (int n = 0; n < 2; ++n)
+            for (int b = 0; b < 3; ++b)
+                for (int r = 0; r < 3; ++r)
+                {
+                    Model model;
+                    model.set_dimensions(static_cast<DimensionType>(d));
+                    model.set_neighborhood(static_cast<NeighborhoodType>(n));
+                    model.set_boundaries(static_cast<BoundaryType>(b));
+                    model.set_rule(static_cast<RuleType>(r));
+                    model.set_vectorization(vectorize);
+                    model.set_num_threads(threads);
+
+                    Grid grid(rows, std::vector<int>(cols));
+                    std::srand(1234 + d * 100 + n * 10 + b);
+                    for (auto &row : grid)
+                        for (int &cell : row)
+                            cell = std::rand() % 3 + 1;
+                    model.set_grid(grid);
+
+                    for (int g = 0; g < generations; ++g)
+                    {
+                        grid = reference_step(grid, model.get_dimensions(), model.get_neighborhood(),
+                                              model.get_boundaries(), model.get_rule(), k, kprime);
+                        run_rule(model, k, kprime, use_step);
+                    }
+
+                    if (model.get_grid() != grid)
+                    {
+                        std::cerr << name << " (" << model.get_kernel_isa() << ", " << threads
+                                  << " threads): mismatch for dimension " << d
+                                  << ", neighborhood " << n << ", boundaries " << b << ", rule " << r << std::endl;
+                        ++failures;
+                    }
+                }
+
+    return failures;
+}
+
+// Function that checks every configuration with a neighborhood radius larger than 1
+// Inputs:
+//      name : Name of the cell width for error messages
+//      radius : Radius of the neighborhood
+//      threads : Number of threads used by the model
+//      rows, cols : Size of the grid
+// Returns:
+//      Number of configurations where the model differs from the reference
+template <typename Model>
+int check_radius(const char *name, int radius, int threads, int rows, int cols)
+{
+    const int generations = 3;
+    const int k = 1, kprime = 2;
+    int failures = 0;
+
+    for (int d = 0; d < 2; ++d)
+        for (int n = 0; n < 2; ++n)
+            for (int b = 0; b < 3; ++b)
+                for (int r = 0; r < 3; ++r)
+                {
+                    Model model;
+                    model.set_dimensions(static_cast<DimensionType>(d));
+                    model.set_neighborhood(static_cast<NeighborhoodType>(n));
+                    model.set_boundaries(static_cast<BoundaryType>(b));
+                    model.set_rule(static_cast<RuleType>(r));
+                    model.set_neighborhood_radius(radius);
+                    model.set_num_threads(threads);
+
+                    // Mostly state k, so the majority thresholds are crossed both ways
+                    Grid grid(rows, std::vector<int>(cols));
+                    std::srand(4321 + radius * 1000 + d * 100 + n * 10 + b);
+                    for (auto &row : grid)
+                        for (int &cell : row)
+                            cell = (std::rand() % 4 == 0) ? 2 : (std::rand() % 5 == 0 ? 0 : 1);
+                    model.set_grid(grid);
+
+                    // The halo cannot be narrowed below the radius
+                    model.set_halo_width(1);
+                    bool same = model.get_halo_width() >= radius;
+
+                    for (int g = 0; g < generations; ++g)
+                    {
+                        grid = reference_radius_step(grid, model.get_dimensions(), model.get_neighborhood(),
+                                                     model.get_boundaries(), model.get_rule(), radius, k, kprime);
+                        run_rule(model, k, kprime, g % 2 == 1);
+                    }
+
+                    if (!same || model.get_grid() != grid)
+                    {
+                        std::cerr << name << " (radius " << radius << ", " << threads
+                                  << " threads): mismatch for dimension " << d
+                                  << ", neighborhood " << n << ", boundaries " << b << ", rule " << r << std::endl;
+                        ++failures;
+                    }
+                }
+
+    return failures;
+}
+
+// Function that checks the custom rule interface against the reference: a
+// tile rule and a per-cell rule that both implement the Von Neumann majority
+// rule on a periodic grid
+// Inputs:
+//      threads : Number of threads used by the model
+//      rows, cols : Size of the grid
+// Returns:
+//      Number of rule interfaces where the model differs from the reference
+template <typename Model, typename CellT>
+int check_custom_rules(int threads, int rows, int cols)
+{
+    const int generations = 4;
+    const int k = 1, kprime = 2;
+    int failures = 0;
+
+    // Row kernel reading the neighbors through the halo
+    auto tile_rule = [=](const GridTile<CellT> &tile) {
+        for (int i = tile.row_begin; i < tile.row_end; ++i)
+        {
+            const CellT *row = tile.in_row(i);
+            CellT *out = tile.out_row(i);
+            for (int j = 0; j < tile.cols; ++j)
+            {
+                int sum = row[j - 1] + row[j + 1] + row[j - tile.stride] + row[j + tile.stride];
+                out[j] = (row[j] == k && sum >= 2) ? kprime : row[j];
+            }
+        }
+    };
+
+    // Per-cell rule handling the periodic boundaries itself
+    auto cell_rule = [=](const Grid &grid, int i, int j) {
+        int sum = 0;
+        for (int d : {-1, 1})
+        {
+            sum += grid[(i + d + rows) % rows][j] + grid[i][(j + d + cols) % cols];
+        }
+        return (grid[i][j] == k && sum >= 2) ? kprime : grid[i][j];
+    };
+
+    for (int use_tile = 0; use_tile < 2; ++use_tile)
+    {
+        Model model;
+        model.set_num_threads(threads);
+        if (use_tile)
+            model.add_tile_rule(tile_rule);
+        else
+            model.add_rule(cell_rule);
+
+        Grid grid(rows, std::vector<int>(cols));
+        std::srand(99 + use_tile);
+        for (auto &row : grid)
+            for (int &cell : row)
+                cell = std::rand() % 3 + 1;
+        model.set_grid(grid);
+
+        for (int g = 0; g < generations; ++g)
+        {
+            grid = reference_step(grid, TWO_DIMENSIONAL, VON_NEUMANN, PERIODIC, MAJORITY_RULE, k, kprime);
+            model.step_rules();
+        }
+
+        if (model.get_grid() != grid || model.get_generation() != static_cast<uint64_t>(generations))
+        {
+            std::cerr << (use_tile ? "tile rule" : "cell rule") << " (" << threads
+                      << " threads): mismatch with the reference" << std::endl;
+            ++failures;
+        }
+    }
+
+    // Per-cell rules run on the calling thread, so a rule may keep state;
+    // without any rule step_rules() does nothing
+    Model model;
+    model.set_num_threads(threads);
+    model.set_grid(Grid(rows, std::vector<int>(cols, k)));
+    model.step_rules();
+    long long calls = 0;
+    bool same_thread = true;
+    const std::thread::id caller = std::this_thread::get_id();
+    model.add_rule([&](const Grid &grid, int i, int j) {
+        ++calls;
+        same_thread = same_thread && std::this_thread::get_id() == caller;
+        return grid[i][j];
+    });
+    model.step_rules();
+    if (calls != static_cast<long long>(rows) * cols || !same_thread || model.get_generation() != 1)
+    {
+        std::cerr << "cell rule (" << threads << " threads): not run once per cell on the calling thread" << std::endl;
+        ++failures;
+    }
+
+    return failures;
+}
+
+// Function that checks that skipping the stable tiles does not change the results
+// Models with and without active regions run side by side on a grid where
+// state k' spreads from a few seeds, with a cell changed from outside midway.
+// Inputs:
+//      name : Name of the cell width for error messages
+//      threads : Number of threads used by the models
+// Returns:
+//      Number of configurations where the models differ
+template <typename Model>
+int check_active_regions(const char *name, int threads)
+{
+    const int generations = 30;
+    const int k = 1, kprime = 2;
+    int failures = 0;
+
+    for (int d = 0; d < 2; ++d)
+        for (int n = 0; n < 2; ++n)
+            for (int b = 0; b < 3; ++b)
+                for (int r = 0; r < 3; ++r)
+                {
+                    int rows = (d == 0) ? 2 : 70;
+                    int cols = (d == 0) ? 9000 : 600;
+                    Grid grid(rows, std::vector<int>(cols, k));
+                    grid[0][5] = grid[rows - 1][cols / 2] = kprime;
+                    grid[rows / 2][cols - 1] = kprime;
+
+                    Model tracked, full;
+                    for (Model *model : {&tracked, &full})
+                    {
+                        model->set_dimensions(static_cast<DimensionType>(d));
+                        model->set_neighborhood(static_cast<NeighborhoodType>(n));
+                        model->set_boundaries(static_cast<BoundaryType>(b));
+                        model->set_rule(static_cast<RuleType>(r));
+                        model->set_num_threads(threads);
+                        model->set_grid(grid);
+                    }
+                    full.set_active_regions(false);
+
+                    bool same = true;
+                    for (int g = 0; g < generations && same; ++g)
+                    {
+                        if (g == 12)
+                        {
+                            tracked.set_cell_state(0, cols - 3, kprime);
+                            full.set_cell_state(0, cols - 3, kprime);
+                        }
+                        run_rule(tracked, k, kprime, g % 2 == 0);
+                        run_rule(full, k, kprime, g % 2 == 0);
+                        same = tracked.get_grid() == full.get_grid();
+                    }
+
+                    if (!same)
+                    {
+                        std::cerr << name << " (" << threads << " threads): active regions differ for dimension " << d
+                                  << ", neighborhood " << n << ", boundaries " << b << ", rule " << r << std::endl;
+                        ++failures;
+                    }
+                }
+
+    // A spreading front only keeps the tiles around it active
+    Model model;
+    model.set_rule(CONDITIONAL_TRANSITION);
+    Grid grid(256, std::vector<int>(2048, k));
+    grid[136][1100] = kprime;
+    model.set_grid(grid);
+    for (int g = 0; g < 4; ++g)
+    {
+        model.twodim_rule2(k, kprime);
+    }
+    if (model.get_active_fraction() > 0.1)
+    {
+        std::cerr << name << ": " << model.get_active_fraction() << " of the tiles computed for a small front" << std::endl;
+        ++failures;
+    }
+
+    return failures;
+}
+
+// Function that checks that the compute functions ignore the configured dimensions
+// The 2D compute functions must update the whole grid and the 1D ones only
+// the line on a model configured as 1D as on one configured as 2D, also when
+// the two alternate, with and without active regions.
+// Inputs:
+//      name : Name of the cell width for error messages
+// Returns:
+//      Number of runs where the models differ
+template <typename Model>
+int check_configured_dimensions(const char *name)
+{
+    const int k = 1, kprime = 2;
+    int failures = 0;
+
+    for (int active = 0; active < 2; ++active)
+    {
+        Grid grid(70, std::vector<int>(300, k));
+        grid[4][4] = grid[40][250] = kprime;
+        grid[0][100] = kprime;
+
+        Model line, plane;
+        line.set_dimensions(ONE_DIMENSIONAL);
+        for (Model *model : {&line, &plane})
+        {
+            model->set_grid(grid);
+            model->set_active_regions(active == 1);
+        }
+
+        bool same = true;
+        for (int g = 0; g < 12 && same; ++g)
+        {
+            for (Model *model : {&line, &plane})
+            {
+                if (g % 4 == 3)
+                    model->onedim_rule2(k, kprime);
+                else if (g % 2 == 0)
+                    model->twodim_rule2(k, kprime);
+                else
+                    model->twodim_rule3(k, kprime);
+            }
+            same = line.get_grid() == plane.get_grid();
+        }
+        same = same && line.get_cell_state(4, 4) == kprime && line.get_cell_state(8, 4) == kprime;
+
+        if (!same)
+        {
+            std::cerr << name << ": 2D compute functions differ on a model configured as 1D (active regions "
+                      << active << ")" << std::endl;
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+// Function that checks the memoised engine against the compute functions
+// Periodic grids whose sides are powers of two (square, rectangular and 1D)
+// are advanced by step(generations) with both engines, in jumps of several
+// sizes; configurations the memoised engine does not support must fall back.
+// Inputs:
+//      name : Name of the cell width for error messages
+// Returns:
+//      Number of configurations where the engines differ
+template <typename Model>
+int check_memoised(const char *name)
+{
+    const int k = 1, kprime = 2;
+    const int shapes[3][3] = {{TWO_DIMENSIONAL, 32, 32}, {TWO_DIMENSIONAL, 16, 64}, {ONE_DIMENSIONAL, 3, 128}};
+    int failures = 0;
+
+    for (const int *shape : shapes)
+        for (int n = 0; n < 2; ++n)
+            for (int r = 0; r < 3; ++r)
+            {
+                std::srand(777 + shape[2] + n * 10 + r);
+                Grid grid(shape[1], std::vector<int>(shape[2]));
+                for (std::vector<int> &row : grid)
+                    for (int &cell : row)
+                        cell = (std::rand() % 6 == 0) ? 2 : (std::rand() % 4 == 0 ? 0 : 1);
+
+                Model memoised, direct;
+                for (Model *model : {&memoised, &direct})
+                {
+                    model->set_dimensions(static_cast<DimensionType>(shape[0]));
+                    model->set_neighborhood(static_cast<NeighborhoodType>(n));
+                    model->set_rule(static_cast<RuleType>(r));
+                    model->set_k(k);
+                    model->set_kprime(kprime);
+                    model->set_grid(grid);
+                }
+                memoised.set_engine(MEMOISED_ENGINE);
+
+                bool same = memoised.get_active_engine() == MEMOISED_ENGINE;
+                for (int jump : {1, 3, 8, 21, 64})
+                {
+                    memoised.step(jump);
+                    direct.step(jump);
+                    same = same && memoised.get_grid() == direct.get_grid() &&
+                           memoised.get_generation() == direct.get_generation();
+                }
+                if (!same)
+                {
+                    std::cerr << name << ": memoised engine differs for dimension " << shape[0] << ", "
+                              << shape[1] << " x " << shape[2] << ", neighborhood " << n << ", rule " << r
+                              << std::endl;
+                    ++failures;
+                }
+            }
+
+    // Unsupported configurations run the compute functions
+    Model fixed, odd;
+    fixed.set_boundaries(FIXED);
+    fixed.set_grid_size(32, 32);
+    odd.set_grid_size(30, 32);
+    for (Model *model : {&fixed, &odd})
+    {
+        model->set_engine(MEMOISED_ENGINE);
+        model->setup_dimensions();
+        if (model->get_active_engine() != DIRECT_ENGINE)
+        {
+            std::cerr << name << ": memoised engine used for an unsupported configuration" << std::endl;
+            ++failures;
+        }
+    }
+
+    return failures;
+}
+
+// Function that checks the bit-sliced engine against the compute functions
+// Every configuration is advanced by step(generations) with both engines on
+// grids of states 0 to 3 whose rows do not fill a whole number of words.
+// Inputs:
+//      name : Name of the cell width for error messages
+//      threads : Number of threads used by the models
+//      rows, cols : Size of the grid
+// Returns:
+//      Number of configurations where the engines differ
+template <typename Model>
+int check_bitsliced(const char *name, int threads, int rows, int cols)
+{
+    const int k = 1, kprime = 2;
+    int failures = 0;
+
+    for (int d = 0; d < 2; ++d)
+        for (int n = 0; n < 2; ++n)
+            for (int b = 0; b < 3; ++b)
+                for (int r = 0; r < 3; ++r)
+                {
+                    std::srand(555 + d * 100 + n * 10 + b + rows);
+                    Grid grid(rows, std::vector<int>(cols));
+                    for (std::vector<int> &row : grid)
+                        for (int &cell : row)
+                            cell = (std::rand() % 5 == 0) ? 2 : (std::rand() % 6 == 0 ? std::rand() % 4 : 1);
+
+                    Model bitsliced, direct;
+                    for (Model *model : {&bitsliced, &direct})
+                    {
+                        model->set_dimensions(static_cast<DimensionType>(d));
+                        model->set_neighborhood(static_cast<NeighborhoodType>(n));
+                        model->set_boundaries(static_cast<BoundaryType>(b));
+                        model->set_rule(static_cast<RuleType>(r));
+                        model->set_num_threads(threads);
+                        model->set_k(k);
+                        model->set_kprime(kprime);
+                        model->set_grid(grid);
+                    }
+                    bitsliced.set_engine(BITSLICED_ENGINE);
+
+                    bool same = bitsliced.get_active_engine() == BITSLICED_ENGINE;
+                    for (int jump : {1, 2, 5})
+                    {
+                        bitsliced.step(jump);
+                        direct.step(jump);
+                        same = same && bitsliced.get_grid() == direct.get_grid() &&
+                               bitsliced.get_generation() == direct.get_generation();
+                    }
+                    if (!same)
+                    {
+                        std::cerr << name << " (" << threads << " threads): bit-sliced engine differs for dimension "
+                                  << d << ", neighborhood " << n << ", boundaries " << b << ", rule " << r << std::endl;
+                        ++failures;
+                    }
+                }
+
+    // States above 3 cannot be stored in the bit-planes
+    Model wide;
+    wide.set_states(6);
+    wide.set_grid_size(8, 8);
+    wide.set_engine(BITSLICED_ENGINE);
+    wide.setup_dimensions();
+    if (wide.get_active_engine() != DIRECT_ENGINE)
+    {
+        std::cerr << name << ": bit-sliced engine used for 6 states" << std::endl;
+        ++failures;
+    }
+
+    return failures;
+}
+
+// Function that checks that temporal blocking does not change the results
+// step(generations) and update(generations) are compared with one generation
+// at a time, including the statistics, on a grid tall enough to be cut into
+// several bands, with blocks that do and do not divide the generations.
+// Inputs:
+//      name : Name of the cell width for error messages
+//      rows, cols : Size of the grid
+// Returns:
+//      Number of configurations where the results differ
+template <typename Model>
+int check_temporal_blocking(const char *name, int rows, int cols)
+{
+    const int k = 1, kprime = 2, generations = 21;
+    int failures = 0;
+
+    // Configurations: 2 neighborhoods x 3 boundaries x 2 neighbor rules, then update()
+    for (int c = 0; c <= 12; ++c)
+    {
+        std::srand(31 + c);
+        Grid grid(rows, std::vector<int>(cols));
+        for (std::vector<int> &row : grid)
+            for (int &cell : row)
+                cell = (std::rand() % 7 == 0) ? 2 : (std::rand() % 5 == 0 ? 3 : 1);
+
+        Model blocked, single;
+        for (Model *model : {&blocked, &single})
+        {
+            model->set_neighborhood(static_cast<NeighborhoodType>(c % 2));
+            model->set_boundaries(static_cast<BoundaryType>((c / 2) % 3));
+            model->set_rule(c / 6 == 0 ? CONDITIONAL_TRANSITION : MAJORITY_RULE);
+            model->set_k(k);
+            model->set_kprime(kprime);
+            model->set_num_threads(3);
+            model->set_states(3);
+            model->set_grid(grid);
+            model->set_statistics(true);
+        }
+        blocked.set_temporal_blocking(c % 3 == 0 ? 4 : 8);
+        single.set_temporal_blocking(1);
+
+        if (c == 12)
+        {
+            blocked.update(generations);
+            single.update(generations);
+        }
+        else
+        {
+            blocked.step(generations);
+            single.step(generations);
+        }
+
+        bool same = blocked.get_grid() == single.get_grid() && blocked.get_generation() == single.get_generation() &&
+                    blocked.get_statistics().size() == single.get_statistics().size();
+        for (int state = 0; same && state < single.get_statistics().get_num_states(); ++state)
+        {
+            same = blocked.get_statistics().get_counts(state) == single.get_statistics().get_counts(state);
+        }
+        if (!same)
+        {
+            std::cerr << name << ": temporal blocking differs for configuration " << c << std::endl;
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+int main()
+{
+    int failures = 0;
+
+    // Small grid: SIMD and portable kernels on one thread
+    for (int v = 0; v < 2; ++v)
+    {
+        failures += check_kernels<CellularAutomata>("int", v == 1, 1, 9, 37);
+        failures += check_kernels<CellularAutomata16>("uint16_t", v == 1, 1, 9, 37);
+        failures += check_kernels<CellularAutomata8>("uint8_t", v == 1, 1, 9, 37);
+    }
+
+    // Kernels selected once from the configuration by step()
+    failures += check_kernels<CellularAutomata>("int", true, 1, 9, 37, true);
+    failures += check_kernels<CellularAutomata8>("uint8_t", true, 1, 9, 37, true);
+
+    // Larger grid split into several row bands
+    for (int threads : {3, 8})
+    {
+        failures += check_kernels<CellularAutomata>("int", true, threads, 64, 1200);
+        failures += check_kernels<CellularAutomata8>("uint8_t", true, threads, 64, 1200);
+    }
+
+    // Large radius neighborhoods, including windows wider than the grid
+    for (int radius : {2, 3, 5})
+    {
+        failures += check_radius<CellularAutomata>("int", radius, 1, 11, 29);
+        failures += check_radius<CellularAutomata8>("uint8_t", radius, 4, 40, 53);
+    }
+    failures += check_radius<CellularAutomata16>("uint16_t", 7, 3, 6, 9);
+
+    // Skipping the stable tiles
+    failures += check_active_regions<CellularAutomata>("int", 1);
+    failures += check_active_regions<CellularAutomata8>("uint8_t", 4);
+    failures += check_configured_dimensions<CellularAutomata>("int");
+    failures += check_configured_dimensions<CellularAutomata8>("uint8_t");
+
+    // Memoised engine
+    failures += check_memoised<CellularAutomata>("int");
+    failures += check_memoised<CellularAutomata8>("uint8_t");
+
+    // Bit-sliced engine, with rows of one word or less and of several words
+    failures += check_bitsliced<CellularAutomata>("int", 1, 9, 37);
+    failures += check_bitsliced<CellularAutomata8>("uint8_t", 3, 40, 200);
+    failures += check_bitsliced<CellularAutomata16>("uint16_t", 2, 5, 126);
+
+    // Several generations per pass of the grid
+    failures += check_temporal_blocking<CellularAutomata>("int", 300, 2100);
+    failures += check_temporal_blocking<CellularAutomata8>("uint8_t", 12000, 40);
+
+    // Custom rules run by step_rules()
+    failures += check_custom_rules<CellularAutomata, int>(1, 9, 37);
+    failures += check_custom_rules<CellularAutomata8, uint8_t>(4, 64, 300);
+
+    CellularAutomata model;
+    std::cout << "Kernels checked against the reference (SIMD kernels: " << model.get_kernel_isa() << ")" << std::endl;
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " configuration(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "All kernel tests passed." << std::endl;
+    return 0;
+}
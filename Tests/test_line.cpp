@@ -0,0 +1,150 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the C++ testing code that checks the 1D engine. For
+// every boundary, rule, radius and thread count, the line engine is run next
+// to a 1D model with the same seed, and the lines, the history of past
+// generations and the statistics must match the model at every generation.
+
+#include <iostream>
+#include <vector>
+#include "CA_library.h"
+#include "CA_line.h"
+
+// Function that compares the current line of the engine with the line of the model
+bool same_line(const LineAutomata8 &engine, const CellularAutomata8 &model)
+{
+    const uint8_t *line = engine.get_line();
+    const uint8_t *row = model.get_row(0);
+    for (int64_t j = 0; j < engine.get_width(); ++j)
+    {
+        if (line[j] != row[j] || engine.get_cell_state(j) != row[j])
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    int failures = 0;
+    const int width = 70001; // more than one segment of the line
+    const int depth = 4;
+    const int generations = 7;
+    const BoundaryType boundaries[] = {PERIODIC, FIXED, NO_BOUNDARIES};
+    const RuleType rules[] = {STRAIGHT_CONDITIONAL, CONDITIONAL_TRANSITION, MAJORITY_RULE};
+
+    for (BoundaryType boundary : boundaries)
+    {
+        for (RuleType rule : rules)
+        {
+            for (int radius = 1; radius <= 2; ++radius)
+            {
+                for (int threads = 1; threads <= 3; threads += 2)
+                {
+                    CellularAutomata8 model;
+                    model.set_dimensions(ONE_DIMENSIONAL);
+                    model.set_boundaries(boundary);
+                    model.set_rule(rule);
+                    model.set_neighborhood_radius(radius);
+                    model.set_grid_size(1, width);
+                    model.set_states(3);
+                    model.set_k(1);
+                    model.set_kprime(2);
+                    model.set_seed(17);
+                    model.set_statistics(true);
+                    model.setup_dimensions();
+
+                    LineAutomata8 engine;
+                    engine.set_boundaries(boundary);
+                    engine.set_rule(rule);
+                    engine.set_neighborhood_radius(radius);
+                    engine.set_width(width);
+                    engine.set_history_depth(depth);
+                    engine.set_states(3);
+                    engine.set_k(1);
+                    engine.set_kprime(2);
+                    engine.set_seed(17);
+                    engine.set_statistics(true);
+                    engine.set_num_threads(threads);
+                    engine.setup_line();
+
+                    std::vector<std::vector<uint8_t>> past;
+                    bool same = same_line(engine, model);
+                    for (int generation = 0; generation < generations && same; ++generation)
+                    {
+                        const uint8_t *row = model.get_row(0);
+                        past.push_back(std::vector<uint8_t>(row, row + width));
+                        model.step();
+                        engine.step();
+                        same = same_line(engine, model);
+
+                        // Every kept generation must be the one seen before
+                        for (int age = 1; age <= depth && same; ++age)
+                        {
+                            const uint8_t *line = engine.get_line(age);
+                            if (age > static_cast<int>(past.size()))
+                            {
+                                same = line == nullptr;
+                                continue;
+                            }
+                            const std::vector<uint8_t> &expected = past[past.size() - age];
+                            same = line != nullptr && std::vector<uint8_t>(line, line + width) == expected;
+                        }
+                        same = same && engine.get_line(depth + 1) == nullptr;
+
+                        const StatisticsSeries &line_statistics = engine.get_statistics();
+                        const StatisticsSeries &model_statistics = model.get_statistics();
+                        size_t line_sample = line_statistics.size() - 1;
+                        size_t model_sample = model_statistics.size() - 1;
+                        for (int state = 0; state < 4 && same; ++state)
+                        {
+                            same = line_statistics.get_count(line_sample, state) ==
+                                   model_statistics.get_count(model_sample, state);
+                        }
+                    }
+                    if (!same || engine.get_generation() != static_cast<uint64_t>(generations))
+                    {
+                        std::cerr << "line differs from the 1D model (boundaries " << boundary << ", rule " << rule
+                                  << ", radius " << radius << ", " << threads << " thread(s))" << std::endl;
+                        ++failures;
+                    }
+                }
+            }
+        }
+    }
+
+    // Several generations in one call, and a history restarted from the current line
+    LineAutomata engine;
+    engine.set_rule(CONDITIONAL_TRANSITION);
+    engine.set_width(9);
+    engine.set_k(1);
+    engine.set_kprime(2);
+    engine.set_line(std::vector<int>{1, 1, 1, 1, 2, 1, 1, 1, 1});
+    engine.set_history_depth(2);
+    engine.step(3);
+    const int expected[] = {1, 2, 2, 2, 2, 2, 2, 2, 1};
+    for (int j = 0; j < 9; ++j)
+    {
+        if (engine.get_cell_state(j) != expected[j] || engine.get_line(2)[j] != (j >= 3 && j <= 5 ? 2 : 1))
+        {
+            std::cerr << "cell " << j << " is wrong after step(3)" << std::endl;
+            ++failures;
+            break;
+        }
+    }
+    engine.set_history_depth(5);
+    if (engine.get_line(1) != nullptr || engine.get_cell_state(1) != 2 || engine.get_generation() != 3)
+    {
+        std::cerr << "changing the history depth lost the current line" << std::endl;
+        ++failures;
+    }
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "All line engine tests passed." << std::endl;
+    return 0;
+}
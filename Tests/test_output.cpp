@@ -0,0 +1,119 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the C++ testing code that checks the asynchronous
+// output stage. Runs of the allele model are written by the synchronous
+// writer and by the asynchronous writer with several queue lengths, and the
+// files must be byte for byte the same and read back to the recorded grids.
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include "CA_library.h"
+#include "CA_output.h"
+
+// Function that reads a whole file
+std::string read_file(const char *path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Function that sets up the allele model used by every run
+void setup_model(CellularAutomata8 &model)
+{
+    model.set_boundaries(NO_BOUNDARIES);
+    model.set_rule(CONDITIONAL_TRANSITION);
+    model.set_grid_size(61, 47);
+    model.set_states(3);
+    model.set_seed(11);
+    model.setup_dimensions();
+}
+
+int main()
+{
+    int failures = 0;
+    const int generations = 50;
+    const char *sync_path = "test_output_sync.snap";
+    const char *async_path = "test_output_async.snap";
+    const SnapshotEncoding encodings[] = {SNAPSHOT_PACKED, SNAPSHOT_RLE, SNAPSHOT_DELTA};
+    const int queue_lengths[] = {1, 3, 16};
+
+    for (SnapshotEncoding encoding : encodings)
+    {
+        // Reference run written synchronously
+        CellularAutomata8 reference;
+        setup_model(reference);
+        std::vector<std::vector<std::vector<int>>> recorded;
+        SnapshotWriter writer;
+        failures += !writer.open(sync_path, reference, encoding, 8);
+        for (int g = 0; g <= generations; ++g)
+        {
+            if (g > 0)
+                reference.update();
+            recorded.push_back(reference.get_grid());
+            failures += !writer.write_frame(reference);
+        }
+        failures += !writer.close();
+        const std::string expected = read_file(sync_path);
+
+        for (int queue_frames : queue_lengths)
+        {
+            CellularAutomata8 model;
+            setup_model(model);
+            AsyncSnapshotWriter8 output;
+            bool same = output.open(async_path, model, encoding, 8, queue_frames);
+            for (int g = 0; g <= generations && same; ++g)
+            {
+                if (g > 0)
+                    model.update();
+                same = output.write_frame(model);
+            }
+            same = same && output.close() && output.get_num_frames() == generations + 1 &&
+                   output.get_pending_frames() == 0 && read_file(async_path) == expected;
+
+            // The frames read back to the grids of the run
+            SnapshotReader reader;
+            std::vector<std::vector<int>> grid;
+            same = same && reader.open(async_path) && reader.get_num_frames() == recorded.size();
+            for (size_t f = 0; f < recorded.size() && same; ++f)
+            {
+                same = reader.read_frame(f, grid) && grid == recorded[f];
+            }
+            if (!same)
+            {
+                std::cerr << "asynchronous file differs (encoding " << encoding << ", " << queue_frames
+                          << " buffer(s))" << std::endl;
+                ++failures;
+            }
+        }
+    }
+
+    // Frames of another grid size are refused, and a closed writer takes no frames
+    CellularAutomata8 model;
+    setup_model(model);
+    CellularAutomata8 other;
+    other.set_grid_size(5, 5);
+    other.setup_dimensions();
+    AsyncSnapshotWriter8 output;
+    if (!output.open(async_path, model) || output.write_frame(other) || !output.close() || output.write_frame(model))
+    {
+        std::cerr << "writer accepted a frame it should refuse" << std::endl;
+        ++failures;
+    }
+
+    std::remove(sync_path);
+    std::remove(async_path);
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "All output pipeline tests passed." << std::endl;
+    return 0;
+}
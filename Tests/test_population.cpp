@@ -0,0 +1,153 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the C++ testing code that checks the population
+// initialisers. Hardy-Weinberg populations must match the expected genotype
+// proportions, exact counts must be met exactly, clustered populations must
+// form patches, and every population must be the same for any number of
+// threads and rerun from the same seed.
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include "CA_library.h"
+
+// Function that counts the cells of every genotype (index 0 counts the other states)
+std::vector<uint64_t> count_genotypes(const CellularAutomata8 &model, int rows)
+{
+    std::vector<uint64_t> counts(4, 0);
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < model.get_grid_cols(); ++j)
+        {
+            int state = model.get_cell_state(i, j);
+            ++counts[state >= 1 && state <= 3 ? state : 0];
+        }
+    return counts;
+}
+
+// Function that returns the fraction of horizontal neighbors with the same genotype
+double same_neighbor_fraction(const CellularAutomata8 &model)
+{
+    uint64_t same = 0, pairs = 0;
+    for (int i = 0; i < model.get_grid_rows(); ++i)
+        for (int j = 1; j < model.get_grid_cols(); ++j)
+        {
+            same += model.get_cell_state(i, j) == model.get_cell_state(i, j - 1);
+            ++pairs;
+        }
+    return static_cast<double>(same) / pairs;
+}
+
+// Function that sets up a 2D model of the allele model
+void setup_model(CellularAutomata8 &model, int rows, int cols, int threads)
+{
+    model.set_grid_size(rows, cols);
+    model.set_states(3);
+    model.set_seed(42);
+    model.set_num_threads(threads);
+}
+
+int main()
+{
+    int failures = 0;
+    const int rows = 300, cols = 400;
+    const double cells = static_cast<double>(rows) * cols;
+
+    // Hardy-Weinberg proportions, within 5 standard deviations
+    for (double q : {0.0, 0.2, 0.7, 1.0})
+    {
+        CellularAutomata8 model;
+        setup_model(model, rows, cols, 4);
+        std::vector<uint64_t> counts;
+        bool same = model.setup_population(q);
+        counts = count_genotypes(model, rows);
+        const double expected[4] = {0.0, (1 - q) * (1 - q), 2 * q * (1 - q), q * q};
+        for (int genotype = 0; genotype < 4 && same; ++genotype)
+        {
+            double deviation = std::sqrt(cells * expected[genotype] * (1 - expected[genotype]));
+            same = std::fabs(counts[genotype] - cells * expected[genotype]) <= 5 * deviation + 0.5;
+        }
+        if (!same)
+        {
+            std::cerr << "Hardy-Weinberg population with q = " << q << " has the wrong proportions" << std::endl;
+            ++failures;
+        }
+    }
+
+    // Exact counts, including counts of zero
+    const uint64_t count_sets[][3] = {{30000, 50000, 40000}, {0, 0, 120000}, {120000, 0, 0}, {1, 119998, 1}};
+    for (const uint64_t *set : count_sets)
+    {
+        CellularAutomata8 model;
+        setup_model(model, rows, cols, 3);
+        bool same = model.setup_population_counts(set[0], set[1], set[2]);
+        std::vector<uint64_t> counts = count_genotypes(model, rows);
+        same = same && counts[0] == 0 && counts[1] == set[0] && counts[2] == set[1] && counts[3] == set[2];
+        if (!same)
+        {
+            std::cerr << "population does not have the counts " << set[0] << ", " << set[1] << ", " << set[2]
+                      << std::endl;
+            ++failures;
+        }
+    }
+
+    // Clustered populations form patches, and keep roughly the Hardy-Weinberg proportions
+    {
+        CellularAutomata8 model;
+        setup_model(model, rows, cols, 2);
+        bool same = model.setup_clustered_population(0.5, 400);
+        std::vector<uint64_t> counts = count_genotypes(model, rows);
+        same = same && counts[0] == 0 && counts[1] > 0 && counts[2] > 0 && counts[3] > 0 &&
+               same_neighbor_fraction(model) > 0.8;
+        if (!same)
+        {
+            std::cerr << "clustered population has no patches" << std::endl;
+            ++failures;
+        }
+    }
+
+    // The same population for any number of threads
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        std::vector<std::vector<int>> grids[2];
+        for (int run = 0; run < 2; ++run)
+        {
+            CellularAutomata8 model;
+            setup_model(model, rows, cols, run == 0 ? 1 : 5);
+            if (mode == 0)
+                model.setup_population(0.4);
+            else if (mode == 1)
+                model.setup_population_counts(60000, 40000, 20000);
+            else
+                model.setup_clustered_population(0.4, 1000);
+            grids[run] = model.get_grid();
+        }
+        if (grids[0] != grids[1])
+        {
+            std::cerr << "population " << mode << " depends on the number of threads" << std::endl;
+            ++failures;
+        }
+    }
+
+    // 1D: only the line is filled, and wrong arguments are refused
+    CellularAutomata8 line;
+    line.set_dimensions(ONE_DIMENSIONAL);
+    setup_model(line, 2, 1000, 1);
+    bool refused = !line.setup_population(1.5) && !line.setup_population_counts(1, 1, 1) &&
+                   !line.setup_clustered_population(0.5, 0);
+    if (!refused || !line.setup_population_counts(100, 200, 700) || count_genotypes(line, 1)[3] != 700 ||
+        line.get_generation() != 0)
+    {
+        std::cerr << "1D population or argument checks are wrong" << std::endl;
+        ++failures;
+    }
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "All population tests passed." << std::endl;
+    return 0;
+}
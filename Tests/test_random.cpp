@@ -0,0 +1,144 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the C++ testing code for the random number generation
+// of the cellular automata library. It checks the Philox generator against
+// its published test vectors, checks the genotype crosses of the allele
+// model, and checks that seeded runs of the allele model replay exactly for
+// any number of threads.
+
+#include <iostream>
+#include <vector>
+#include "CA_library.h"
+
+// Function that checks the Philox4x32-10 known-answer vectors (Random123)
+// Returns:
+//      Number of vectors that do not match
+int check_philox()
+{
+    int failures = 0;
+
+    uint32_t zero[4] = {0, 0, 0, 0};
+    philox4x32_10(zero, 0, 0);
+    uint32_t zero_expected[4] = {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8};
+
+    uint32_t pi[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+    philox4x32_10(pi, 0xa4093822, 0x299f31d0);
+    uint32_t pi_expected[4] = {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1};
+
+    for (int w = 0; w < 4; ++w)
+    {
+        failures += (zero[w] != zero_expected[w]) + (pi[w] != pi_expected[w]);
+    }
+    if (failures > 0)
+    {
+        std::cerr << "Philox4x32-10 does not match the known-answer vectors." << std::endl;
+    }
+    return failures;
+}
+
+// Function that checks the genotype transition table of the allele model
+// Returns:
+//      Number of crosses that do not follow the Mendelian proportions
+int check_genotype_table()
+{
+    CellularAutomata8 model;
+    model.set_states(3);
+
+    // Offspring counts of each cross over the 4 equally likely outcomes
+    int expected[4][4][4] = {};
+    expected[1][1][1] = 4;
+    expected[3][3][3] = 4;
+    expected[1][3][2] = expected[3][1][2] = 4;
+    expected[1][2][1] = expected[1][2][2] = expected[2][1][1] = expected[2][1][2] = 2;
+    expected[2][3][2] = expected[2][3][3] = expected[3][2][2] = expected[3][2][3] = 2;
+    expected[2][2][2] = 2;
+    expected[2][2][1] = expected[2][2][3] = 1;
+
+    int failures = 0;
+    for (int state1 = 1; state1 <= 3; ++state1)
+    {
+        for (int state2 = 1; state2 <= 3; ++state2)
+        {
+            int counts[4] = {};
+            for (uint32_t bucket = 0; bucket < 4; ++bucket)
+            {
+                ++counts[model.determine_genotype(state1, state2, bucket << 30)];
+            }
+            for (int child = 1; child <= 3; ++child)
+            {
+                if (counts[child] != expected[state1][state2][child])
+                {
+                    std::cerr << "Cross " << state1 << " x " << state2 << " has the wrong offspring." << std::endl;
+                    ++failures;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Heterozygous x Heterozygous keeps its thresholds on the uniform draw
+    if (model.determine_genotype(2, 2, 0x7FFFFFFFu) != 2 || model.determine_genotype(2, 2, 0x80000000u) != 1 ||
+        model.determine_genotype(2, 2, 0xC0000000u) != 3)
+    {
+        std::cerr << "Heterozygous x Heterozygous cross has the wrong thresholds." << std::endl;
+        ++failures;
+    }
+    return failures;
+}
+
+// Function that runs the allele model and returns its final grid
+// Inputs:
+//      seed : Seed of the model
+//      threads : Number of threads used by the model
+//      generations : Number of calls to update()
+std::vector<std::vector<int>> run_allele_model(uint64_t seed, int threads, int generations)
+{
+    CellularAutomata8 model;
+    model.set_dimensions(TWO_DIMENSIONAL);
+    model.set_neighborhood(VON_NEUMANN);
+    model.set_boundaries(NO_BOUNDARIES);
+    model.set_grid_size(97, 131);
+    model.set_states(3);
+    model.set_seed(seed);
+    model.set_num_threads(threads);
+    model.setup_dimensions();
+
+    for (int generation = 0; generation < generations; ++generation)
+    {
+        model.update();
+    }
+    return model.get_grid();
+}
+
+int main()
+{
+    int failures = check_philox() + check_genotype_table();
+
+    // The same seed gives the same run for any number of threads
+    std::vector<std::vector<int>> reference = run_allele_model(42, 1, 20);
+    for (int threads : {2, 3, 8})
+    {
+        if (run_allele_model(42, threads, 20) != reference)
+        {
+            std::cerr << "Allele model differs on " << threads << " threads." << std::endl;
+            ++failures;
+        }
+    }
+
+    // A different seed gives a different run (checked early, before the population converges)
+    if (run_allele_model(43, 1, 2) == run_allele_model(42, 1, 2))
+    {
+        std::cerr << "Allele model does not depend on the seed." << std::endl;
+        ++failures;
+    }
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " random number test(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "All random number tests passed." << std::endl;
+    return 0;
+}
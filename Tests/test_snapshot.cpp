@@ -0,0 +1,139 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the C++ testing code that checks the binary snapshot
+// format. Runs of the allele model are written with every encoding, read
+// back in order and out of order, and compared with the grids recorded
+// while the model ran.
+
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <unistd.h>
+#include "CA_library.h"
+#include "CA_snapshot.h"
+
+// Function that writes a run of the allele model and checks that it reads back
+// Inputs:
+//      path : Path of the snapshot file
+//      encoding : Encoding used by the writer
+//      drop_index : Cut the index off the file, as in a run that was interrupted
+// Returns:
+//      Number of failed checks
+int check_snapshot(const char *path, SnapshotEncoding encoding, bool drop_index)
+{
+    const int generations = 40;
+    int failures = 0;
+
+    CellularAutomata8 model;
+    model.set_boundaries(NO_BOUNDARIES);
+    model.set_rule(CONDITIONAL_TRANSITION);
+    model.set_grid_size(37, 53);
+    model.set_states(3);
+    model.set_seed(7);
+    model.setup_dimensions();
+
+    std::vector<std::vector<std::vector<int>>> recorded;
+    {
+        SnapshotWriter writer;
+        if (!writer.open(path, model, encoding, 16))
+        {
+            return 1;
+        }
+        for (int g = 0; g <= generations; ++g)
+        {
+            if (g > 0)
+            {
+                model.update();
+            }
+            recorded.push_back(model.get_grid());
+            failures += !writer.write_frame(model);
+        }
+        uint64_t frames_end = writer.get_bytes_written();
+        failures += !writer.close();
+        if (drop_index && truncate(path, static_cast<off_t>(frames_end)) != 0)
+        {
+            ++failures;
+        }
+    }
+
+    SnapshotReader reader;
+    if (!reader.open(path))
+    {
+        std::cerr << "snapshot (encoding " << encoding << "): cannot be opened" << std::endl;
+        return failures + 1;
+    }
+
+    const SnapshotHeader &header = reader.get_header();
+    if (header.rows != 37 || header.cols != 53 || header.states != 3 || header.bits_per_cell != 2 ||
+        header.boundaries != NO_BOUNDARIES || header.seed != 7 ||
+        reader.get_num_frames() != recorded.size())
+    {
+        std::cerr << "snapshot (encoding " << encoding << "): wrong header" << std::endl;
+        ++failures;
+    }
+
+    // Read forward, then seek backward and to single generations
+    std::vector<std::vector<int>> grid;
+    for (size_t f = 0; f < reader.get_num_frames(); ++f)
+    {
+        if (!reader.read_frame(f, grid) || grid != recorded[f] || reader.get_frame_generation(f) != f)
+        {
+            std::cerr << "snapshot (encoding " << encoding << "): frame " << f << " differs" << std::endl;
+            ++failures;
+        }
+    }
+    for (int generation : {33, 2, 17, 16, 40, 0})
+    {
+        long long frame = reader.find_generation(generation);
+        if (frame < 0 || !reader.read_frame(frame, grid) || grid != recorded[generation])
+        {
+            std::cerr << "snapshot (encoding " << encoding << "): generation " << generation << " differs" << std::endl;
+            ++failures;
+        }
+    }
+
+    reader.close();
+    std::remove(path);
+    return failures;
+}
+
+int main()
+{
+    int failures = 0;
+    failures += check_snapshot("test_snapshot_packed.snap", SNAPSHOT_PACKED, false);
+    failures += check_snapshot("test_snapshot_rle.snap", SNAPSHOT_RLE, false);
+    failures += check_snapshot("test_snapshot_delta.snap", SNAPSHOT_DELTA, false);
+
+    // Files without an index are scanned frame by frame
+    failures += check_snapshot("test_snapshot_scan.snap", SNAPSHOT_DELTA, true);
+
+    // Keyframe intervals beyond the 16-bit header field are clamped, not truncated
+    {
+        const char *path = "test_snapshot_keyframes.snap";
+        CellularAutomata model;
+        model.set_grid_size(4, 4);
+        model.setup_dimensions();
+        SnapshotWriter writer;
+        SnapshotReader reader;
+        bool same = writer.open(path, model, SNAPSHOT_DELTA, 100000) && writer.write_frame(model) &&
+                    writer.close() && reader.open(path) &&
+                    reader.get_header().keyframe_interval == MAX_KEYFRAME_INTERVAL;
+        reader.close();
+        std::remove(path);
+        if (!same)
+        {
+            std::cerr << "keyframe interval was not clamped to the header field" << std::endl;
+            ++failures;
+        }
+    }
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " snapshot check(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "All snapshot tests passed." << std::endl;
+    return 0;
+}
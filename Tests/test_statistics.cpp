@@ -0,0 +1,178 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the C++ testing code that checks the per-generation
+// statistics. The counts collected by update() and the compute functions are
+// compared with a recount of the grid after every generation, the allele
+// frequencies with their definition, and the columnar file is read back.
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include "CA_library.h"
+
+// Function that counts the states of a grid
+std::vector<uint64_t> recount(const std::vector<std::vector<int>> &grid, int num_states, int rows)
+{
+    std::vector<uint64_t> counts(num_states, 0);
+    for (int i = 0; i < rows; ++i)
+        for (int state : grid[i])
+            ++counts[state];
+    return counts;
+}
+
+// Function that checks the statistics collected while a model runs
+// Inputs:
+//      name : Name of the run for error messages
+//      model : Configured model with a grid
+//      advance : Function computing one generation
+//      generations : Number of generations
+// Returns:
+//      Number of failed checks
+template <typename Model, typename Advance>
+int check_run(const char *name, Model &model, Advance advance, int generations)
+{
+    int failures = 0;
+    int rows = (model.get_dimensions() == ONE_DIMENSIONAL) ? 1 : model.get_grid_rows();
+
+    model.set_statistics(true);
+    model.record_statistics();
+    std::vector<std::vector<uint64_t>> expected;
+    expected.push_back(recount(model.get_grid(), model.get_statistics().get_num_states(), rows));
+    for (int g = 0; g < generations; ++g)
+    {
+        advance(model);
+        expected.push_back(recount(model.get_grid(), model.get_statistics().get_num_states(), rows));
+    }
+
+    const StatisticsSeries &series = model.get_statistics();
+    if (series.size() != expected.size())
+    {
+        std::cerr << name << ": " << series.size() << " samples instead of " << expected.size() << std::endl;
+        return 1;
+    }
+    for (size_t sample = 0; sample < series.size(); ++sample)
+    {
+        bool same = series.get_generation(sample) == sample;
+        for (int state = 0; state < series.get_num_states(); ++state)
+        {
+            same = same && series.get_count(sample, state) == expected[sample][state];
+        }
+
+        double individuals = 0.0 + expected[sample][1] + expected[sample][2] + expected[sample][3];
+        double p = (2.0 * expected[sample][1] + expected[sample][2]) / (2.0 * individuals);
+        same = same && std::fabs(series.get_p(sample) - p) < 1e-12 &&
+               std::fabs(series.get_q(sample) - (1.0 - p)) < 1e-12 &&
+               std::fabs(series.get_heterozygosity(sample) - expected[sample][2] / individuals) < 1e-12;
+        if (!same)
+        {
+            std::cerr << name << ": sample " << sample << " differs from the grid" << std::endl;
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+int main()
+{
+    int failures = 0;
+
+    // Allele model on several threads
+    CellularAutomata8 allele;
+    allele.set_grid_size(120, 200);
+    allele.set_states(3);
+    allele.set_num_threads(4);
+    allele.setup_dimensions();
+    failures += check_run("update", allele, [](CellularAutomata8 &m) { m.update(); }, 25);
+
+    // Columnar file round trip
+    const char *path = "test_statistics.stats";
+    StatisticsSeries loaded;
+    if (!allele.get_statistics().write(path) || !loaded.read(path) ||
+        loaded.get_generations() != allele.get_statistics().get_generations() ||
+        loaded.get_counts(3) != allele.get_statistics().get_counts(3) ||
+        loaded.get_p_values() != allele.get_statistics().get_p_values() ||
+        loaded.get_heterozygosity_values() != allele.get_statistics().get_heterozygosity_values())
+    {
+        std::cerr << "statistics file does not read back" << std::endl;
+        ++failures;
+    }
+
+    // Files whose number of states (uint32 at byte 12) or of samples (uint64 at
+    // byte 16) does not fit in the file are refused without allocating them
+    for (int field = 0; field < 2; ++field)
+    {
+        allele.get_statistics().write(path);
+        {
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            const uint8_t huge[8] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x0f};
+            file.seekp(field == 0 ? 12 : 16);
+            file.write(reinterpret_cast<const char *>(huge), field == 0 ? 4 : 8);
+        }
+        if (loaded.read(path) || loaded.size() != 0)
+        {
+            std::cerr << "corrupt statistics file " << field << " was read" << std::endl;
+            ++failures;
+        }
+    }
+    std::remove(path);
+
+    // Rule kernels, including a neighborhood radius above 1 and the 1D line
+    CellularAutomata majority;
+    majority.set_neighborhood(MOORE);
+    majority.set_rule(MAJORITY_RULE);
+    majority.set_grid_size(90, 70);
+    majority.set_states(3);
+    majority.set_num_threads(3);
+    majority.setup_dimensions();
+    failures += check_run("majority", majority, [](CellularAutomata &m) { m.twodim_rule3(1, 3); }, 6);
+
+    CellularAutomata16 wide;
+    wide.set_rule(CONDITIONAL_TRANSITION);
+    wide.set_neighborhood_radius(3);
+    wide.set_grid_size(50, 50);
+    wide.set_states(3);
+    wide.setup_dimensions();
+    failures += check_run("radius 3", wide, [](CellularAutomata16 &m) { m.twodim_rule2(1, 2); }, 6);
+
+    // Spreading front, where the stable tiles are skipped
+    CellularAutomata front;
+    front.set_rule(CONDITIONAL_TRANSITION);
+    std::vector<std::vector<int>> seeds(160, std::vector<int>(700, 1));
+    seeds[40][600] = 2;
+    front.set_grid(seeds);
+    failures += check_run("front", front, [](CellularAutomata &m) { m.twodim_rule2(1, 2); }, 20);
+
+    // Bit-sliced engine, which counts the bit-planes
+    CellularAutomata8 bitsliced;
+    bitsliced.set_neighborhood(MOORE);
+    bitsliced.set_rule(MAJORITY_RULE);
+    bitsliced.set_engine(BITSLICED_ENGINE);
+    bitsliced.set_k(1);
+    bitsliced.set_kprime(3);
+    bitsliced.set_grid_size(70, 130);
+    bitsliced.set_states(3);
+    bitsliced.set_num_threads(2);
+    bitsliced.setup_dimensions();
+    failures += check_run("bit-sliced", bitsliced, [](CellularAutomata8 &m) { m.step(1); }, 6);
+
+    CellularAutomata line;
+    line.set_dimensions(ONE_DIMENSIONAL);
+    line.set_rule(STRAIGHT_CONDITIONAL);
+    line.set_grid_size(4, 300);
+    line.set_states(3);
+    line.setup_dimensions();
+    failures += check_run("1D", line, [](CellularAutomata &m) { m.onedim_rule1(2, 3); }, 2);
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " statistics check(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "All statistics tests passed." << std::endl;
+    return 0;
+}
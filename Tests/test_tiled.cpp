@@ -0,0 +1,120 @@
+// CHEM 274B: Software Engineering Fundamentals for Molecular Sciences
+// Creator: Francine Bianca Oca, Kassady Marasigan, Korede Ogundele
+//
+// This file contains the C++ testing code that checks the out-of-core mode.
+// For every neighborhood, boundary type, rule, radius and tile size, a grid
+// file is stepped next to an in-memory model with the same seed, and the rows
+// of the file and the statistics must match the model. A run closed part way
+// is reopened and must continue as the in-memory run.
+
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include "CA_library.h"
+#include "CA_tiled.h"
+
+// Function that compares the grid file with the grid of the model
+bool same_grid(const TiledAutomata16 &tiled, const CellularAutomata16 &model)
+{
+    std::vector<uint16_t> row(tiled.get_grid_cols());
+    for (int i = 0; i < tiled.get_grid_rows(); ++i)
+    {
+        tiled.read_row(i, row.data());
+        if (!std::equal(row.begin(), row.end(), model.get_row(i)))
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    int failures = 0;
+    const char *path = "test_tiled.grid";
+    const int rows = 37, cols = 29;
+    const NeighborhoodType neighborhoods[] = {VON_NEUMANN, MOORE};
+    const BoundaryType boundaries[] = {PERIODIC, FIXED, NO_BOUNDARIES};
+    const RuleType rules[] = {STRAIGHT_CONDITIONAL, CONDITIONAL_TRANSITION, MAJORITY_RULE};
+
+    for (NeighborhoodType neighborhood : neighborhoods)
+    {
+        for (BoundaryType boundary : boundaries)
+        {
+            for (RuleType rule : rules)
+            {
+                for (int radius = 1; radius <= 2; ++radius)
+                {
+                    const int tile_sizes[] = {radius, 8, rows};
+                    for (int tile_rows : tile_sizes)
+                    {
+                        CellularAutomata16 model;
+                        model.set_dimensions(TWO_DIMENSIONAL);
+                        model.set_neighborhood(neighborhood);
+                        model.set_boundaries(boundary);
+                        model.set_rule(rule);
+                        model.set_neighborhood_radius(radius);
+                        model.set_grid_size(rows, cols);
+                        model.set_states(3);
+                        model.set_k(1);
+                        model.set_kprime(2);
+                        model.set_seed(29);
+                        model.set_statistics(true);
+                        model.setup_dimensions();
+
+                        TiledAutomata16 tiled;
+                        bool same = tiled.create(model, path, rows, cols, tile_rows, 1) && same_grid(tiled, model);
+                        for (int generation = 0; generation < 4 && same; ++generation)
+                        {
+                            model.step();
+                            tiled.step();
+                            same = same_grid(tiled, model);
+
+                            const StatisticsSeries &tiled_statistics = tiled.get_statistics();
+                            const StatisticsSeries &model_statistics = model.get_statistics();
+                            for (int state = 0; state < 4 && same; ++state)
+                            {
+                                same = tiled_statistics.get_count(tiled_statistics.size() - 1, state) ==
+                                       model_statistics.get_count(model_statistics.size() - 1, state);
+                            }
+                        }
+
+                        // Resume from the file
+                        tiled.close();
+                        same = same && tiled.open(model, path, tile_rows + 1) && tiled.get_generation() == 4;
+                        model.step(3);
+                        tiled.step(3);
+                        same = same && same_grid(tiled, model) && tiled.get_generation() == 7;
+                        tiled.close();
+
+                        if (!same)
+                        {
+                            std::cerr << "tiled grid differs from the model (neighborhood " << neighborhood
+                                      << ", boundaries " << boundary << ", rule " << rule << ", radius " << radius
+                                      << ", tiles of " << tile_rows << " rows)" << std::endl;
+                            ++failures;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    std::remove(path);
+
+    // Only 2D grids are tiled
+    CellularAutomata16 line;
+    line.set_dimensions(ONE_DIMENSIONAL);
+    TiledAutomata16 tiled;
+    if (tiled.create(line, path, rows, cols, 8) || tiled.get_open())
+    {
+        std::cerr << "a 1D model was tiled" << std::endl;
+        ++failures;
+    }
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+
+    std::cout << "All tiled grid tests passed." << std::endl;
+    return 0;
+}
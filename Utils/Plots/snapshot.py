@@ -0,0 +1,163 @@
+# University of California, Berkeley
+# Chem 274B: Software Engineering Fundamentals for
+#            Molecular Sciences
+#
+# Creators:  Francine Bianca Oca, Kassady Marasigan and Korede Ogundele
+#
+# Readers for the binary files written by the library, for use in the
+# plotting notebooks:
+# - snapshot files written by SnapshotWriter (Include/CA_snapshot.h):
+#
+#     from snapshot import Snapshot, read_statistics
+#     snap = Snapshot("simulation_output.snap")
+#     grid = snap.frame(snap.find_generation(50))   # rows x cols
+#
+#   The file is memory-mapped, so only the frames that are read are loaded.
+# - statistics files written by StatisticsSeries (Include/CA_stats.h):
+#
+#     stats = read_statistics("simulation_statistics.stats")
+#     stats["counts"][3]   # number of Recessive individuals per generation
+
+import mmap
+import struct
+
+try:
+    import numpy as np
+except ImportError:  # frames are returned as lists of rows instead
+    np = None
+
+HEADER = struct.Struct("<8sIIiiii4BBBHQQQ")
+FRAME_HEADER = struct.Struct("<QQII")
+INDEX_ENTRY = struct.Struct("<QQQII")
+FRAME_PACKED, FRAME_RLE, FRAME_DELTA_RLE = 0, 1, 2
+
+
+def _read_varint(data, pos):
+    value, shift = 0, 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, pos
+        shift += 7
+
+
+def _rle_decode(data, out, xor_into):
+    """Decode run-length encoded bytes into (or XOR them into) the bytearray out."""
+    pos, p = 0, 0
+    while pos < len(data):
+        token, pos = _read_varint(data, pos)
+        length = token >> 1
+        if token & 1:
+            byte = data[pos]
+            pos += 1
+            if not xor_into:
+                out[p:p + length] = bytes([byte]) * length
+            elif byte:
+                out[p:p + length] = bytes(b ^ byte for b in out[p:p + length])
+        else:
+            chunk = data[pos:pos + length]
+            pos += length
+            if xor_into:
+                chunk = bytes(a ^ b for a, b in zip(out[p:p + length], chunk))
+            out[p:p + length] = chunk
+        p += length
+
+
+class Snapshot:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        (magic, version, header_size, self.rows, self.cols, self.states, self.radius,
+         self.dimensions, self.neighborhood, self.boundaries, self.rule,
+         self.bits_per_cell, self.encoding, self.keyframe_interval,
+         self.seed, num_frames, index_offset) = HEADER.unpack_from(self.data, 0)
+        if magic != b"CASNAPSH" or version != 1:
+            raise ValueError(path + " is not a snapshot file")
+
+        self.frames = []  # (generation, payload offset, payload size, encoding)
+        if header_size <= index_offset and index_offset + num_frames * INDEX_ENTRY.size <= len(self.data):
+            for f in range(num_frames):
+                gen, offset, size, enc, _ = INDEX_ENTRY.unpack_from(self.data, index_offset + f * INDEX_ENTRY.size)
+                self.frames.append((gen, offset + FRAME_HEADER.size, size, enc))
+        else:  # no index: walk the frames
+            pos = header_size
+            while pos + FRAME_HEADER.size <= len(self.data):
+                gen, size, enc, _ = FRAME_HEADER.unpack_from(self.data, pos)
+                if pos + FRAME_HEADER.size + size > len(self.data):
+                    break
+                self.frames.append((gen, pos + FRAME_HEADER.size, size, enc))
+                pos += FRAME_HEADER.size + size
+
+        self.packed_size = (self.rows * self.cols * self.bits_per_cell + 7) // 8
+
+    def __len__(self):
+        return len(self.frames)
+
+    def generations(self):
+        return [frame[0] for frame in self.frames]
+
+    def find_generation(self, generation):
+        return self.generations().index(generation)
+
+    def packed(self, index):
+        """Bit-packed cells of a frame (deltas applied from the last keyframe)."""
+        key = index
+        while key > 0 and self.frames[key][3] == FRAME_DELTA_RLE:
+            key -= 1
+        out = bytearray(self.packed_size)
+        for f in range(key, index + 1):
+            _, offset, size, enc = self.frames[f]
+            payload = self.data[offset:offset + size]
+            if enc == FRAME_PACKED:
+                out[:] = payload
+            else:
+                _rle_decode(payload, out, enc == FRAME_DELTA_RLE)
+        return out
+
+    def frame(self, index):
+        """States of a frame as a rows x cols array (list of rows without numpy)."""
+        packed = self.packed(index)
+        bits, count = self.bits_per_cell, self.rows * self.cols
+        if np is not None:
+            if bits >= 8:
+                cells = np.frombuffer(bytes(packed), dtype="<u%d" % (bits // 8))[:count]
+            else:
+                raw = np.frombuffer(bytes(packed), dtype=np.uint8)
+                shifts = np.arange(0, 8, bits, dtype=np.uint8)
+                cells = ((raw[:, None] >> shifts) & ((1 << bits) - 1)).reshape(-1)[:count]
+            return cells.astype(np.int32).reshape(self.rows, self.cols)
+
+        step = bits // 8 if bits >= 8 else 0
+        cells = []
+        for c in range(count):
+            if step:
+                cells.append(int.from_bytes(packed[c * step:(c + 1) * step], "little"))
+            else:
+                bit = c * bits
+                cells.append((packed[bit >> 3] >> (bit & 7)) & ((1 << bits) - 1))
+        return [cells[i * self.cols:(i + 1) * self.cols] for i in range(self.rows)]
+
+
+def read_statistics(path):
+    """Columns of a statistics file: generation, counts (one column per state), p, q, heterozygosity."""
+    with open(path, "rb") as f:
+        data = f.read()
+    magic, version, num_states, samples = struct.unpack_from("<8sIIQ", data, 0)
+    if magic != b"CASTATS1" or version != 1:
+        raise ValueError(path + " is not a statistics file")
+
+    def column(index, kind):
+        offset = 32 + index * 8 * samples
+        if np is not None:
+            return np.frombuffer(data, dtype="<" + kind + "8", count=samples, offset=offset)
+        return list(struct.unpack_from("<%d%s" % (samples, "Q" if kind == "u" else "d"), data, offset))
+
+    return {
+        "generation": column(0, "u"),
+        "counts": [column(1 + state, "u") for state in range(num_states)],
+        "p": column(1 + num_states, "f"),
+        "q": column(2 + num_states, "f"),
+        "heterozygosity": column(3 + num_states, "f"),
+    }